@@ -33,13 +33,34 @@ SOURCES += \
         shared/CppUtils-Network/NetAddress.cpp \
         shared/CppUtils-Network/Socket.cpp \
         shared/CppUtils-Network/SystemErrorInfo.cpp \
+        src/AsyncContext.cpp \
         src/Client.cpp \
+        src/ClientGroup.cpp \
+        src/ClientSocket.cpp \
         src/Color.cpp \
+        src/ColorBuffer.cpp \
+        src/ColorKernelsNEON.cpp \
+        src/ColorKernelsX86.cpp \
+        src/ContentHash.cpp \
+        src/DeviceFrame.cpp \
         src/DeviceInfo.cpp \
+        src/DeviceListCache.cpp \
+        src/EffectEngine.cpp \
+        src/Effects.cpp \
         src/Exceptions.cpp \
+        src/FrameSubmitter.cpp \
+        src/LatencyHistogram.cpp \
+        src/MappedFile.cpp \
+        src/MatrixMapper.cpp \
         src/MiscUtils.cpp \
         src/ProtocolCommon.cpp \
         src/ProtocolMessages.cpp \
+        src/ShowCompiler.cpp \
+        src/ShowPlayer.cpp \
+        src/SpatialCanvas.cpp \
+        src/SpatialLayout.cpp \
+        src/StatsRecorder.cpp \
+        src/ThreadPool.cpp \
         src/test/main.cpp
 
 HEADERS += \
@@ -60,11 +81,34 @@ HEADERS += \
         shared/CppUtils-Network/Socket.hpp \
         shared/CppUtils-Network/SystemErrorInfo.hpp \
         include/OpenRGB/Client.hpp \
+        include/OpenRGB/ClientGroup.hpp \
+        include/OpenRGB/ClientStats.hpp \
         include/OpenRGB/Color.hpp \
+        include/OpenRGB/ColorBuffer.hpp \
+        include/OpenRGB/DeviceFrame.hpp \
         include/OpenRGB/DeviceInfo.hpp \
+        include/OpenRGB/EffectEngine.hpp \
+        include/OpenRGB/Effects.hpp \
+        include/OpenRGB/FrameSubmitter.hpp \
+        include/OpenRGB/MatrixMapper.hpp \
+        include/OpenRGB/ShowCompiler.hpp \
+        include/OpenRGB/ShowPlayer.hpp \
+        include/OpenRGB/SpatialCanvas.hpp \
+        include/OpenRGB/SpatialLayout.hpp \
+        include/OpenRGB/ThreadPool.hpp \
+        src/AsyncContext.hpp \
+        src/ClientSocket.hpp \
+        src/ColorKernels.hpp \
+        src/ColorModels.hpp \
+        src/ContentHash.hpp \
+        src/EffectUtils.hpp \
+        src/LatencyHistogram.hpp \
+        src/MappedFile.hpp \
         src/MiscUtils.hpp \
         src/ProtocolCommon.hpp \
-        src/ProtocolMessages.hpp
+        src/ProtocolMessages.hpp \
+        src/ShowFormat.hpp \
+        src/StatsRecorder.hpp
 
 DISTFILES += \
 	protocol_description.txt
@@ -76,6 +120,9 @@ INCLUDEPATH += shared/CppUtils-Network
 win32 {
 	LIBS += -lws2_32
 }
+unix {
+	LIBS += -lpthread
+}
 
 unix {
     target.path = /usr/lib
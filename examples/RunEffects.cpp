@@ -0,0 +1,98 @@
+//======================================================================================================================
+//  run built-in effects on all devices until an INTERRUPT signal
+//    - the effect engine renders and sends the frames, the main thread only prints the statistics
+//======================================================================================================================
+
+/// \file
+
+#include <cstdio>    // printf
+#include <csignal>   // signal
+#include <memory>    // unique_ptr
+#include <thread>    // sleep
+using namespace std::chrono;
+
+#include "OpenRGB/Client.hpp"
+#include "OpenRGB/EffectEngine.hpp"
+using orgb::ConnectStatus;
+using orgb::RequestStatus;
+using orgb::enumString;
+using orgb::DeviceListResult;
+using orgb::Device;
+using orgb::Color;
+using orgb::Effect;
+using orgb::EffectEngine;
+using orgb::EffectEngineStats;
+
+
+static bool keepRunning = false;
+
+void signalFunc( int )
+{
+	keepRunning = false;
+	printf( "INTERRUPT signal received, quitting...\n" );
+}
+
+int main( int /*argc*/, char * /*argv*/ [] )
+{
+	static const char * hostName = "127.0.0.1";  // you can also use the NetBIOS computer name
+
+	orgb::Client client( "My OpenRGB Client" );
+
+	// a clean way to quit the application without killing it by force
+	keepRunning = true;
+	signal( SIGINT, signalFunc );
+
+	ConnectStatus connectStatus = client.connect( hostName );
+	if (connectStatus != ConnectStatus::Success)
+	{
+		printf( "connection failed: %s (error code: %d)\n", enumString( connectStatus ), int( client.getLastSystemError() ) );
+		return 1;
+	}
+
+	DeviceListResult result = client.requestDeviceList();
+	if (result.status != RequestStatus::Success)
+	{
+		printf( "failed to get device list: %s (error code: %d)\n", enumString( result.status ), int( client.getLastSystemError() ) );
+		return 1;
+	}
+
+	// the engine keeps pointers to the devices, so the list must outlive it
+	EffectEngine engine( client, 30 );
+
+	unsigned int deviceNum = 0;
+	for (const Device & device : result.devices)
+	{
+		// some devices don't accept colors until you set them to custom mode
+		client.switchToCustomMode( device );
+		std::this_thread::sleep_for( milliseconds( 50 ) );  // OpenRGB doesn't like when you send multiple requests at once
+
+		// give every device a different effect
+		std::unique_ptr< Effect > effect;
+		const char * effectName;
+		switch (deviceNum++ % 3)
+		{
+			case 0:  effect.reset( new orgb::RainbowWaveEffect( 0.25, 30.0 ) ); effectName = "rainbow"; break;
+			case 1:  effect.reset( new orgb::BreathingEffect( Color::Cyan ) ); effectName = "breathing"; break;
+			default: effect.reset( new orgb::SparkleEffect( Color::White, Color( 0, 0, 40 ) ) ); effectName = "sparkles"; break;
+		}
+		printf( "running %s on %s\n", effectName, device.name.c_str() );
+		engine.setEffect( device, std::move( effect ) );
+	}
+
+	engine.start();
+
+	while (keepRunning && client.isConnected())
+	{
+		std::this_thread::sleep_for( milliseconds( 1000 ) );
+
+		EffectEngineStats stats = engine.stats();
+		printf( "%.1f fps, %llu skipped, jitter p99 %lld us, frame time p99 %lld us\n",
+			stats.achievedFps, (unsigned long long)stats.skippedFrames,
+			(long long)stats.jitter.p99.count() / 1000, (long long)stats.frameTime.p99.count() / 1000 );
+		engine.resetStats();
+	}
+
+	engine.stop();
+
+	return 0;
+}
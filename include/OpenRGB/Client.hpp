@@ -11,20 +11,30 @@
 
 #include "DeviceInfo.hpp"
 #include "Color.hpp"
+#include "ClientStats.hpp"
 #include "SystemErrorType.hpp"  // HACK: read the comment at the top of that header file
 
 #include <string>  // client name
 #include <memory>  // unique_ptr<Socket>
+#include <deque>  // messages received while checking for updates
 #include <chrono>  // timeout
-
-namespace own {
-	class TcpSocket;
-}
+#include <functional>  // device list update callback
+#include <future>  // asynchronous requests
 
 
 namespace orgb {
 
 
+class ClientSocket;
+class AsyncContext;
+class StatsRecorder;
+class DeviceFrame;
+class ShowPlayer;
+struct Header;
+struct ReplyControllerData;
+enum class MessageType : uint32_t;
+
+
 constexpr uint16_t defaultPort = 6742;
 
 
@@ -66,8 +76,8 @@ enum class UpdateStatus
 	UpToDate,           ///< The current device list seems up to date.
 	OutOfDate,          ///< Server has sent a notification message indicating that the device list has changed. Call requestDeviceList() again.
 	ConnectionClosed,   ///< Server has closed the connection.
-	UnexpectedMessage,  ///< Server has sent some other kind of message that we didn't expect.
-	CantRestoreSocket,  ///< Error has occured while trying to restore socket to its original state and the socket has been closed. Call getLastSystemError() for more info. This should never happen, but one never knows.
+	UnexpectedMessage,  ///< Server has sent something that is not a valid message. (Other valid messages are kept for the next request.)
+	CantRestoreSocket,  ///< Not returned anymore, the check doesn't switch the socket into non-blocking mode. Kept for compatibility.
 	OtherSystemError,   ///< Other system error. Call getLastSystemError() for more info.
 	UnexpectedError,    ///< Internal error of this library. This should not happen unless there is a mistake in the code, please create a github issue.
 };
@@ -80,6 +90,24 @@ struct DeviceListResult
 	DeviceList devices;    ///< output of a successfull request
 };
 
+/// Which entries of a DeviceList have been changed by Client::updateDeviceList()
+/** Use it to update only the parts of your own data structures that refer to the affected devices. */
+struct DeviceListDiff
+{
+	std::vector< uint32_t > added;    ///< indexes of the devices appended to the end of the list
+	std::vector< uint32_t > removed;  ///< indexes that were in the list before, but aren't anymore (always the last ones)
+	std::vector< uint32_t > changed;  ///< indexes whose Device object has been replaced, old references to them are invalid
+
+	bool empty() const noexcept  { return added.empty() && removed.empty() && changed.empty(); }
+};
+
+/// Result and output of a device list update
+struct DeviceListUpdateResult
+{
+	RequestStatus status;  ///< whether the request suceeded or why it didn't
+	DeviceListDiff diff;   ///< what has been changed in the list, even when the request failed in the middle
+};
+
 /// Result and output of a device count request
 struct DeviceCountResult
 {
@@ -126,6 +154,14 @@ class Client
 	/// Tells whether the client is currently connected to a server.
 	bool isConnected() const noexcept;
 
+	/// Returns the message counts, traffic and latencies per message type measured since creation or resetStats().
+	/** Taking the snapshot doesn't block the threads that use the client. When the library is built with
+	  * NO_CLIENT_STATS, nothing is measured and the result is always empty with ClientStats::enabled set to false. */
+	ClientStats stats() const noexcept;
+
+	/// Clears all the measured statistics.
+	void resetStats() noexcept;
+
 	//-- return-value-oriented exception-less API ----------------------------------------------------------------------
 
 	/// Connects to the OpenRGB server determined by a host name and announces our client name.
@@ -138,9 +174,32 @@ class Client
 	/// Sets a timeout for receiving request answers.
 	bool setTimeout( std::chrono::milliseconds timeout ) noexcept;
 
+	/// Sets how many device requests can be waiting for a reply at the same time during requestDeviceList().
+	/** By default (1) the client waits for each device's reply before it asks for the next one, which costs a full
+	  * round trip per device. Higher values let the requests overlap, which speeds up the download from remote servers
+	  * with many devices. 0 means no limit, all requests are sent right after the device count arrives. */
+	void setDeviceListPipelineDepth( uint32_t maxRequestsInFlight ) noexcept;
+
+	/// Enables or disables decoding of Device::modes and Device::leds only when they are first accessed.
+	/** Applications that mostly look only at the device names, types and LED counts can save most of the time
+	  * and memory spent on receiving the device list this way. The devices then keep a copy of the raw reply
+	  * and decode the modes or the LEDs from it on the first access to their elements, Device::leds.size() is known
+	  * right away. Affects the devices received after this call. Disabled by default. */
+	void setLazyDeviceParsing( bool enable ) noexcept;
+
 	/// Queries the server for information about all its RGB devices.
 	DeviceListResult requestDeviceList() noexcept;
 
+	/// Brings an existing device list up to date with the server, for example a list loaded by DeviceList::loadFromFile().
+	/** The descriptions of all devices are downloaded again, but only those that differ from the list entries are
+	  * parsed and replaced, the unchanged Device objects stay where they are and references to them remain valid.
+	  * Devices that the server doesn't have anymore are removed from the end of the list. The returned diff tells
+	  * which entries have been added, removed or replaced.
+	  * When the server announces another change in the middle of the update, the devices received so far are kept
+	  * and the next pass only reparses those that have changed again.
+	  * If the request fails, the list may be updated only partially, call this again once the problem is resolved. */
+	DeviceListUpdateResult updateDeviceList( DeviceList & devices ) noexcept;
+
 	/// Queries the server for the number of its RGB devices.
 	/** This is useful when for some reason you want to request the devices manually one by one. */
 	DeviceCountResult requestDeviceCount() noexcept;
@@ -150,7 +209,10 @@ class Client
 	DeviceInfoResult requestDeviceInfo( uint32_t deviceIdx ) noexcept;
 
 	/// Checks if the device list you downloaded earlier via requestDeviceList() hasn't been changed on the server.
-	/** In case it has been changed, you need to call requestDeviceList() again. */
+	/** In case it has been changed, you need to call requestDeviceList() again.
+	  * In the synchronous mode the check looks into the socket without waiting, which costs a single system call
+	  * when nothing has arrived, so it's cheap enough to be called every frame. In the asynchronous mode it only
+	  * reads a flag. */
 	UpdateStatus checkForDeviceUpdates() noexcept;
 
 	/// Switches the device to a directly controlled color mode.
@@ -170,9 +232,37 @@ class Client
 	/// Sets one unified color for the whole device.
 	RequestStatus setDeviceColor( const Device & device, Color color ) noexcept;
 
+	/// Sets an individual color for every LED of the device.
+	/** The colors should be in the same order as Device::leds and there should be as many of them. */
+	RequestStatus setDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept;
+
+	/// Sets a new frame of colors for the device, but sends only the LEDs that changed since the last frame.
+	/** The client remembers the colors it has last sent to each device via this function, setDeviceColor()
+	  * or setDeviceColors() and compares the new frame against them. Depending on which encoding takes the least bytes,
+	  * the changes are sent as separate single-LED updates, as updates of the affected zones, or as the full LED array.
+	  * When nothing changed, nothing is sent. The first frame for each device is always sent whole.
+	  * The colors should be in the same order as Device::leds and there should be as many of them.
+	  * If the colors can be changed by someone else than this client (other apps, profiles), call forgetSentColors()
+	  * so that the next frame is sent whole. */
+	RequestStatus updateDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept;
+
+	/// Forgets the colors remembered for updateDeviceColors(), so that the next frame of each device is sent whole.
+	void forgetSentColors() noexcept;
+
+	/// Sends the zones of the frame that were edited since it was last sent, then marks the frame as clean.
+	/** Each dirty zone goes in its own UpdateZoneLEDs message and all of them are sent in a single call,
+	  * unless a single UpdateLEDs with the whole device would take less bytes. When the whole frame is marked as dirty,
+	  * it's always sent in a single UpdateLEDs. When nothing is dirty, nothing is sent.
+	  * The sent colors are remembered for updateDeviceColors() like with setDeviceColors(). */
+	RequestStatus sendFrame( DeviceFrame & frame ) noexcept;
+
 	/// Sets a color of a particular zone of a device.
 	RequestStatus setZoneColor( const Zone & zone, Color color ) noexcept;
 
+	/// Sets an individual color for every LED of a particular zone of a device.
+	/** There should be exactly Zone::leds_count colors. */
+	RequestStatus setZoneColors( const Zone & zone, const std::vector< Color > & colors ) noexcept;
+
 	/// Resizes a zone of leds, if the device supports it.
 	RequestStatus setZoneSize( const Zone & zone, uint32_t newSize ) noexcept;
 
@@ -191,6 +281,43 @@ class Client
 	/// Removes an existing profile.
 	RequestStatus deleteProfile( const std::string & profileName );
 
+	//-- asynchronous mode ---------------------------------------------------------------------------------------------
+
+	/// Starts a background thread that receives all the messages from the server.
+	/** In this mode nothing except the requests that wait for a reply ever blocks on receiving.
+	  * checkForDeviceUpdates() only checks a flag set by the background thread and the optional callback is called
+	  * from another background thread when the server announces a change of the device list. Announcements that
+	  * arrive while the callback is running result in a single next call. The callback may make requests,
+	  * for example requestDeviceList(), but it must not throw and must not call stopAsyncMode() or disconnect().
+	  * The client has to be connected, disconnect() stops the thread automatically.
+	  * \returns false when the client is not connected, the mode is already running or the thread can't be started. */
+	bool startAsyncMode( std::function< void () > onDeviceListUpdated = nullptr ) noexcept;
+
+	/// Stops the background receiving thread and returns to the default synchronous mode.
+	/** Don't call this while any request is waiting for a reply, the reply would be lost.
+	  * \returns false when the client isn't in the asynchronous mode. */
+	bool stopAsyncMode() noexcept;
+
+	/// Tells whether the background receiving thread is running.
+	bool isInAsyncMode() const noexcept;
+
+	/// Variant of requestDeviceList() that doesn't block the calling thread.
+	/** In the asynchronous mode the request is performed in another thread, otherwise the request is deferred until
+	  * the future's get() or wait() is called. The client must outlive the returned future. */
+	std::future< DeviceListResult > requestDeviceListAsync();
+
+	/// Variant of requestDeviceCount() that doesn't block the calling thread.
+	/** See requestDeviceListAsync() for details. */
+	std::future< DeviceCountResult > requestDeviceCountAsync();
+
+	/// Variant of requestDeviceInfo() that doesn't block the calling thread.
+	/** See requestDeviceListAsync() for details. */
+	std::future< DeviceInfoResult > requestDeviceInfoAsync( uint32_t deviceIdx );
+
+	/// Variant of requestProfileList() that doesn't block the calling thread.
+	/** See requestDeviceListAsync() for details. */
+	std::future< ProfileListResult > requestProfileListAsync();
+
 #ifndef NO_EXCEPTIONS
 
 	//-- exception-oriented API ----------------------------------------------------------------------------------------
@@ -209,12 +336,27 @@ class Client
 	/** \throws SystemError when there was an error inside the operating system */
 	void setTimeoutX( std::chrono::milliseconds timeout );
 
+	/// Exception-throwing variant of startAsyncMode().
+	/** \throws UserError when the client is not connected or the mode is already running
+	  * \throws SystemError when the background thread could not be started */
+	void startAsyncModeX( std::function< void () > onDeviceListUpdated = nullptr );
+
+	/// Exception-throwing variant of stopAsyncMode().
+	/** \throws UserError when the client isn't in the asynchronous mode */
+	void stopAsyncModeX();
+
 	/// Exception-throwing variant of requestDeviceList().
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
 	  * \throws SystemError when there was an error inside the operating system */
 	DeviceList requestDeviceListX();
 
+	/// Exception-throwing variant of updateDeviceList().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
+	  * \throws SystemError when there was an error inside the operating system */
+	DeviceListDiff updateDeviceListX( DeviceList & devices );
+
 	/// Exception-throwing variant of requestDeviceCount().
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent or no valid reply was received
@@ -256,12 +398,36 @@ class Client
 	  * \throws SystemError when there was an error inside the operating system */
 	void setDeviceColorX( const Device & device, Color color );
 
+	/// Exception-throwing variant of setDeviceColors().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent
+	  * \throws SystemError when there was an error inside the operating system */
+	void setDeviceColorsX( const Device & device, const std::vector< Color > & colors );
+
+	/// Exception-throwing variant of updateDeviceColors().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent
+	  * \throws SystemError when there was an error inside the operating system */
+	void updateDeviceColorsX( const Device & device, const std::vector< Color > & colors );
+
+	/// Exception-throwing variant of sendFrame().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent
+	  * \throws SystemError when there was an error inside the operating system */
+	void sendFrameX( DeviceFrame & frame );
+
 	/// Exception-throwing variant of setZoneColor().
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent
 	  * \throws SystemError when there was an error inside the operating system */
 	void setZoneColorX( const Zone & zone, Color color );
 
+	/// Exception-throwing variant of setZoneColors().
+	/** \throws UserError when the client is not connected
+	  * \throws ConnectionError when a request couldn't be sent
+	  * \throws SystemError when there was an error inside the operating system */
+	void setZoneColorsX( const Zone & zone, const std::vector< Color > & colors );
+
 	/// Exception-throwing variant of setZoneSize().
 	/** \throws UserError when the client is not connected
 	  * \throws ConnectionError when a request couldn't be sent
@@ -311,10 +477,17 @@ class Client
 
  private: // helpers
 
+	friend class ShowPlayer;
+
+	/// Sends complete messages serialized in advance (for example by the ShowCompiler) in a single system call.
+	/** They must be valid UpdateLEDs messages. */
+	RequestStatus sendPrecompiledMessages( const uint8_t * data, size_t size ) noexcept;
+
 	ConnectStatus _connect( const std::string & host, uint16_t port );
 	bool _disconnect() noexcept;
 	bool _setTimeout( std::chrono::milliseconds timeout ) noexcept;
 	DeviceListResult _requestDeviceList();
+	DeviceListUpdateResult _updateDeviceList( DeviceList & devices );
 	DeviceCountResult _requestDeviceCount();
 	DeviceInfoResult _requestDeviceInfo( uint32_t deviceIdx );
 	UpdateStatus _checkForDeviceUpdates() noexcept;
@@ -322,16 +495,34 @@ class Client
 	RequestStatus _changeMode( const Device & device, const Mode & mode );
 	RequestStatus _saveMode( const Device & device, const Mode & mode );
 	RequestStatus _setDeviceColor( const Device & device, Color color );
+	RequestStatus _setDeviceColors( const Device & device, const Color * colors, size_t count );
+	RequestStatus _updateDeviceColors( const Device & device, const Color * colors, size_t count );
+	RequestStatus _sendFrame( DeviceFrame & frame );
+	RequestStatus _sendPrecompiledMessages( const uint8_t * data, size_t size );
 	RequestStatus _setZoneColor( const Zone & zone, Color color );
+	RequestStatus _setZoneColors( const Zone & zone, const Color * colors, size_t count );
 	RequestStatus _setZoneSize( const Zone & zone, uint32_t newSize );
 	RequestStatus _setLEDColor( const LED & led, Color color );
 	ProfileListResult _requestProfileList();
+	bool _startAsyncMode( std::function< void () > onDeviceListUpdated );
+	bool _stopAsyncMode() noexcept;
 	RequestStatus _saveProfile( const std::string & profileName );
 	RequestStatus _loadProfile( const std::string & profileName );
 	RequestStatus _deleteProfile( const std::string & profileName );
 
 	template< typename Message, typename ... ConstructorArgs >
-	bool sendMessage( ConstructorArgs ... args );
+	bool sendMessage( const ConstructorArgs & ... args );
+	template< typename Message >
+	void appendToSendBuffer( const Message & message );
+	bool sendBuffer();
+
+	RequestStatus downloadDeviceList( DeviceList & devices, std::vector< bool > & replacedEntries );
+	bool parseDeviceReply( ReplyControllerData & reply ) noexcept;
+
+	/// The caller must hold the send lock, the vector may grow.
+	std::vector< Color > & sentColorsOf( uint32_t deviceIdx );
+	/// Takes the send lock by itself, so it can be called from any request.
+	void forgetSentColorsOf( uint32_t deviceIdx ) noexcept;
 
 	template< typename Message >
 	struct RecvResult
@@ -341,9 +532,18 @@ class Client
 	};
 	template< typename Message >
 	RecvResult< Message > awaitMessage() noexcept;
+	/// Receives the next reply, leaves its body unparsed in the _recvBuffer.
+	RequestStatus awaitRawMessage( MessageType expectedType, Header & header ) noexcept;
+	RequestStatus receiveRawMessage( MessageType expectedType, Header & header ) noexcept;
 
 	UpdateStatus checkForUpdateMessageArrival() noexcept;
 
+	bool isDeviceListOutOfDate() const noexcept;
+	void setDeviceListOutOfDate( bool outOfDate ) noexcept;
+
+	template< typename Result, typename Func >
+	std::future< Result > runAsync( Func func );
+
 #ifndef NO_EXCEPTIONS
 	void connectStatusToException( ConnectStatus status );
 	void requestStatusToException( RequestStatus status );
@@ -353,12 +553,35 @@ class Client
 
 	std::string _clientName;
 
-	// a pointer so that we don't have to include the TcpSocket and all its OS dependancies here
-	std::unique_ptr< own::TcpSocket > _socket;
+	// a pointer so that we don't have to include the ClientSocket and all its OS dependancies here
+	std::unique_ptr< ClientSocket > _socket;
 
 	uint32_t _negotiatedProtocolVersion;
 
-	bool _isDeviceListOutOfDate;
+	std::chrono::milliseconds _timeout;
+
+	bool _isDeviceListOutOfDate;  ///< in the asynchronous mode this is tracked by the _asyncContext
+
+	uint32_t _deviceListPipelineDepth;
+
+	bool _lazyDeviceParsing;
+
+	/// Complete messages (header + body) that arrived while checking for device list updates and wait for awaitMessage.
+	std::deque< std::vector< uint8_t > > _pendingMessages;
+
+	// Buffers reused by every call, so that sending colors doesn't need any allocations once they grow big enough.
+	std::vector< uint8_t > _sendBuffer;
+	std::vector< Color > _colorBuffer;
+	std::vector< uint8_t > _recvBuffer;  ///< only used by the thread that holds the request lock
+
+	/// Colors last sent to each device (indexed by device index) for the delta encoding, empty when unknown.
+	std::vector< std::vector< Color > > _sentColors;
+
+	// exists only while the client is in the asynchronous mode
+	std::unique_ptr< AsyncContext > _asyncContext;
+
+	// a pointer so that the histograms don't have to be included here, shared with the _asyncContext
+	std::unique_ptr< StatsRecorder > _stats;
 
 };
 
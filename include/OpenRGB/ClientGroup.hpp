@@ -0,0 +1,165 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: group of clients connected to multiple servers and operated in parallel
+//======================================================================================================================
+
+#ifndef OPENRGB_CLIENT_GROUP_INCLUDED
+#define OPENRGB_CLIENT_GROUP_INCLUDED
+
+
+#include "Client.hpp"
+#include "DeviceInfo.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+/// Summary of one operation performed on all the hosts of a ClientGroup
+struct GroupResult
+{
+	size_t succeeded = 0;  ///< number of hosts where the operation succeeded
+	size_t failed = 0;     ///< number of hosts where it failed, see ClientGroup::lastStatus() for the reasons
+	std::chrono::microseconds maxLatency { 0 };  ///< how long it took on the slowest host
+	std::chrono::microseconds skew { 0 };        ///< time between the first and the last host finishing the operation
+
+	bool allSucceeded() const noexcept  { return failed == 0; }
+};
+
+
+//======================================================================================================================
+/// Owns clients connected to many OpenRGB servers and performs the operations on all of them in parallel.
+/** All the hosts are served by a pool of worker threads that are released at the same moment, so that a frame
+  * reaches all the machines at nearly the same time, instead of the last machine waiting for all the previous ones.
+  * The skew between the hosts and the latency of each of them is measured for every operation.
+  *
+  * The methods of the group must be called from a single thread. The clients can be accessed directly via client(),
+  * but not while an operation of the group is running. */
+
+class ClientGroup
+{
+
+ public:
+
+	/// Creates an empty group. Does not connect anywhere or start any threads yet.
+	/** \param threadCount how many hosts can be served at the same time, 0 means one thread for every host */
+	ClientGroup( const std::string & clientName = "orgb::ClientGroup", unsigned int threadCount = 0 ) noexcept;
+
+	/// Stops the worker threads. The clients disconnect when they are destroyed.
+	~ClientGroup() noexcept;
+
+	ClientGroup( const ClientGroup & other ) = delete;
+	ClientGroup & operator=( const ClientGroup & other ) = delete;
+
+	/// Adds a server to the group. Doesn't connect to it yet.
+	/** \returns index of the host that can be used with the other methods */
+	size_t addHost( const std::string & host, uint16_t port = defaultPort );
+
+	/// Number of hosts in the group.
+	size_t size() const noexcept  { return _hosts.size(); }
+
+	//-- operations on all hosts ---------------------------------------------------------------------------------------
+
+	/// Connects to all the hosts that are not connected yet.
+	/** The status of each host can be checked via connectStatus(). */
+	GroupResult connect() noexcept;
+
+	/// Disconnects from all the hosts.
+	void disconnect() noexcept;
+
+	/// Sets the receive timeout of all the connected clients.
+	GroupResult setTimeout( std::chrono::milliseconds timeout ) noexcept;
+
+	/// Downloads the device lists from all the connected hosts and stores them in the group, see devices().
+	GroupResult requestDeviceLists() noexcept;
+
+	/// Performs any operation with each connected host in parallel, typically sending a new frame of colors.
+	/** The function is called from the worker threads, each call with a different host, so it must not modify anything
+	  * shared without synchronization. It must not throw and must not call methods of this group.
+	  * Hosts that are not connected are skipped and reported as failed with RequestStatus::NotConnected. */
+	GroupResult forEach( std::function< RequestStatus ( Client & client, const DeviceList & devices, size_t hostIdx ) > func ) noexcept;
+
+	//-- per-host information ------------------------------------------------------------------------------------------
+
+	const std::string & hostName( size_t hostIdx ) const noexcept  { return _hosts[ hostIdx ]->name; }
+	uint16_t port( size_t hostIdx ) const noexcept                 { return _hosts[ hostIdx ]->port; }
+
+	/// Client connected to a particular host.
+	Client & client( size_t hostIdx ) noexcept  { return _hosts[ hostIdx ]->client; }
+
+	/// Device list of a particular host downloaded by the last requestDeviceLists().
+	const DeviceList & devices( size_t hostIdx ) const noexcept  { return _hosts[ hostIdx ]->devices; }
+
+	/// Result of the last connect() on a particular host.
+	ConnectStatus connectStatus( size_t hostIdx ) const noexcept  { return _hosts[ hostIdx ]->connectStatus; }
+
+	/// Result of the last operation on a particular host.
+	RequestStatus lastStatus( size_t hostIdx ) const noexcept  { return _hosts[ hostIdx ]->lastStatus; }
+
+	/// How long the last operation took on a particular host.
+	std::chrono::microseconds lastLatency( size_t hostIdx ) const noexcept  { return _hosts[ hostIdx ]->lastLatency; }
+
+ private:
+
+	struct Host
+	{
+		std::string name;
+		uint16_t port;
+		Client client;
+		DeviceList devices;
+		ConnectStatus connectStatus = ConnectStatus::Success;
+		RequestStatus lastStatus = RequestStatus::NotConnected;
+		std::chrono::microseconds lastLatency { 0 };
+		std::chrono::steady_clock::time_point finishTime;
+
+		Host( const std::string & name, uint16_t port, const std::string & clientName )
+			: name( name ), port( port ), client( clientName ) {}
+	};
+
+	/// Runs the job for every host on the worker threads and waits until all of them are done.
+	GroupResult runOnAllHosts( const std::function< bool ( Host & host, size_t hostIdx ) > & job );
+
+	bool ensureWorkers();
+	void workerLoop( uint64_t seenGeneration ) noexcept;
+
+	std::string _clientName;
+	unsigned int _threadCount;
+
+	// pointers, so that the references to the hosts stay valid when new ones are added
+	std::vector< std::unique_ptr< Host > > _hosts;
+
+	std::vector< std::thread > _workers;
+	std::mutex _poolMutex;
+	std::condition_variable _workCond;  ///< wakes up the workers when there is a new job
+	std::condition_variable _doneCond;  ///< wakes up the caller when all the workers are idle again
+	const std::function< void ( Host & host, size_t hostIdx ) > * _job;  ///< valid only while runOnAllHosts() is running
+	uint64_t _generation;    ///< incremented with every job, so that the workers can tell a new job from a spurious wakeup
+	size_t _hostCount;       ///< number of hosts of the current job
+	std::atomic< size_t > _nextHost;  ///< the workers take the hosts one by one using this counter
+	unsigned int _busyWorkers;
+	bool _stopRequested;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_CLIENT_GROUP_INCLUDED
@@ -0,0 +1,75 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: traffic counters and latency statistics of the client
+//======================================================================================================================
+
+#ifndef OPENRGB_CLIENT_STATS_INCLUDED
+#define OPENRGB_CLIENT_STATS_INCLUDED
+
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+/// Distribution of measured durations.
+/** The percentiles are approximate, they can be higher than the exact value by up to 1/16 of it. */
+struct LatencyStats
+{
+	uint64_t count = 0;                 ///< number of measurements
+	std::chrono::nanoseconds p50 { 0 };  ///< median
+	std::chrono::nanoseconds p90 { 0 };
+	std::chrono::nanoseconds p99 { 0 };
+	std::chrono::nanoseconds max { 0 };  ///< exact
+};
+
+/// Traffic and timing of a single type of protocol messages.
+struct MessageTypeStats
+{
+	uint32_t messageType = 0;            ///< numeric ID of the message type as defined by the OpenRGB protocol
+	const char * messageName = "";       ///< name of the message type, for example "RGBCONTROLLER_UPDATELEDS"
+	uint64_t sentCount = 0;              ///< number of messages successfully sent
+	uint64_t bytesSent = 0;              ///< including the message headers
+	uint64_t receivedCount = 0;          ///< number of messages received
+	uint64_t bytesReceived = 0;          ///< including the message headers
+	/// Duration of the send system calls.
+	/** When several messages go out in a single call, the call is measured once under the type of the first message. */
+	LatencyStats sendTime;
+	/// Time from sending a request until its reply has been received, parsing the reply isn't included.
+	/** Only the requests that have a reply have this, measured under the message type of the request. */
+	LatencyStats roundTrip;
+};
+
+/// Snapshot of the statistics of a client, see Client::stats().
+struct ClientStats
+{
+	/// False when the library was built with NO_CLIENT_STATS, in which case nothing is measured.
+	bool enabled = false;
+	/// Only the message types that have been sent or received at least once, ordered by the message type ID.
+	std::vector< MessageTypeStats > messageTypes;
+
+	/// Returns the statistics of the given message type ID or nullptr if no such message has been sent or received.
+	const MessageTypeStats * find( uint32_t messageType ) const noexcept
+	{
+		for (const MessageTypeStats & typeStats : messageTypes)
+			if (typeStats.messageType == messageType)
+				return &typeStats;
+		return nullptr;
+	}
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_CLIENT_STATS_INCLUDED
@@ -10,6 +10,7 @@
 
 
 #include <cstdint>
+#include <cmath>
 #include <iosfwd>
 
 namespace own {
@@ -21,6 +22,43 @@ namespace own {
 namespace orgb {
 
 
+//======================================================================================================================
+/// Color in the hue-saturation-value model.
+/** The hue covers the full circle with the whole range of uint16_t, so it wraps around naturally when you add to it:
+  * 0 is red, 10923 yellow, 21845 green, 32768 cyan, 43691 blue and 54613 magenta. */
+
+struct HSV
+{
+	uint16_t hue;
+	uint8_t  saturation;  ///< 0 is grey, 255 the most saturated color
+	uint8_t  value;       ///< 0 is black, 255 the brightest color
+
+	HSV() noexcept = default;
+	HSV( uint16_t h, uint8_t s, uint8_t v ) noexcept : hue( h ), saturation( s ), value( v ) {}
+};
+
+/// Color in the hue-saturation-lightness model.
+/** The hue is the same as in HSV. */
+
+struct HSL
+{
+	uint16_t hue;
+	uint8_t  saturation;  ///< 0 is grey, 255 the most saturated color
+	uint8_t  lightness;   ///< 0 is black, 255 white, the most saturated colors are in the middle
+
+	HSL() noexcept = default;
+	HSL( uint16_t h, uint8_t s, uint8_t l ) noexcept : hue( h ), saturation( s ), lightness( l ) {}
+};
+
+/// Converts an angle in degrees into the hue of HSV and HSL.
+inline uint16_t hueFromDegrees( double degrees ) noexcept
+{
+	double turns = degrees / 360.0;
+	turns -= std::floor( turns );
+	return uint16_t( uint32_t( turns * 65536.0 + 0.5 ) );  // a full turn becomes 0
+}
+
+
 //======================================================================================================================
 /// Simple representation of a color with 3 8-bit values for red, green, blue components
 
@@ -38,12 +76,24 @@ class Color
 	Color() noexcept = default;
 	Color( uint8_t red, uint8_t green, uint8_t blue ) noexcept : r( red ), g( green ), b( blue ) {}
 
+	/// Compares only the color components, the padding is ignored.
+	bool operator==( Color other ) const noexcept  { return r == other.r && g == other.g && b == other.b; }
+	bool operator!=( Color other ) const noexcept  { return !(*this == other); }
+
 	/// Attempts to deduce a color from a string description.
 	/** Possible ways to define a color are:
 	  * 1. hex number of 6 digits, for example "AB34EF", may be preceeded by '#' character
 	  * 2. a word, for example "red", "cyan", "black", case doesn't matter */
 	bool fromString( const std::string & str ) noexcept;
 
+	// Conversions between the color models use integer math and round to the nearest.
+	// To convert whole buffers at once, use the faster colorsFromHSV() and others from ColorBuffer.hpp.
+
+	static Color fromHSV( HSV hsv ) noexcept;
+	static Color fromHSL( HSL hsl ) noexcept;
+	HSV toHSV() const noexcept;
+	HSL toHSL() const noexcept;
+
 	// predefined basic colors for instant use
 	static const Color Black;
 	static const Color White;
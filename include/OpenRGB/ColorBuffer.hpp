@@ -0,0 +1,124 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: fast bulk operations over buffers of colors
+//======================================================================================================================
+
+#ifndef OPENRGB_COLOR_BUFFER_INCLUDED
+#define OPENRGB_COLOR_BUFFER_INCLUDED
+
+
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  instruction set selection
+
+/// Instruction set used by the color buffer operations.
+enum class SimdLevel
+{
+	Scalar,  ///< plain C++, works everywhere
+	SSE2,
+	AVX2,
+	NEON,
+};
+const char * enumString( SimdLevel ) noexcept;
+
+/// Returns the instruction set the color buffer operations currently use.
+/** Unless setSimdLevel() is called, the best one supported by the CPU is selected on the first use. */
+SimdLevel activeSimdLevel() noexcept;
+
+/// Makes the color buffer operations use a specific instruction set, mainly for benchmarks and tests.
+/** All the instruction sets produce exactly the same results, they differ only in speed.
+  * \returns false when the instruction set is not supported by this CPU or by this build, the selection then stays. */
+bool setSimdLevel( SimdLevel level ) noexcept;
+
+
+//======================================================================================================================
+//  operations
+//
+//  Each operation processes count colors in a single pass using the widest vector instructions the CPU supports.
+//  The destination may be the same buffer as any of the sources, but must not overlap them partially.
+//  The padding byte of all the resulting colors is set to 0.
+
+/// Sets all the colors to one color.
+void fillColors( Color * dst, size_t count, Color color ) noexcept;
+
+/// Linear interpolation between two buffers, dst = from + (to - from) * amount / 255, rounded to the nearest.
+/** amount 0 gives exactly from, amount 255 gives exactly to. */
+void blendColors( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount ) noexcept;
+
+/// Scales all color components by brightness / 255, rounded to the nearest.
+void scaleColors( Color * dst, const Color * src, size_t count, uint8_t brightness ) noexcept;
+
+/// Multiplies each color component by its own factor, for example to white-balance an LED strip.
+/** The factors have a precision of 1/256 and can be up to 127, the results are saturated to 255. */
+void gainColors( Color * dst, const Color * src, size_t count, float redGain, float greenGain, float blueGain ) noexcept;
+
+/// Adds the colors of src to dst, the components are saturated to 255.
+void addColors( Color * dst, const Color * src, size_t count ) noexcept;
+
+/// Keeps the higher of the two values for each component, a "lighten" compositing.
+void maxColors( Color * dst, const Color * src, size_t count ) noexcept;
+
+/// Limits each component into the range given by the components of min and max.
+void clampColors( Color * dst, const Color * src, size_t count, Color min, Color max ) noexcept;
+
+/// Converts colors from HSV, the same as Color::fromHSV() for each of them.
+void colorsFromHSV( Color * dst, const HSV * src, size_t count ) noexcept;
+
+/// Converts colors from HSL, the same as Color::fromHSL() for each of them.
+void colorsFromHSL( Color * dst, const HSL * src, size_t count ) noexcept;
+
+/// Converts colors to HSV, the same as Color::toHSV() for each of them.
+/** The divisions are replaced by table lookups. AVX2 does them in vectors, SSE2 loads the table values one by one
+  * and computes the rest in vectors, NEON converts the colors one by one. */
+void colorsToHSV( HSV * dst, const Color * src, size_t count ) noexcept;
+
+/// Converts colors to HSL, the same as Color::toHSL() for each of them.
+/** Like colorsToHSV(), this is vectorized with AVX2 and SSE2, but not with NEON. */
+void colorsToHSL( HSL * dst, const Color * src, size_t count ) noexcept;
+
+/// Picks the colors from arbitrary positions of src, dst[i] = src[ indexes[i] ].
+/** This is what maps a 2D image to the LEDs of a device, see MatrixMapper. The indexes must be lower than 2^31.
+  * Only AVX2 can load from many positions at once, the other instruction sets pick the colors one by one.
+  * Unlike the other operations, dst must not be the same buffer as src. */
+void gatherColors( Color * dst, const Color * src, const uint32_t * indexes, size_t count ) noexcept;
+
+/// Precomputed mapping of 8-bit component values for gamma correction or any other per-component curve.
+class GammaTable
+{
+
+ public:
+
+	/// Creates the table of value = 255 * (input / 255) ^ gamma, rounded to the nearest.
+	/** Gamma larger than 1 makes the dim colors dimmer, which compensates for the linear response of most LEDs. */
+	explicit GammaTable( double gamma = 2.2 ) noexcept;
+
+	uint8_t operator[]( uint8_t input ) const noexcept  { return _values[ input ]; }
+
+ private:
+
+	uint8_t _values [256];
+
+};
+
+/// Maps all color components through the table.
+/** Byte lookups don't vectorize well, so this is the same in all instruction sets. */
+void applyGamma( Color * dst, const Color * src, size_t count, const GammaTable & table ) noexcept;
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_COLOR_BUFFER_INCLUDED
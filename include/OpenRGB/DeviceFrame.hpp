@@ -0,0 +1,101 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: colors of all the LEDs of a device, composed zone by zone
+//======================================================================================================================
+
+#ifndef OPENRGB_DEVICE_FRAME_INCLUDED
+#define OPENRGB_DEVICE_FRAME_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Colors of all the LEDs of a device in one contiguous buffer, composed zone by zone.
+/** Each zone gets its part of the buffer starting at Zone::startIdx, so effects of different zones can render
+  * straight into the frame of the whole device. The frame remembers which zones were edited since it was last sent,
+  * and Client::sendFrame() then sends only those, in whichever way takes the least bytes.
+  *
+  * The Device object must stay alive as long as the frame, so don't destroy the DeviceList it comes from while
+  * using the frame. When the device list is updated, create a new frame. */
+
+class DeviceFrame
+{
+
+ public:
+
+	/// Creates a frame for all the LEDs of the device, starting with the colors the device reported.
+	/** Nothing is marked as dirty yet. */
+	explicit DeviceFrame( const Device & device ) noexcept;
+
+	const Device & device() const noexcept  { return *_device; }
+
+	/// Number of LEDs of the whole device.
+	size_t size() const noexcept            { return _colors.size(); }
+
+	/// Colors of all the LEDs of the device in the order of Device::leds.
+	const Color * colors() const noexcept   { return _colors.data(); }
+
+	/// Colors of the LEDs of the zone, there is Zone::leds_count of them.
+	/** \returns nullptr when the zone doesn't belong to this device */
+	const Color * zoneColors( const Zone & zone ) const noexcept;
+
+	/// Colors of all the LEDs of the device for writing, marks the whole device as dirty.
+	Color * editColors() noexcept;
+
+	/// Colors of the LEDs of the zone for writing, marks the zone as dirty.
+	/** There is Zone::leds_count of them.
+	  * \returns nullptr when the zone doesn't belong to this device */
+	Color * editZone( const Zone & zone ) noexcept;
+
+	/// Fills all the LEDs of the zone with one color and marks the zone as dirty.
+	void setZoneColor( const Zone & zone, Color color ) noexcept;
+
+	/// Marks the zone as changed without writing to it, for example when its colors were written via editColors().
+	void markDirty( const Zone & zone ) noexcept;
+
+	/// Marks the whole device as changed, so the next send will update all of its LEDs.
+	void markAllDirty() noexcept;
+
+	/// Marks everything as sent, Client::sendFrame() does this after a successful send.
+	void markClean() noexcept;
+
+	/// Whether anything has changed since the frame was last sent.
+	bool isDirty() const noexcept           { return _allDirty || _dirtyZoneCount > 0; }
+
+	/// Whether the LEDs of the whole device have to be sent, including those that don't belong to any zone.
+	bool isAllDirty() const noexcept        { return _allDirty; }
+
+	/// Whether the zone has changed since the frame was last sent.
+	bool isDirty( const Zone & zone ) const noexcept;
+
+ private:
+
+	bool belongsHere( const Zone & zone ) const noexcept;
+
+	const Device * _device;
+	std::vector< Color > _colors;
+	std::vector< bool > _dirtyZones;  ///< indexed by Zone::idx
+	size_t _dirtyZoneCount;
+	bool _allDirty;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_DEVICE_FRAME_INCLUDED
@@ -13,9 +13,16 @@
 
 #include "Color.hpp"
 
+#include <cstring>  // memcmp
 #include <string>
 #include <vector>
 #include <memory>  // unique_ptr<Device>
+#include <atomic>  // lazy decoding
+#include <unordered_map>  // lookup indexes
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+	#define OPENRGB_HAS_STRING_VIEW
+	#include <string_view>
+#endif
 
 
 namespace orgb {
@@ -91,6 +98,175 @@ enum class ZoneType : uint32_t
 const char * enumString( ZoneType ) noexcept;
 
 
+//======================================================================================================================
+/// Read-only array of device sub-objects that can be decoded from the server reply only when they are first needed.
+/** Normally the elements are decoded together with the rest of the device and this behaves just like a const
+  * std::vector. When the lazy parsing is enabled via Client::setLazyDeviceParsing(), only the number of elements
+  * is known after the device is received, and the elements are decoded from a kept copy of the reply on the first
+  * access to them. size() and empty() never decode anything. Concurrent first accesses from several threads are safe.
+  *
+  * It has the whole read-only interface of std::vector and converts to const std::vector & implicitly.
+  * The only thing the conversion can't do is template argument deduction, so a function template taking
+  * const std::vector< T > & needs the elements() explicitly. */
+
+struct LazyDeviceData;  // internal, the kept copy of the reply
+
+template< typename Elem >
+class LazyArray
+{
+
+ public:
+
+	using vector_type = std::vector< Elem >;
+	using value_type = Elem;
+	using allocator_type = typename vector_type::allocator_type;
+	using size_type = typename vector_type::size_type;
+	using difference_type = typename vector_type::difference_type;
+	using const_reference = typename vector_type::const_reference;
+	using reference = const_reference;
+	using const_pointer = typename vector_type::const_pointer;
+	using pointer = const_pointer;
+	using const_iterator = typename vector_type::const_iterator;
+	using iterator = const_iterator;
+	using const_reverse_iterator = typename vector_type::const_reverse_iterator;
+	using reverse_iterator = const_reverse_iterator;
+
+	LazyArray() noexcept : _size( 0 ), _isDecoded( true ) {}
+	LazyArray( const LazyArray & other ) : LazyArray( other, other.isDecoded() ) {}
+	LazyArray & operator=( const LazyArray & other ) = delete;
+
+	size_type size() const noexcept  { return _size; }
+	bool empty() const noexcept      { return _size == 0; }
+	size_type max_size() const noexcept  { return _elements.max_size(); }
+	size_type capacity() const       { return elements().capacity(); }
+	allocator_type get_allocator() const noexcept  { return _elements.get_allocator(); }
+
+	const_reference operator[]( size_type idx ) const  { return elements()[ idx ]; }
+	const_reference at( size_type idx ) const          { return elements().at( idx ); }
+	const_reference front() const                      { return elements().front(); }
+	const_reference back() const                       { return elements().back(); }
+	const_pointer data() const                         { return elements().data(); }
+
+	const_iterator begin() const                 { return elements().begin(); }
+	const_iterator end() const                   { return elements().end(); }
+	const_iterator cbegin() const                { return elements().cbegin(); }
+	const_iterator cend() const                  { return elements().cend(); }
+	const_reverse_iterator rbegin() const        { return elements().rbegin(); }
+	const_reverse_iterator rend() const          { return elements().rend(); }
+	const_reverse_iterator crbegin() const       { return elements().crbegin(); }
+	const_reverse_iterator crend() const         { return elements().crend(); }
+
+	/// Returns all the elements, decodes them first if it hasn't been done yet.
+	const std::vector< Elem > & elements() const
+	{
+		if (!_isDecoded.load( std::memory_order_acquire ))
+			decode();
+		return _elements;
+	}
+	operator const std::vector< Elem > &() const  { return elements(); }
+
+	/// Tells whether the elements are already in memory, so that accessing them is for free.
+	bool isDecoded() const noexcept  { return _isDecoded.load( std::memory_order_acquire ); }
+
+ private:  // for internal use only
+
+	// once decoded, the elements never change, so they can be copied without locking
+	LazyArray( const LazyArray & other, bool otherIsDecoded )
+	:
+		_elements( otherIsDecoded ? other._elements : std::vector< Elem >() ),
+		_size( other._size ),
+		_isDecoded( otherIsDecoded ),
+		_source( other._source )
+	{}
+
+	friend class Device;
+	void assign( std::vector< Elem > && elems ) noexcept
+	{
+		_elements = std::move( elems );
+		_size = _elements.size();
+		_isDecoded.store( true, std::memory_order_release );
+	}
+	void assignLazy( const std::shared_ptr< const LazyDeviceData > & source, size_t size ) noexcept
+	{
+		_elements.clear();
+		_size = size;
+		_source = source;
+		_isDecoded.store( size == 0, std::memory_order_release );
+	}
+	void decode() const;  // defined in DeviceInfo.cpp for Mode and LED
+
+	mutable std::vector< Elem > _elements;
+	size_t _size;
+	mutable std::atomic< bool > _isDecoded;
+	std::shared_ptr< const LazyDeviceData > _source;  ///< shared by all the lazy arrays of the same device
+
+};
+
+// comparisons with each other and with vectors, the same as between vectors
+
+#define OPENRGB_LAZY_ARRAY_COMPARISON( op ) \
+	template< typename Elem > \
+	bool operator op( const LazyArray< Elem > & a, const LazyArray< Elem > & b )  { return a.elements() op b.elements(); } \
+	template< typename Elem > \
+	bool operator op( const LazyArray< Elem > & a, const std::vector< Elem > & b )  { return a.elements() op b; } \
+	template< typename Elem > \
+	bool operator op( const std::vector< Elem > & a, const LazyArray< Elem > & b )  { return a op b.elements(); }
+
+OPENRGB_LAZY_ARRAY_COMPARISON( == )
+OPENRGB_LAZY_ARRAY_COMPARISON( != )
+OPENRGB_LAZY_ARRAY_COMPARISON( < )
+OPENRGB_LAZY_ARRAY_COMPARISON( <= )
+OPENRGB_LAZY_ARRAY_COMPARISON( > )
+OPENRGB_LAZY_ARRAY_COMPARISON( >= )
+
+#undef OPENRGB_LAZY_ARRAY_COMPARISON
+
+
+//======================================================================================================================
+/// Hash table from the names of modes, zones or LEDs of a device to their positions, used by Device::findLED() etc.
+/** The table is built on the first lookup, so devices that are never searched don't pay for it and the lazily parsed
+  * arrays stay undecoded. Concurrent first lookups from several threads are safe. */
+
+class NameIndex
+{
+
+ public:
+
+	NameIndex() noexcept : _isBuilt( false ) {}
+	// a copy builds its own table, copying this one could race with another thread building it
+	NameIndex( const NameIndex & ) noexcept : _isBuilt( false ) {}
+	NameIndex & operator=( const NameIndex & other ) = delete;
+
+ private:  // for internal use only
+
+	friend class Device;
+
+	static constexpr size_t notFound = size_t(-1);
+
+	// defined in DeviceInfo.cpp for the arrays of Device
+	template< typename Elems >
+	size_t find( const Elems & elems, const char * name, size_t length ) const noexcept;
+	template< typename Elems >
+	void build( const Elems & elems ) const;
+
+	/// Must be called whenever the indexed elements change.
+	void reset() noexcept
+	{
+		_slots.clear();
+		_isBuilt.store( false, std::memory_order_release );
+	}
+
+	struct Slot
+	{
+		uint32_t hash;     ///< upper half of the name hash, to skip most of the string comparisons
+		uint32_t elemIdx;  ///< position of the element + 1, 0 means empty slot
+	};
+	mutable std::vector< Slot > _slots;  ///< open addressing with linear probing, the size is a power of 2
+	mutable std::atomic< bool > _isBuilt;
+
+};
+
+
 //======================================================================================================================
 /// Represents a particular LED on an RGB device.
 
@@ -129,6 +305,7 @@ class Zone
 	// metadata
 	const uint32_t idx;        ///< index of this zone in the device's list of zones
 	const uint32_t parentIdx;  ///< index of the parent device in the device list
+	const uint32_t startIdx;   ///< index of the first LED of this zone in the device's list of LEDs
 
 	// zone description
 	const std::string  name;
@@ -139,7 +316,12 @@ class Zone
 	// optional
 	const uint32_t     matrix_height;  ///< if the zone type is matrix, this is its height
 	const uint32_t     matrix_width;   ///< if the zone type is matrix, this is its width
-	const std::vector< uint32_t >  matrix_values;  ///< TODO: what is this?
+	/// Grid of matrix_width x matrix_height cells row by row, each holding the index of the LED within this zone
+	/// at that position, or noLED where there is none. Use MatrixMapper to map images onto it.
+	const std::vector< uint32_t >  matrix_values;
+
+	/// Value of the cells of matrix_values that have no LED.
+	static constexpr uint32_t noLED = 0xFFFFFFFF;
 
  private:  // for internal use only
 
@@ -227,83 +409,95 @@ class Device
 	const uint32_t     active_mode;
 
 	// device subobjects
-	const std::vector< Mode > modes;
+	const LazyArray< Mode > modes;    ///< decoded on the first access when the lazy parsing is enabled
 	const std::vector< Zone > zones;
-	const std::vector< LED >  leds;
+	const LazyArray< LED >  leds;     ///< decoded on the first access when the lazy parsing is enabled, size() is always known
 	const std::vector< Color > colors;
 
  public:
 
+	// The lookups by name use hash tables built on the first lookup, so they take constant time.
+
 	/// Finds the first mode with a specific name.
 	/** \returns nullptr when mode with this name is not found. */
-	const Mode * findMode( const std::string & name ) const noexcept
-	{
-		for (const auto & mode : modes)
-			if (mode.name == name)
-				return &mode;
-		return nullptr;
-	}
+	const Mode * findMode( const std::string & name ) const noexcept  { return findModeByName( name.data(), name.size() ); }
+	const Mode * findMode( const char * name ) const noexcept         { return findModeByName( name, strlen( name ) ); }
 
 	/// Finds the first zone with a specific name.
 	/** \returns nullptr when zone with this name is not found. */
-	const Zone * findZone( const std::string & name ) const noexcept
-	{
-		for (const auto & zone : zones)
-			if (zone.name == name)
-				return &zone;
-		return nullptr;
-	}
+	const Zone * findZone( const std::string & name ) const noexcept  { return findZoneByName( name.data(), name.size() ); }
+	const Zone * findZone( const char * name ) const noexcept         { return findZoneByName( name, strlen( name ) ); }
 
 	/// Finds the first LED with a specific name.
 	/** \returns nullptr when LED with this name is not found. */
-	const LED * findLED( const std::string & name ) const noexcept
-	{
-		for (const auto & led : leds)
-			if (led.name == name)
-				return &led;
-		return nullptr;
-	}
+	const LED * findLED( const std::string & name ) const noexcept  { return findLEDByName( name.data(), name.size() ); }
+	const LED * findLED( const char * name ) const noexcept         { return findLEDByName( name, strlen( name ) ); }
+
+#ifdef OPENRGB_HAS_STRING_VIEW
+	const Mode * findMode( std::string_view name ) const noexcept  { return findModeByName( name.data(), name.size() ); }
+	const Zone * findZone( std::string_view name ) const noexcept  { return findZoneByName( name.data(), name.size() ); }
+	const LED * findLED( std::string_view name ) const noexcept    { return findLEDByName( name.data(), name.size() ); }
+#endif // OPENRGB_HAS_STRING_VIEW
 
 #ifndef NO_EXCEPTIONS
 
-	/// Exception-throwing variant of findModeX( const std::string & ) const.
+	/// Exception-throwing variant of findMode( const std::string & ) const.
 	/** \throws NotFound when mode with this name is not found. */
-	const Mode & findModeX( const std::string & name ) const
-	{
-		for (const auto & mode : modes)
-			if (mode.name == name)
-				return mode;
-		throw NotFound( "Mode of such name was not found" );
-	}
+	const Mode & findModeX( const std::string & name ) const  { return foundOrThrow( findMode( name ), "Mode of such name was not found" ); }
+	const Mode & findModeX( const char * name ) const         { return foundOrThrow( findMode( name ), "Mode of such name was not found" ); }
 
-	/// Exception-throwing variant of findZoneX( const std::string & ) const.
+	/// Exception-throwing variant of findZone( const std::string & ) const.
 	/** \throws NotFound when zone with this name is not found. */
-	const Zone & findZoneX( const std::string & name ) const
-	{
-		for (const auto & zone : zones)
-			if (zone.name == name)
-				return zone;
-		throw NotFound( "Zone of such name was not found" );
-	}
+	const Zone & findZoneX( const std::string & name ) const  { return foundOrThrow( findZone( name ), "Zone of such name was not found" ); }
+	const Zone & findZoneX( const char * name ) const         { return foundOrThrow( findZone( name ), "Zone of such name was not found" ); }
 
-	/// Exception-throwing variant of findLEDX( const std::string & ) const.
+	/// Exception-throwing variant of findLED( const std::string & ) const.
 	/** \throws NotFound when LED with this name is not found. */
-	const LED & findLEDX( const std::string & name ) const
-	{
-		for (const auto & led : leds)
-			if (led.name == name)
-				return led;
-		throw NotFound( "LED of such name was not found" );
-	}
+	const LED & findLEDX( const std::string & name ) const  { return foundOrThrow( findLED( name ), "LED of such name was not found" ); }
+	const LED & findLEDX( const char * name ) const         { return foundOrThrow( findLED( name ), "LED of such name was not found" ); }
+
+ #ifdef OPENRGB_HAS_STRING_VIEW
+	const Mode & findModeX( std::string_view name ) const  { return foundOrThrow( findMode( name ), "Mode of such name was not found" ); }
+	const Zone & findZoneX( std::string_view name ) const  { return foundOrThrow( findZone( name ), "Zone of such name was not found" ); }
+	const LED & findLEDX( std::string_view name ) const    { return foundOrThrow( findLED( name ), "LED of such name was not found" ); }
+ #endif // OPENRGB_HAS_STRING_VIEW
 
 #endif // NO_EXCEPTIONS
 
  private:  // for internal use only
 
+	const Mode * findModeByName( const char * name, size_t length ) const noexcept;
+	const Zone * findZoneByName( const char * name, size_t length ) const noexcept;
+	const LED * findLEDByName( const char * name, size_t length ) const noexcept;
+
+#ifndef NO_EXCEPTIONS
+	template< typename Elem >
+	static const Elem & foundOrThrow( const Elem * elem, const char * errorMessage )
+	{
+		if (!elem)
+			throw NotFound( errorMessage );
+		return *elem;
+	}
+#endif // NO_EXCEPTIONS
+
+	NameIndex _modeIndex;
+	NameIndex _zoneIndex;
+	NameIndex _ledIndex;
+	void resetNameIndexes() noexcept  { _modeIndex.reset(); _zoneIndex.reset(); _ledIndex.reset(); }
+
 	friend struct ReplyControllerData;
 	size_t calcSize( uint32_t protocolVersion ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t protocolVersion ) const;
 	bool deserialize( own::BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept;
+	/// Parses only what's needed right away and keeps a copy of the bytes for decoding the modes and LEDs later.
+	bool deserializeLazily( const uint8_t * data, size_t size, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept;
+	uint16_t deserializeHeader( own::BinaryInputStream & stream ) noexcept;
+	/// The LEDs of the zones follow each other in the list of LEDs, so each zone starts where the previous one ends.
+	void computeZoneOffsets() noexcept;
+
+	template< typename Elem > friend class LazyArray;
+	static void decodeLazily( const LazyDeviceData & source, std::vector< Mode > & modes );
+	static void decodeLazily( const LazyDeviceData & source, std::vector< LED > & leds );
 
 	friend class DeviceList;
 	friend class Client;
@@ -314,6 +508,11 @@ class Device
 };
 
 
+// the only instantiations, their decode() is compiled into the library
+extern template class LazyArray< Mode >;
+extern template class LazyArray< LED >;
+
+
 //======================================================================================================================
 /** Convenience wrapper around iterator to container of pointers
   * that skips the additional needed dereference and returns a reference directly. */
@@ -343,70 +542,124 @@ class DeviceList
 	using DeviceListType = std::vector< std::unique_ptr< Device > >;
 	DeviceListType _list;
 
+	/// Hashes of the raw server replies the devices were parsed from, 0 when unknown (the device was added manually).
+	/** Client::updateDeviceList() uses them to skip the devices that haven't changed. Can be shorter than _list. */
+	std::vector< uint64_t > _hashes;
+	/// Protocol version the devices were received in, the hashes can't be compared across versions. 0 when unknown.
+	uint32_t _protocolVersion = 0;
+
+	/// Lookup index: key -> indexes of the devices with that key in ascending order.
+	/** The strings are indexed by their hash, so that they can be looked up without constructing a std::string.
+	  * Different strings can share a hash, so the candidates still have to be compared. */
+	using IndexType = std::unordered_map< uint64_t, std::vector< uint32_t > >;
+	IndexType _nameIndex;
+	IndexType _vendorIndex;
+	IndexType _typeIndex;
+
  public:
 
 	size_t size() const noexcept { return _list.size(); }
 
 	/// Use this if you intend to populate the DeviceList manually using individual calls to Client::requestDeviceInfo().
-	void append( std::unique_ptr< Device > && device )  { _list.push_back( std::move(device) ); }
+	void append( std::unique_ptr< Device > && device )  { append( std::move(device), 0 ); }
 
 	/// Use this to update your DeviceList after the call to Client::requestDeviceInfo().
-	void replace( uint32_t deviceIdx, std::unique_ptr< Device > && device )  { _list[ deviceIdx ] = std::move(device); }
+	void replace( uint32_t deviceIdx, std::unique_ptr< Device > && device )  { replace( deviceIdx, std::move(device), 0 ); }
+
+	void clear() noexcept;
 
-	void clear() noexcept  { _list.clear(); }
+	/// Stores the list into a file, so that the next start of the application can have it immediately.
+	/** The file is written under a temporary name first and then renamed, so an interrupted write never leaves
+	  * a damaged file behind. Only meant for the same machine, the format depends on the library version.
+	  * \returns false when the file can't be written. */
+	bool saveToFile( const std::string & filePath ) const noexcept;
+
+	/// Replaces the content of this list with a list stored earlier by saveToFile().
+	/** The file is memory-mapped and each device is verified by its hash, so loading even a big list takes only a few
+	  * milliseconds. The devices may be out of date, bring them up to date with Client::updateDeviceList(), which
+	  * downloads the list again but reparses only the devices that differ.
+	  * \returns false when the file doesn't exist or isn't valid, the list is then left unchanged. */
+	bool loadFromFile( const std::string & filePath ) noexcept;
 
 	PointerIterator< DeviceListType::const_iterator > begin() const noexcept  { return _list.begin(); }
 	PointerIterator< DeviceListType::const_iterator > end() const noexcept    { return _list.end(); }
 
 	const Device & operator[]( uint32_t deviceIdx ) const noexcept { return *_list[ deviceIdx ]; }
 
+	// The lookups below use indexes that are kept up to date by every modification of the list,
+	// so they take constant time no matter how many devices there are.
+
 	/// Iterate over all devices of specific type.
 	template< typename FuncType >
 	void forEach( DeviceType deviceType, FuncType loopBody ) const
 	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				loopBody( device );
+		if (const std::vector< uint32_t > * candidates = typeCandidates( deviceType ))
+			for (uint32_t deviceIdx : *candidates)
+				loopBody( *_list[ deviceIdx ] );
 	}
 
 	/// Iterate over all devices of specific vendor.
 	template< typename FuncType >
 	void forEach( const std::string & vendor, FuncType loopBody ) const
 	{
-		for (const Device & device : *this)
-			if (device.vendor == vendor)
-				loopBody( device );
+		forEachOfVendor( vendor.data(), vendor.size(), loopBody );
+	}
+
+	/// Iterate over all devices of specific vendor.
+	template< typename FuncType >
+	void forEach( const char * vendor, FuncType loopBody ) const
+	{
+		forEachOfVendor( vendor, strlen( vendor ), loopBody );
 	}
 
 	/// Finds the first device of specific type.
 	/** \returns nullptr when device of this type is not found */
 	const Device * find( DeviceType deviceType ) const noexcept
 	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				return &device;
-		return nullptr;
+		const std::vector< uint32_t > * candidates = typeCandidates( deviceType );
+		return candidates ? _list[ candidates->front() ].get() : nullptr;
 	}
 
 	/// Finds the first device with a specific name.
 	/** \returns nullptr when device with this name is not found */
 	const Device * find( const std::string & deviceName ) const noexcept
 	{
-		for (const Device & device : *this)
-			if (device.name == deviceName)
-				return &device;
-		return nullptr;
+		return findByName( deviceName.data(), deviceName.size() );
+	}
+
+	/// Finds the first device with a specific name.
+	/** \returns nullptr when device with this name is not found */
+	const Device * find( const char * deviceName ) const noexcept
+	{
+		return findByName( deviceName, strlen( deviceName ) );
+	}
+
+#ifdef OPENRGB_HAS_STRING_VIEW
+
+	/// Iterate over all devices of specific vendor.
+	template< typename FuncType >
+	void forEach( std::string_view vendor, FuncType loopBody ) const
+	{
+		forEachOfVendor( vendor.data(), vendor.size(), loopBody );
+	}
+
+	/// Finds the first device with a specific name.
+	/** \returns nullptr when device with this name is not found */
+	const Device * find( std::string_view deviceName ) const noexcept
+	{
+		return findByName( deviceName.data(), deviceName.size() );
 	}
 
+#endif // OPENRGB_HAS_STRING_VIEW
+
 #ifndef NO_EXCEPTIONS
 
 	/// Exception-throwing variant of find( DeviceType ) const
 	/** \throws NotFound when device of this type is not found */
 	const Device & findX( DeviceType deviceType ) const
 	{
-		for (const Device & device : *this)
-			if (device.type == deviceType)
-				return device;
+		if (const Device * device = find( deviceType ))
+			return *device;
 		throw NotFound( "Device of such type was not found" );
 	}
 
@@ -414,20 +667,66 @@ class DeviceList
 	/** \throws NotFound when device with this name is not found */
 	const Device & findX( const std::string & deviceName ) const
 	{
-		for (const Device & device : *this)
-			if (device.name == deviceName)
-				return device;
+		if (const Device * device = find( deviceName ))
+			return *device;
+		throw NotFound( "Device of such name was not found" );
+	}
+
+	/// Exception-throwing variant of find( const char * ) const.
+	/** \throws NotFound when device with this name is not found */
+	const Device & findX( const char * deviceName ) const
+	{
+		if (const Device * device = find( deviceName ))
+			return *device;
+		throw NotFound( "Device of such name was not found" );
+	}
+
+ #ifdef OPENRGB_HAS_STRING_VIEW
+	/// Exception-throwing variant of find( std::string_view ) const.
+	/** \throws NotFound when device with this name is not found */
+	const Device & findX( std::string_view deviceName ) const
+	{
+		if (const Device * device = find( deviceName ))
+			return *device;
 		throw NotFound( "Device of such name was not found" );
 	}
+ #endif // OPENRGB_HAS_STRING_VIEW
 
 #endif // NO_EXCEPTIONS
 
  private:  // for internal use only
 
+	static bool equals( const std::string & str, const char * chars, size_t length ) noexcept
+	{
+		return str.size() == length && memcmp( str.data(), chars, length ) == 0;
+	}
+
+	template< typename FuncType >
+	void forEachOfVendor( const char * vendor, size_t length, FuncType loopBody ) const
+	{
+		if (const std::vector< uint32_t > * candidates = vendorCandidates( vendor, length ))
+			for (uint32_t deviceIdx : *candidates)
+				if (equals( _list[ deviceIdx ]->vendor, vendor, length ))
+					loopBody( *_list[ deviceIdx ] );
+	}
+
+	const Device * findByName( const char * name, size_t length ) const noexcept;
+	const std::vector< uint32_t > * vendorCandidates( const char * vendor, size_t length ) const noexcept;
+	const std::vector< uint32_t > * typeCandidates( DeviceType deviceType ) const noexcept;
+
+	void indexDevice( uint32_t deviceIdx );
+	void unindexDevice( uint32_t deviceIdx ) noexcept;
+
 	// this should only be used by the Client when constructing the list from the server response
 	friend class Client;
-	void reserve( size_t newSize )   { _list.reserve( newSize ); }
-	void append( Device && device )  { _list.emplace_back( new Device( std::move(device) ) ); }
+	void reserve( size_t newSize )   { _list.reserve( newSize ); _hashes.reserve( newSize ); }
+	void append( std::unique_ptr< Device > && device, uint64_t contentHash );
+	void replace( uint32_t deviceIdx, std::unique_ptr< Device > && device, uint64_t contentHash );
+	void truncate( size_t newSize ) noexcept;
+	uint64_t contentHash( uint32_t deviceIdx ) const noexcept
+	{
+		return deviceIdx < _hashes.size() ? _hashes[ deviceIdx ] : 0;
+	}
 
 };
 
@@ -0,0 +1,172 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: rendering of effects at a fixed frame rate
+//======================================================================================================================
+
+#ifndef OPENRGB_EFFECT_ENGINE_INCLUDED
+#define OPENRGB_EFFECT_ENGINE_INCLUDED
+
+
+#include "Client.hpp"
+#include "ClientStats.hpp"  // LatencyStats
+#include "DeviceInfo.hpp"
+#include "Effects.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+
+
+class LatencyHistogram;
+class ThreadPool;
+
+
+//======================================================================================================================
+
+/// How well the engine keeps up with its frame rate, see EffectEngine::stats().
+struct EffectEngineStats
+{
+	uint64_t renderedFrames = 0;  ///< frames rendered and sent since the start or the last resetStats()
+	uint64_t skippedFrames = 0;   ///< frames left out, because the previous ones took longer than the frame period
+	double achievedFps = 0.0;     ///< rendered frames per second since the start or the last resetStats()
+	LatencyStats jitter;          ///< how late the frames started after their scheduled time
+	LatencyStats frameTime;       ///< how long it took to render and send a frame
+};
+
+
+//======================================================================================================================
+/// Renders effects into the colors of devices and sends them to the server at a fixed frame rate.
+/** Each device can have one effect, which renders into a color buffer of the device kept by the engine.
+  * The frames are sent with Client::updateDeviceColors(), so only the LEDs that changed go over the network.
+  * In a steady state, rendering and sending a frame doesn't allocate any memory.
+  *
+  * With a ThreadPool set by setThreadPool(), the effects of different devices are rendered in parallel.
+  * The frames are still sent from the engine's thread, in the order of the device indexes, and each effect still
+  * renders only its own device, so the output is the same as when rendered by a single thread.
+  *
+  * The frames are rendered either by calling renderFrame() manually or by a background thread started by start().
+  * The thread schedules the frames by absolute deadlines, so the time spent by rendering and sending doesn't add up
+  * into a drift, and when a frame takes longer than the frame period, the missed frames are skipped
+  * instead of rendered in a burst.
+  *
+  * The Device objects passed to setEffect() must stay alive as long as they have an effect, so don't destroy
+  * the DeviceList they come from without calling clearEffects() first. While the background thread is running,
+  * other threads may use the client only if it is in the asynchronous mode, because only then the client serializes
+  * sending from multiple threads. */
+
+class EffectEngine
+{
+
+ public:
+
+	/// Creates an engine that sends frames through the \p client. Doesn't start the background thread yet.
+	EffectEngine( Client & client, unsigned int framesPerSecond = 60 ) noexcept;
+
+	/// Stops the background thread if it's running.
+	~EffectEngine() noexcept;
+
+	EffectEngine( const EffectEngine & other ) = delete;
+	EffectEngine & operator=( const EffectEngine & other ) = delete;
+
+	/// Makes the \p effect render the colors of the \p device, replacing its previous effect.
+	/** The engine takes the ownership of the effect. It can be called while the engine is running,
+	  * it then waits until the current frame is finished. */
+	void setEffect( const Device & device, std::unique_ptr< Effect > effect ) noexcept;
+
+	/// Stops rendering the device, its LEDs keep the last sent colors.
+	void removeEffect( const Device & device ) noexcept;
+
+	/// Stops rendering all the devices.
+	void clearEffects() noexcept;
+
+	/// Changes the frame rate, the background thread uses it from the next frame.
+	void setFrameRate( unsigned int framesPerSecond ) noexcept;
+
+	unsigned int frameRate() const noexcept;
+
+	/// Renders the effects of different devices by the threads of the \p pool, nullptr renders them one by one.
+	/** The pool must outlive the engine or be unset before it's destroyed. It can be shared with other users,
+	  * for example a SpatialCanvas, they then take turns. */
+	void setThreadPool( ThreadPool * pool ) noexcept;
+
+	/// Renders one frame of all the effects and sends it right now from the calling thread.
+	/** If some of the frames can't be sent, the rest is still attempted and the first error is returned. */
+	RequestStatus renderFrame() noexcept;
+
+	/// Starts a background thread that renders a frame every frame period.
+	/** \returns false when the thread is already running or can't be started. */
+	bool start() noexcept;
+
+	/// Stops the background thread and waits for it to finish.
+	void stop() noexcept;
+
+	/// Tells whether the background rendering thread is running.
+	bool isRunning() const noexcept;
+
+	/// Status of the last rendered frame.
+	RequestStatus lastFrameStatus() const noexcept  { return _lastFrameStatus; }
+
+	/// Returns the frame rate and timing statistics since the start or the last resetStats().
+	EffectEngineStats stats() const noexcept;
+
+	void resetStats() noexcept;
+
+ private:
+
+	using Clock = std::chrono::steady_clock;
+
+	/// Effect of one device together with the colors it renders into.
+	struct DeviceEffect
+	{
+		const Device * device;
+		std::unique_ptr< Effect > effect;
+		std::vector< Color > colors;    ///< the last rendered frame, reused for the next one
+		Clock::time_point lastFrame;    ///< scheduled time of the last rendered frame
+		bool rendered = false;          ///< whether lastFrame is valid
+	};
+
+	RequestStatus renderFrameAt( Clock::time_point frameTime ) noexcept;
+	void renderLoop() noexcept;
+
+	Client & _client;
+
+	std::mutex _effectsMutex;  ///< guards the effects, held during the whole frame
+	std::vector< DeviceEffect > _effects;  ///< ordered by the device index
+
+	std::thread _thread;
+	std::mutex _threadMutex;
+	std::condition_variable _stopCond;
+	bool _stopRequested;
+	std::atomic< int64_t > _framePeriodNs;
+	ThreadPool * _threadPool;  ///< guarded by the _effectsMutex
+
+	std::atomic< Clock::rep > _startTime;  ///< time_since_epoch() of the start of the animations
+	std::atomic< uint64_t > _frameIdx;
+
+	std::atomic< RequestStatus > _lastFrameStatus;
+	std::atomic< Clock::rep > _statsSince;  ///< time_since_epoch() of the start or the last resetStats()
+	std::atomic< uint64_t > _renderedFrames;
+	std::atomic< uint64_t > _skippedFrames;
+	std::unique_ptr< LatencyHistogram > _jitter;
+	std::unique_ptr< LatencyHistogram > _frameTime;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_EFFECT_ENGINE_INCLUDED
@@ -0,0 +1,194 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: animated effects rendered by the EffectEngine
+//======================================================================================================================
+
+#ifndef OPENRGB_EFFECTS_INCLUDED
+#define OPENRGB_EFFECTS_INCLUDED
+
+
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Timing of the frame being rendered.
+
+struct FrameTime
+{
+	/// Time of the frame since the engine started.
+	/** It's the scheduled time, not the time the frame actually started, so the animations stay smooth
+	  * even when the thread wakes up a bit late. */
+	std::chrono::nanoseconds sinceStart { 0 };
+	/// Time since the previous frame of the same effect, 0 in its first frame.
+	std::chrono::nanoseconds sincePrevious { 0 };
+	/// Number of frames the engine has rendered before this one.
+	uint64_t frameIdx = 0;
+
+	double seconds() const noexcept         { return double( sinceStart.count() ) / 1e9; }
+	double deltaSeconds() const noexcept    { return double( sincePrevious.count() ) / 1e9; }
+};
+
+
+//======================================================================================================================
+/// Animation that produces the colors of one device, frame by frame.
+/** An effect can keep state between the frames, so every device needs its own instance.
+  * The engine may render different instances from different threads at once, but never one instance from two
+  * threads, so an effect doesn't need any locking as long as it doesn't share anything with other instances. */
+
+class Effect
+{
+
+ public:
+
+	virtual ~Effect() = default;
+
+	/// Renders one frame into \p colors, which has one color for each LED of the device.
+	/** The buffer still holds the previous frame of this effect (black before the first one), so the effect can
+	  * build on it. It's called from the thread of the engine or from a thread of its pool and should never block. */
+	virtual void render( Color * colors, size_t count, const FrameTime & time ) noexcept = 0;
+
+};
+
+
+//======================================================================================================================
+//  built-in effects
+
+/// All the LEDs have the same color.
+class StaticEffect : public Effect
+{
+
+ public:
+
+	StaticEffect( Color color ) noexcept : _color( color ) {}
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	Color _color;
+
+};
+
+/// Rainbow moving along the LEDs.
+class RainbowWaveEffect : public Effect
+{
+
+ public:
+
+	/// \param cyclesPerSecond  how many times per second every LED goes through all the colors, negative reverses the direction
+	/// \param ledsPerCycle  length of the whole rainbow in LEDs
+	RainbowWaveEffect( double cyclesPerSecond = 0.25, double ledsPerCycle = 30.0, uint8_t saturation = 255, uint8_t value = 255 ) noexcept;
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	double _cyclesPerSecond;
+	uint32_t _huePerLed;  ///< hue difference of neighbouring LEDs, with 16 fractional bits
+	uint8_t _saturation;
+	uint8_t _value;
+	std::vector< HSV > _hues;  ///< reused between the frames
+
+};
+
+/// One color smoothly fading in and out.
+class BreathingEffect : public Effect
+{
+
+ public:
+
+	BreathingEffect( Color color, std::chrono::milliseconds period = std::chrono::milliseconds( 4000 ) ) noexcept;
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	Color _color;
+	std::chrono::nanoseconds _period;
+
+};
+
+/// Linear transition between two colors from the first to the last LED.
+class GradientEffect : public Effect
+{
+
+ public:
+
+	GradientEffect( Color from, Color to ) noexcept : _from( from ), _to( to ) {}
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	Color _from;
+	Color _to;
+	std::vector< Color > _gradient;  ///< computed once for the LED count of the device
+
+};
+
+/// A light with a fading tail running around the LEDs.
+class ChaseEffect : public Effect
+{
+
+ public:
+
+	/// \param length  number of lit LEDs including the tail
+	/// \param ledsPerSecond  speed of the head, negative reverses the direction
+	ChaseEffect( Color color, Color background = Color::Black, unsigned int length = 5, double ledsPerSecond = 20.0 ) noexcept;
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	Color _color;
+	Color _background;
+	unsigned int _length;
+	double _ledsPerSecond;
+
+};
+
+/// Random LEDs flash up and fade back into the background.
+class SparkleEffect : public Effect
+{
+
+ public:
+
+	/// \param sparklesPerSecond  how often a single LED flashes on average
+	/// \param fadeTime  how long it takes a flash to fade out
+	SparkleEffect( Color color, Color background = Color::Black, double sparklesPerSecond = 0.5,
+	               std::chrono::milliseconds fadeTime = std::chrono::milliseconds( 300 ), uint64_t seed = 1 ) noexcept;
+
+	void render( Color * colors, size_t count, const FrameTime & time ) noexcept override;
+
+ private:
+
+	uint32_t nextRandom() noexcept;
+
+	Color _color;
+	Color _background;
+	double _sparklesPerSecond;
+	std::chrono::nanoseconds _fadeTime;
+	uint64_t _randomState;
+	double _pendingSparkles;         ///< the fractional part of the sparkles that didn't fit into the previous frames
+	std::vector< uint8_t > _energy;  ///< brightness of the flash of each LED
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_EFFECTS_INCLUDED
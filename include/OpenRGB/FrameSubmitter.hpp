@@ -0,0 +1,145 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: coalescing of color frames before they are sent to the server
+//======================================================================================================================
+
+#ifndef OPENRGB_FRAME_SUBMITTER_INCLUDED
+#define OPENRGB_FRAME_SUBMITTER_INCLUDED
+
+
+#include "Client.hpp"
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Sits between a frame producer and the Client and makes sure that only the latest frame of each device gets sent.
+/** Every device and every zone has one slot for a frame waiting to be sent. A new frame overwrites an older one
+  * that hasn't been sent yet, so when the producer is faster than the server can absorb, the stale frames are dropped
+  * instead of piling up in the TCP buffers, and the delay between producing a frame and seeing it on the LEDs stays
+  * bounded by the flush period.
+  *
+  * The frames are sent either by calling flush() manually or by a background thread started by start(),
+  * which flushes at a fixed cadence. The submit methods never wait for the network, they can be called from any thread.
+  *
+  * The Device and Zone objects passed to the submit methods must stay alive until their frames are sent or dropped,
+  * so don't destroy the DeviceList they come from without calling clear() first.
+  * While the background thread is running, other threads may use the client only if it is in the asynchronous mode,
+  * because only then the client serializes sending from multiple threads. */
+
+class FrameSubmitter
+{
+
+ public:
+
+	/// Creates a submitter that sends frames through the \p client. Doesn't start the background thread yet.
+	FrameSubmitter( Client & client, std::chrono::milliseconds flushPeriod = std::chrono::milliseconds( 16 ) ) noexcept;
+
+	/// Stops the background thread if it's running. Pending frames are not sent.
+	~FrameSubmitter() noexcept;
+
+	FrameSubmitter( const FrameSubmitter & other ) = delete;
+	FrameSubmitter & operator=( const FrameSubmitter & other ) = delete;
+
+	/// Stores a frame for the whole device, replacing an unsent frame of this device and of all its zones.
+	/** The colors should be in the same order as Device::leds and there should be as many of them. */
+	void submitDeviceFrame( const Device & device, const std::vector< Color > & colors ) noexcept;
+
+	/// Stores a frame for a single zone, replacing an unsent frame of this zone.
+	/** There should be exactly Zone::leds_count colors.
+	  * When a frame for the whole device is pending as well, it is sent first and the zone frame goes on top of it. */
+	void submitZoneFrame( const Zone & zone, const std::vector< Color > & colors ) noexcept;
+
+	/// Sends all the pending frames right now from the calling thread.
+	/** If some of the frames can't be sent, the rest is still attempted and the first error is returned. */
+	RequestStatus flush() noexcept;
+
+	/// Drops all the pending frames without sending them.
+	void clear() noexcept;
+
+	/// Changes how often the background thread flushes the pending frames.
+	void setFlushPeriod( std::chrono::milliseconds flushPeriod ) noexcept;
+
+	/// Starts a background thread that calls flush() every flush period.
+	/** \returns false when the thread is already running or can't be started. */
+	bool start() noexcept;
+
+	/// Stops the background thread and waits for it to finish.
+	void stop() noexcept;
+
+	/// Tells whether the background flushing thread is running.
+	bool isRunning() const noexcept;
+
+	/// Status of the last flush that had something to send.
+	RequestStatus lastFlushStatus() const noexcept  { return _lastFlushStatus; }
+
+	/// Number of frames that have been sent to the server.
+	uint64_t sentFrames() const noexcept     { return _sentFrames; }
+
+	/// Number of frames that have been overwritten by a newer frame or cleared before they could be sent.
+	uint64_t droppedFrames() const noexcept  { return _droppedFrames; }
+
+	/// Resets the sent and dropped counters to zero.
+	void resetCounters() noexcept;
+
+ private:
+
+	/// Frame waiting to be sent, either for a whole device or for one zone.
+	struct Slot
+	{
+		const Device * device = nullptr;
+		const Zone * zone = nullptr;     ///< nullptr means the frame is for the whole device
+		std::vector< Color > colors;     ///< the latest submitted frame
+		std::vector< Color > sending;    ///< the frame currently being sent, swapped with colors to avoid allocations
+		bool pending = false;
+	};
+
+	/// Device frames sort before the frames of their zones, so that the zones are drawn over the whole device.
+	static uint64_t deviceKey( uint32_t deviceIdx ) noexcept             { return uint64_t( deviceIdx ) << 32; }
+	static uint64_t zoneKey( uint32_t deviceIdx, uint32_t zoneIdx ) noexcept  { return deviceKey( deviceIdx ) | ( uint64_t( zoneIdx ) + 1 ); }
+
+	void storeFrame( Slot & slot, const std::vector< Color > & colors ) noexcept;
+	void flushLoop() noexcept;
+
+	Client & _client;
+
+	std::mutex _slotsMutex;  ///< guards the pending frames, held only while copying colors, never while sending
+	std::map< uint64_t, Slot > _slots;
+
+	std::mutex _flushMutex;  ///< allows only one flush at a time
+	std::vector< Slot * > _toSend;
+
+	std::thread _thread;
+	std::mutex _threadMutex;
+	std::condition_variable _stopCond;
+	bool _stopRequested;
+	std::atomic< int64_t > _flushPeriodMs;
+
+	std::atomic< RequestStatus > _lastFlushStatus;
+	std::atomic< uint64_t > _sentFrames;
+	std::atomic< uint64_t > _droppedFrames;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_FRAME_SUBMITTER_INCLUDED
@@ -0,0 +1,104 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: mapping of 2D images onto the LEDs of matrix zones
+//======================================================================================================================
+
+#ifndef OPENRGB_MATRIX_MAPPER_INCLUDED
+#define OPENRGB_MATRIX_MAPPER_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Maps a 2D image onto the LEDs of a matrix zone, like a keyboard or an LED panel.
+/** OpenRGB describes a matrix zone by a grid of Zone::matrix_width x Zone::matrix_height cells, each holding the index
+  * of the LED within the zone, or Zone::noLED where there is a hole. The mapper turns it into a table that holds
+  * the position of the pixel of each LED in the image, so mapping a frame is a single gather pass over the LEDs,
+  * without looking at the holes at all.
+  *
+  * The image has a pixel for each cell of the grid, row by row from the top left corner.
+  * The LEDs of the zone that are not in the grid are left unchanged. */
+
+class MatrixMapper
+{
+
+ public:
+
+	/// Creates a mapper that maps nothing.
+	MatrixMapper() noexcept;
+
+	/// Builds the mapping of a matrix zone of the device.
+	/** \param stride  number of pixels from the beginning of one row of the image to the next one,
+	  *                0 means the image is exactly Zone::matrix_width pixels wide
+	  * \returns false when the zone has no valid matrix or its LEDs don't fit into the device, the mapper then maps nothing */
+	bool build( const Device & device, const Zone & zone, size_t stride = 0 ) noexcept;
+
+	/// Forgets the mapping.
+	void clear() noexcept;
+
+	bool isEmpty() const noexcept            { return _runs.empty(); }
+
+	uint32_t width() const noexcept          { return _width; }
+	uint32_t height() const noexcept         { return _height; }
+	size_t stride() const noexcept           { return _stride; }
+
+	/// Index of the first LED of the zone in the LEDs of the whole device, the same as Zone::startIdx.
+	uint32_t zoneOffset() const noexcept     { return _zoneOffset; }
+	/// Number of LEDs of the zone, the size of the colors written by the map methods.
+	uint32_t zoneSize() const noexcept       { return _zoneSize; }
+	/// Number of LEDs of the zone that have a pixel in the image.
+	size_t mappedLEDs() const noexcept       { return _pixels.size(); }
+
+	/// Sets the colors of the LEDs of the zone to the colors of their pixels.
+	/** \p zoneColors has zoneSize() colors, in the order of the LEDs of the zone, ready for Client::setZoneColors().
+	  * To render a frame of the whole device and send it in a single message by Client::setDeviceColors(),
+	  * pass deviceColors.data() + zoneOffset() instead.
+	  * It's the fastest with AVX2, which picks 8 pixels at once. */
+	void map( const Color * image, Color * zoneColors ) const noexcept;
+
+	/// The same as map() for an image with 4 bytes per pixel in the order red, green, blue and alpha.
+	/** The alpha is ignored. This is the memory layout of Color, so it's as fast as map(). */
+	void mapRGBA( const uint8_t * image, Color * zoneColors ) const noexcept;
+
+	/// The same as map() for an image with 3 bytes per pixel in the order red, green, blue.
+	/** The pixels can't be loaded in vectors without reading past the end of the image, so it maps them one by one. */
+	void mapRGB( const uint8_t * image, Color * zoneColors ) const noexcept;
+
+ private:
+
+	/// LEDs with consecutive indexes that are all in the grid.
+	struct Run
+	{
+		uint32_t firstLED;  ///< index within the zone
+		uint32_t ledCount;
+	};
+
+	uint32_t _width;
+	uint32_t _height;
+	size_t _stride;
+	uint32_t _zoneOffset;
+	uint32_t _zoneSize;
+	std::vector< Run > _runs;
+	std::vector< uint32_t > _pixels;  ///< the pixel of every LED of the runs, in the order of the runs
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_MATRIX_MAPPER_INCLUDED
@@ -0,0 +1,120 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: rendering of a light show into a file of ready-to-send messages
+//======================================================================================================================
+
+#ifndef OPENRGB_SHOW_COMPILER_INCLUDED
+#define OPENRGB_SHOW_COMPILER_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Writes a light show into a file of messages serialized exactly as they go over the network, for the ShowPlayer.
+/** A show that is played over and over again can be rendered and serialized only once. The file holds frames
+  * of UpdateLEDs messages together with the time of each frame, so playing it back is only a matter of sending
+  * the right bytes at the right time.
+  *
+  * The messages refer to the devices by their indexes, so the show can only be played on the same set of devices
+  * the frames were rendered for, ShowPlayer::isCompatibleWith() checks that.
+  *
+  * The frames are written to the file as they are added, so the show doesn't have to fit into the memory.
+  * The file is written under a temporary name and renamed by finish(), so an unfinished show never overwrites
+  * an existing one. */
+
+class ShowCompiler
+{
+
+ public:
+
+	ShowCompiler() noexcept {}
+
+	/// Deletes the unfinished file, if finish() wasn't called.
+	~ShowCompiler() noexcept;
+
+	ShowCompiler( const ShowCompiler & other ) = delete;
+	ShowCompiler & operator=( const ShowCompiler & other ) = delete;
+
+	/// Starts writing a new show, abandoning the previous unfinished one.
+	/** \returns false when the file can't be created */
+	bool open( const std::string & filePath ) noexcept;
+
+	bool isOpen() const noexcept  { return _file != nullptr; }
+
+	/// Starts a new frame that will be played at \p time since the start of the show, finishing the previous one.
+	/** \returns false when the time is earlier than the time of the previous frame or when the file can't be written */
+	bool beginFrame( std::chrono::nanoseconds time ) noexcept;
+
+	/// Adds new colors of all the LEDs of the device to the current frame.
+	/** The player may skip frames when it's late, so every frame should contain all the devices the show controls,
+	  * not only those that changed.
+	  * \returns false when there is no frame, when the number of colors doesn't match the number of LEDs
+	  *          or when it doesn't fit into the 16 bits the protocol has for it */
+	bool addDeviceColors( const Device & device, const Color * colors, size_t count ) noexcept;
+	bool addDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept
+	{
+		return addDeviceColors( device, colors.data(), colors.size() );
+	}
+
+	/// Finishes the last frame, writes the index of the frames and renames the file to its final name.
+	/** \param duration  length of the show, after which a looping player starts again from the first frame,
+	  *                  0 means the time of the last frame plus the gap between the last two frames
+	  * \returns false when the file can't be written */
+	bool finish( std::chrono::nanoseconds duration = std::chrono::nanoseconds( 0 ) ) noexcept;
+
+	/// Number of frames added so far.
+	size_t frameCount() const noexcept  { return _frames.size(); }
+
+ private:
+
+	struct DeviceEntry
+	{
+		uint32_t deviceIdx;
+		uint32_t ledCount;
+	};
+	struct FrameEntry
+	{
+		int64_t time;
+		uint64_t offset;
+		uint32_t size;
+		uint32_t messageCount;
+	};
+
+	bool flushFrame() noexcept;
+	void abandon() noexcept;
+
+	std::string _filePath;
+	std::string _tempPath;
+	FILE * _file = nullptr;
+	bool _failed = false;  ///< a write has failed, finish() will fail too
+
+	std::vector< uint8_t > _frameBuffer;  ///< messages of the current frame, written at once when it's finished
+	bool _inFrame = false;
+	uint64_t _fileOffset = 0;
+	std::vector< DeviceEntry > _devices;  ///< ordered by the device index
+	std::vector< FrameEntry > _frames;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SHOW_COMPILER_INCLUDED
@@ -0,0 +1,133 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: playback of a light show precompiled by the ShowCompiler
+//======================================================================================================================
+
+#ifndef OPENRGB_SHOW_PLAYER_INCLUDED
+#define OPENRGB_SHOW_PLAYER_INCLUDED
+
+
+#include "Client.hpp"  // RequestStatus
+#include "DeviceInfo.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+
+namespace orgb {
+
+
+class MappedFile;
+
+
+//======================================================================================================================
+/// Plays a light show file written by the ShowCompiler.
+/** The file is mapped into the memory and each frame is sent by a single system call straight from the mapped pages,
+  * so the playback doesn't render, serialize nor copy anything and takes almost no CPU time. The whole file is
+  * validated when it's opened, so the playback itself never needs to check anything.
+  *
+  * The frames are played on a background thread at their times, measured from start() by the steady clock.
+  * When sending a frame takes longer than the gap to the next one, the frames that are already late are skipped
+  * and the player continues with the newest one, so the show never falls behind the music.
+  *
+  * The messages bypass the delta encoding of the Client, so the Client forgets the colors it sent to the devices
+  * of the show. */
+
+class ShowPlayer
+{
+
+ public:
+
+	/// The \p client must stay alive while the player exists.
+	ShowPlayer( Client & client ) noexcept;
+
+	/// Stops the playback.
+	~ShowPlayer() noexcept;
+
+	ShowPlayer( const ShowPlayer & other ) = delete;
+	ShowPlayer & operator=( const ShowPlayer & other ) = delete;
+
+	/// Maps the show file into the memory and checks that it's valid, stops the playback of the previous show.
+	/** \returns false when the file can't be opened or it isn't a valid show file */
+	bool open( const std::string & filePath ) noexcept;
+
+	/// Stops the playback and releases the file.
+	void close() noexcept;
+
+	bool isOpen() const noexcept;
+
+	size_t frameCount() const noexcept      { return _frameCount; }
+	std::chrono::nanoseconds duration() const noexcept  { return std::chrono::nanoseconds( _duration ); }
+
+	/// Time of the frame since the start of the show.
+	std::chrono::nanoseconds frameTime( size_t frameIdx ) const noexcept;
+
+	/// Checks that the devices the show was compiled for exist in the \p devices with the same numbers of LEDs.
+	bool isCompatibleWith( const DeviceList & devices ) const noexcept;
+
+	/// Sends a single frame right now, for example to show the first frame before the music starts.
+	RequestStatus sendFrame( size_t frameIdx ) noexcept;
+
+	/// Starts playing the show on a background thread from the first frame.
+	/** \param loop  start again from the first frame after the duration of the show
+	  * \returns false when there is no show opened or the thread can't be started */
+	bool start( bool loop = false ) noexcept;
+
+	/// Stops the playback and waits until the background thread finishes.
+	void stop() noexcept;
+
+	/// Tells whether the show is still being played, a show without looping stops by itself after the last frame.
+	bool isPlaying() const noexcept  { return _isPlaying; }
+
+	/// Number of frames sent since the last start().
+	uint64_t playedFrames() const noexcept   { return _playedFrames; }
+	/// Number of frames skipped since the last start() because their time had already passed.
+	uint64_t skippedFrames() const noexcept  { return _skippedFrames; }
+	/// Result of sending the last frame, the playback continues even when it fails.
+	RequestStatus lastFrameStatus() const noexcept  { return _lastFrameStatus; }
+
+ private:
+
+	void playLoop( bool loop ) noexcept;
+
+	/// Index of the last frame whose time is not later than \p time, SIZE_MAX when there is none.
+	size_t lastFrameDueAt( int64_t time ) const noexcept;
+
+	Client & _client;
+
+	std::unique_ptr< MappedFile > _file;
+	size_t _deviceCount;
+	size_t _frameCount;
+	int64_t _duration;
+	const uint8_t * _deviceTable;
+	const uint8_t * _frameIndex;
+
+	std::thread _thread;
+	std::mutex _threadMutex;
+	std::condition_variable _stopCond;
+	bool _stopRequested;
+
+	std::atomic< bool > _isPlaying;
+	std::atomic< uint64_t > _playedFrames;
+	std::atomic< uint64_t > _skippedFrames;
+	std::atomic< RequestStatus > _lastFrameStatus;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SHOW_PLAYER_INCLUDED
@@ -0,0 +1,206 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: LEDs of all devices placed in one physical space, rendered by effects of the position
+//======================================================================================================================
+
+#ifndef OPENRGB_SPATIAL_CANVAS_INCLUDED
+#define OPENRGB_SPATIAL_CANVAS_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+#include "Color.hpp"
+#include "Effects.hpp"  // FrameTime
+#include "SpatialLayout.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+namespace orgb {
+
+
+class ThreadPool;
+class DeviceFrame;
+
+
+//======================================================================================================================
+/// Effect that computes the color of an LED from its position in the physical space.
+/** Unlike Effect, it doesn't keep any state between the frames, which allows the canvas to render different LEDs
+  * from several threads at once. */
+
+class SpatialEffect
+{
+
+ public:
+
+	virtual ~SpatialEffect() = default;
+
+	/// Renders the colors of \p count LEDs whose coordinates are in \p x, \p y and \p z.
+	/** It's called for consecutive ranges of the LEDs of the canvas, possibly from several threads at once,
+	  * so it must not modify anything but the \p colors. */
+	virtual void render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+	                     const FrameTime & time ) const noexcept = 0;
+
+};
+
+/// Rainbow moving through the space as a plane wave.
+class SpatialWaveEffect : public SpatialEffect
+{
+
+ public:
+
+	/// \param direction  the direction the wave moves in, doesn't need to be normalized
+	/// \param wavelength  distance between two places with the same color
+	/// \param cyclesPerSecond  how many times per second every LED goes through all the colors
+	SpatialWaveEffect( Position direction = Position( 1, 0, 0 ), float wavelength = 30.0f, float cyclesPerSecond = 0.25f,
+	                   uint8_t saturation = 255, uint8_t value = 255 ) noexcept;
+
+	void render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+	             const FrameTime & time ) const noexcept override;
+
+ private:
+
+	Position _waveVector;  ///< direction divided by the wavelength, so that dot product gives the number of cycles
+	float _cyclesPerSecond;
+	uint8_t _saturation;
+	uint8_t _value;
+
+};
+
+/// Rings of a color spreading from a center point, like ripples on water.
+class RippleEffect : public SpatialEffect
+{
+
+ public:
+
+	/// \param wavelength  distance between two rings
+	/// \param speed  distance the rings travel in a second
+	RippleEffect( Position center, Color color, float wavelength = 10.0f, float speed = 10.0f ) noexcept;
+
+	void render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+	             const FrameTime & time ) const noexcept override;
+
+ private:
+
+	Position _center;
+	Color _color;
+	float _wavelength;
+	float _speed;
+
+};
+
+/// Classic plasma, slowly flowing blobs of colors made of several interfering sine waves.
+/** It's one of the most expensive effects per LED, a good candidate for rendering by a ThreadPool. */
+class PlasmaEffect : public SpatialEffect
+{
+
+ public:
+
+	/// \param scale  approximate size of the blobs
+	/// \param speed  how fast the blobs flow, 1 is a calm default
+	PlasmaEffect( float scale = 16.0f, float speed = 1.0f, uint8_t saturation = 255, uint8_t value = 255 ) noexcept;
+
+	void render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+	             const FrameTime & time ) const noexcept override;
+
+ private:
+
+	float _frequency;  ///< radians per unit of distance
+	float _speed;
+	uint8_t _saturation;
+	uint8_t _value;
+
+};
+
+
+//======================================================================================================================
+/// LEDs of all the devices of a list placed in one physical space.
+/** The positions are stored as separate arrays of the x, y and z coordinates and the colors in one array,
+  * so an effect goes over all the LEDs in tight loops that the compiler can vectorize, and a large canvas can be
+  * split over several threads. The LEDs of each device are consecutive, in the order of Device::leds, so copying
+  * the colors of a device to its own buffer is a single memcpy.
+  *
+  * The canvas keeps pointers to the devices, so don't destroy the DeviceList while using it. When the device list
+  * is updated, build the canvas again. */
+
+class SpatialCanvas
+{
+
+ public:
+
+	SpatialCanvas() noexcept {}
+
+	/// Places all the LEDs of all the devices according to the \p layout, the colors are set to black.
+	void build( const DeviceList & devices, const SpatialLayout & layout = SpatialLayout() ) noexcept;
+
+	void clear() noexcept;
+
+	/// Number of LEDs of all the devices together.
+	size_t size() const noexcept         { return _colors.size(); }
+
+	const float * x() const noexcept     { return _x.data(); }
+	const float * y() const noexcept     { return _y.data(); }
+	const float * z() const noexcept     { return _z.data(); }
+
+	/// The smallest coordinates of all the LEDs, useful for scaling the effects to the size of the installation.
+	Position minCorner() const noexcept  { return _minCorner; }
+	/// The largest coordinates of all the LEDs.
+	Position maxCorner() const noexcept  { return _maxCorner; }
+
+	/// Colors of all the LEDs, the same order as the coordinates.
+	const Color * colors() const noexcept  { return _colors.data(); }
+	Color * colors() noexcept              { return _colors.data(); }
+
+	/// Index of the first LED of the device in the canvas.
+	/** \returns SIZE_MAX when the device isn't in the canvas */
+	size_t offsetOf( const Device & device ) const noexcept;
+
+	/// Colors of the LEDs of the device, in the order of Device::leds.
+	/** \returns nullptr when the device isn't in the canvas */
+	const Color * colorsOf( const Device & device ) const noexcept;
+
+	/// Renders the \p effect into the colors of all the LEDs.
+	/** When a \p pool is given, the LEDs are split into chunks rendered by all its threads.
+	  * The chunks are always the same, so the result doesn't depend on the number of threads. */
+	void render( const SpatialEffect & effect, const FrameTime & time, ThreadPool * pool = nullptr ) noexcept;
+
+	/// Copies the colors of the device of the \p frame into it and marks the whole frame as dirty.
+	/** \returns false when the device isn't in the canvas */
+	bool copyTo( DeviceFrame & frame ) const noexcept;
+
+	/// Copies the colors of the device into \p deviceColors, ready for Client::updateDeviceColors().
+	/** \returns false when the device isn't in the canvas */
+	bool copyTo( const Device & device, std::vector< Color > & deviceColors ) const noexcept;
+
+ private:
+
+	struct DeviceRange
+	{
+		const Device * device;
+		size_t firstLED;
+		size_t ledCount;
+	};
+
+	const DeviceRange * rangeOf( const Device & device ) const noexcept;
+
+	std::vector< DeviceRange > _devices;  ///< indexed by the device index
+	std::vector< float > _x;
+	std::vector< float > _y;
+	std::vector< float > _z;
+	std::vector< Color > _colors;
+	Position _minCorner;
+	Position _maxCorner;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SPATIAL_CANVAS_INCLUDED
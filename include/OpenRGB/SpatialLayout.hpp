@@ -0,0 +1,140 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: positions of devices, zones and LEDs in physical space
+//======================================================================================================================
+
+#ifndef OPENRGB_SPATIAL_LAYOUT_INCLUDED
+#define OPENRGB_SPATIAL_LAYOUT_INCLUDED
+
+
+#include "DeviceInfo.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+/// Point in the physical space.
+/** The units are up to you, the automatic layout uses the distance between neighbouring LEDs as 1.
+  * x goes to the right, y down and z towards the viewer, so that the rows of matrix zones go in the direction of y. */
+struct Position
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	Position() noexcept {}
+	Position( float x, float y, float z ) noexcept : x( x ), y( y ), z( z ) {}
+};
+
+
+//======================================================================================================================
+/// Describes where the devices, zones and LEDs are placed in the physical space.
+/** Everything that isn't placed explicitly is laid out automatically:
+  *  - Devices are stacked under each other, separated by a gap of 2.
+  *  - Zones of a device are stacked under each other, separated by a gap of 1.
+  *  - LEDs of a linear zone form a row, LEDs of a single zone share one point and LEDs of a matrix zone sit
+  *    in the cells of Zone::matrix_values.
+  *
+  * Placing a device moves its whole automatic layout, placing a zone moves the automatic layout of the zone
+  * and placing an LED sets its exact position. Zones and LEDs are placed in the absolute coordinates,
+  * not relative to their device.
+  *
+  * The layout can be loaded from a text file with one placement per line:
+  * \code
+  *   # comment
+  *   device <device> <x> <y> <z>
+  *   zone <device> <zone> <x> <y> <z>
+  *   led <device> <led index> <x> <y> <z>
+  * \endcode
+  * where a device is either a "quoted name" or #index in the device list and a zone is either a "quoted name"
+  * or #index in the device's zones. The LED index goes into Device::leds. */
+
+class SpatialLayout
+{
+
+ public:
+
+	/// Identifies a device or a zone either by its name or by its index.
+	struct Key
+	{
+		std::string name;             ///< used when not empty
+		uint32_t idx = UINT32_MAX;    ///< used when the name is empty
+
+		Key() {}
+		Key( std::string name ) : name( std::move( name ) ) {}
+		Key( const char * name ) : name( name ) {}
+		Key( uint32_t idx ) : idx( idx ) {}
+	};
+
+	void placeDevice( Key device, Position origin );
+	void placeZone( Key device, Key zone, Position origin );
+	void placeLED( Key device, uint32_t ledIdx, Position position );
+
+	/// Removes all the placements, everything will be laid out automatically.
+	void clear() noexcept;
+
+	bool isEmpty() const noexcept  { return _devices.empty() && _zones.empty() && _leds.empty(); }
+
+	/// Adds the placements from a text in the format described above.
+	/** \returns false when there is a syntax error, errorLine() then tells where, the layout is left unchanged. */
+	bool parse( const char * text, size_t length ) noexcept;
+	bool parse( const std::string & text ) noexcept  { return parse( text.data(), text.size() ); }
+
+	/// Adds the placements from a file in the format described above.
+	/** \returns false when the file can't be read or there is a syntax error, the layout is left unchanged. */
+	bool loadFromFile( const std::string & filePath ) noexcept;
+
+	/// Number of the line where the last parse() or loadFromFile() failed, 0 when the file couldn't be read.
+	size_t errorLine() const noexcept  { return _errorLine; }
+
+	/// Computes the positions of all LEDs of the device, in the order of Device::leds.
+	/** \param autoOrigin  where to put the device when it isn't placed explicitly
+	  * \param positions  array of Device::leds.size() positions
+	  * \returns the height of the automatic layout of the device, the next device can be put that much lower */
+	float computePositions( const Device & device, Position autoOrigin, Position * positions ) const noexcept;
+
+ private:
+
+	struct DevicePlacement
+	{
+		Key device;
+		Position origin;
+	};
+	struct ZonePlacement
+	{
+		Key device;
+		Key zone;
+		Position origin;
+	};
+	struct LEDPlacement
+	{
+		Key device;
+		uint32_t ledIdx;
+		Position position;
+	};
+
+	std::vector< DevicePlacement > _devices;
+	std::vector< ZonePlacement > _zones;
+	std::vector< LEDPlacement > _leds;
+	size_t _errorLine = 0;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SPATIAL_LAYOUT_INCLUDED
@@ -0,0 +1,105 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of threads for splitting the rendering of a frame over the CPU cores
+//======================================================================================================================
+
+#ifndef OPENRGB_THREAD_POOL_INCLUDED
+#define OPENRGB_THREAD_POOL_INCLUDED
+
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Threads that split a range of work into chunks and process them in parallel.
+/** The threads are started once and then wait for the work, so a frame doesn't pay for creating them.
+  * The thread that calls parallelFor() processes the chunks too, so a pool of 1 thread has no workers at all
+  * and runs everything in the calling thread.
+  *
+  * Each thread gets an equal share of consecutive chunks and processes them from the front. A thread that runs out
+  * of its own chunks steals from the back of the others, so the threads stay busy even when some chunks take much
+  * longer than others or when a thread wakes up late, while they mostly don't touch each other's memory.
+  *
+  * The chunks are always split the same way, no matter which thread ends up processing them, so as long as each
+  * chunk writes only its own part of the output, the result is the same for any number of threads. */
+
+class ThreadPool
+{
+
+ public:
+
+	/// Starts the worker threads.
+	/** \param threadCount  number of threads including the one that calls parallelFor(), 0 means one per CPU core */
+	explicit ThreadPool( unsigned int threadCount = 0 ) noexcept;
+
+	/// Stops and joins the worker threads.
+	~ThreadPool() noexcept;
+
+	ThreadPool( const ThreadPool & other ) = delete;
+	ThreadPool & operator=( const ThreadPool & other ) = delete;
+
+	/// Number of threads that process the chunks, including the one that calls parallelFor().
+	unsigned int threadCount() const noexcept  { return unsigned( _workers.size() ) + 1; }
+
+	/// Calls \p func( begin, end ) for consecutive chunks of the range [0, count) with at most \p grainSize items each.
+	/** Returns when all the chunks are processed. The chunks run in parallel, so \p func must be safe to call
+	  * from several threads at once and must not throw. When several threads call this at once, they take turns. */
+	void parallelFor( size_t count, size_t grainSize, const std::function< void ( size_t begin, size_t end ) > & func ) noexcept;
+
+ private:
+
+	/// Chunks of the current work that belong to one thread, the indexes of the first and the past-the-end chunk
+	/// packed into one atomic, so that the owner taking from the front and thieves taking from the back can't
+	/// take the same chunk. Each one takes a whole cache line, so that the threads don't slow each other down.
+	struct alignas(64) ChunkQueue
+	{
+		std::atomic< uint64_t > range;
+	};
+
+	void workerLoop( unsigned int queueIdx ) noexcept;
+	void processChunks( unsigned int queueIdx ) noexcept;
+	bool takeOwnChunk( unsigned int queueIdx, size_t & chunkIdx ) noexcept;
+	bool stealChunk( unsigned int queueIdx, size_t & chunkIdx ) noexcept;
+	void processChunk( size_t chunkIdx ) noexcept;
+
+	std::vector< std::thread > _workers;
+
+	std::mutex _callMutex;  ///< one parallelFor() at a time
+
+	std::mutex _mutex;  ///< guards the description of the current work and the counters below
+	std::condition_variable _workAvailable;
+	std::condition_variable _workersIdle;
+	bool _stopRequested;
+	uint64_t _generation;     ///< incremented for every parallelFor(), tells the workers there is new work
+	unsigned int _busyWorkers;  ///< workers that may still touch the current work
+
+	// the current work, changed only while no worker is busy
+	const std::function< void ( size_t, size_t ) > * _func;
+	size_t _count;
+	size_t _grainSize;
+	std::unique_ptr< uint8_t [] > _queueStorage;  ///< over-allocated, because new in C++11 ignores the alignment
+	ChunkQueue * _queues;  ///< one for each worker and the last one for the calling thread, placed into _queueStorage
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_THREAD_POOL_INCLUDED
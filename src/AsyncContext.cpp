@@ -0,0 +1,246 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: background receiving of messages in the asynchronous mode of the client
+//======================================================================================================================
+
+#include "AsyncContext.hpp"
+
+#include "StatsRecorder.hpp"
+
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+#include "ClientSocket.hpp"
+#include "ContainerUtils.hpp"
+using own::make_span;
+
+#include <array>
+using std::array;
+#include <vector>
+using std::vector;
+#include <chrono>
+using std::chrono::milliseconds;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+AsyncContext::AsyncContext( ClientSocket & socket, StatsRecorder & stats, std::function< void () > onDeviceListUpdated,
+                            bool isDeviceListOutOfDate ) noexcept
+:
+	_socket( socket ),
+	_stats( stats ),
+	_onDeviceListUpdated( move( onDeviceListUpdated ) ),
+	_stopRequested( false ),
+	_isDeviceListOutOfDate( isDeviceListOutOfDate ),
+	_connectionStatus( RequestStatus::Success ),
+	_callbackPending( false ),
+	_callbackStopRequested( false )
+{}
+
+AsyncContext::~AsyncContext() noexcept
+{
+	stop();
+}
+
+bool AsyncContext::start() noexcept
+{
+	try {
+		if (_onDeviceListUpdated)
+		{
+			_callbackThread = std::thread( &AsyncContext::callbackLoop, this );
+		}
+		_thread = std::thread( &AsyncContext::receiveLoop, this );
+		return true;
+	} catch (const std::system_error &) {
+		stop();  // the callback thread might have already started
+		return false;
+	}
+}
+
+void AsyncContext::addReply( const Header & header, vector< uint8_t > && body )
+{
+	ReceivedMessage message;
+	message.header = header;
+	message.body = move( body );
+	_replies.push_back( move( message ) );
+}
+
+void AsyncContext::stop() noexcept
+{
+	_stopRequested = true;
+	_socket.interruptWait();
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+
+	// the receiving thread has ended, so no new notification can come now
+	{
+		std::unique_lock< std::mutex > lock( _callbackMutex );
+		_callbackStopRequested = true;
+	}
+	_callbackCond.notify_one();
+	if (_callbackThread.joinable())
+	{
+		_callbackThread.join();
+	}
+}
+
+RequestStatus AsyncContext::awaitReply( Header & header, vector< uint8_t > & body, milliseconds timeout ) noexcept
+{
+	std::unique_lock< std::mutex > lock( _repliesMutex );
+
+	auto replyOrEnd = [ this ]() { return !_replies.empty() || _connectionStatus != RequestStatus::Success; };
+	if (timeout.count() > 0)
+	{
+		if (!_repliesCond.wait_for( lock, timeout, replyOrEnd ))
+		{
+			return RequestStatus::NoReply;
+		}
+	}
+	else
+	{
+		_repliesCond.wait( lock, replyOrEnd );
+	}
+
+	// even when the connection has already ended, deliver the replies that have arrived before that
+	if (_replies.empty())
+	{
+		return _connectionStatus;
+	}
+
+	header = _replies.front().header;
+	body.swap( _replies.front().body );
+	// give the caller's old buffer to the receiving thread, so that it doesn't need to allocate a new one
+	if (_replies.front().body.capacity() > 0)
+	{
+		_spareBuffers.push_back( move( _replies.front().body ) );
+	}
+	_replies.pop_front();
+	return RequestStatus::Success;
+}
+
+void AsyncContext::receiveLoop() noexcept
+{
+	while (!_stopRequested)
+	{
+		// wait for the next message without a timeout, stop() wakes us up
+		SocketError waitStatus = _socket.waitForData();
+		if (waitStatus == SocketError::Interrupted)
+		{
+			continue;
+		}
+		else if (waitStatus != SocketError::Success)
+		{
+			finish( RequestStatus::ReceiveError );
+			return;
+		}
+
+		// receive header into buffer
+		array< uint8_t, Header::size() > headerBuffer; size_t received;
+		SocketError headerStatus = _socket.receive( make_span( headerBuffer ), received );
+		if (headerStatus == SocketError::ConnectionClosed)
+		{
+			finish( RequestStatus::ConnectionClosed );
+			return;
+		}
+		else if (headerStatus != SocketError::Success)
+		{
+			// Even a timeout is fatal here, because a part of the header might have been taken out of the socket.
+			finish( RequestStatus::ReceiveError );
+			return;
+		}
+
+		// parse and validate the header
+		ReceivedMessage message;
+		BinaryInputStream stream( make_span( headerBuffer ) );
+		if (!message.header.deserialize( stream ))
+		{
+			// We can't tell where the next message starts, so there is no way to continue.
+			finish( RequestStatus::InvalidReply );
+			return;
+		}
+
+		// receive the message body
+		if (message.header.message_size > 0)
+		{
+			{
+				std::unique_lock< std::mutex > lock( _repliesMutex );
+				if (!_spareBuffers.empty())
+				{
+					message.body = move( _spareBuffers.back() );
+					_spareBuffers.pop_back();
+				}
+			}
+			SocketError bodyStatus = _socket.receive( message.body, message.header.message_size );
+			if (bodyStatus != SocketError::Success)
+			{
+				// Even a timeout is fatal here, because a part of the message might have been lost.
+				finish( bodyStatus == SocketError::ConnectionClosed ? RequestStatus::ConnectionClosed : RequestStatus::ReceiveError );
+				return;
+			}
+		}
+
+		if (message.header.message_type == MessageType::DEVICE_LIST_UPDATED)
+		{
+			_stats.messageReceived( MessageType::DEVICE_LIST_UPDATED, Header::size() + message.header.message_size );
+			_isDeviceListOutOfDate = true;
+			if (_onDeviceListUpdated)
+			{
+				// Calling it here would deadlock any request made from the callback, because only this thread
+				// can deliver the reply, so the callback thread calls it instead.
+				{
+					std::unique_lock< std::mutex > lock( _callbackMutex );
+					_callbackPending = true;
+				}
+				_callbackCond.notify_one();
+			}
+		}
+		else
+		{
+			{
+				std::unique_lock< std::mutex > lock( _repliesMutex );
+				_replies.push_back( move( message ) );
+			}
+			_repliesCond.notify_one();
+		}
+	}
+}
+
+void AsyncContext::callbackLoop() noexcept
+{
+	std::unique_lock< std::mutex > lock( _callbackMutex );
+	while (true)
+	{
+		_callbackCond.wait( lock, [ this ]() { return _callbackPending || _callbackStopRequested; } );
+		if (_callbackStopRequested)
+		{
+			return;
+		}
+		_callbackPending = false;
+
+		lock.unlock();
+		_onDeviceListUpdated();
+		lock.lock();
+	}
+}
+
+void AsyncContext::finish( RequestStatus reason ) noexcept
+{
+	{
+		std::unique_lock< std::mutex > lock( _repliesMutex );
+		_connectionStatus = reason;
+	}
+	// wake up everyone who is waiting for a reply, none is going to come anymore
+	_repliesCond.notify_all();
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
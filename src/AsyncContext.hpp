@@ -0,0 +1,124 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: background receiving of messages in the asynchronous mode of the client
+//======================================================================================================================
+
+#ifndef OPENRGB_ASYNC_CONTEXT_INCLUDED
+#define OPENRGB_ASYNC_CONTEXT_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ProtocolMessages.hpp"  // Header
+#include "OpenRGB/Client.hpp"  // RequestStatus
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+
+
+namespace orgb {
+
+
+class ClientSocket;
+class StatsRecorder;
+
+
+//======================================================================================================================
+/// Everything the client needs while it's running in the asynchronous mode.
+/** A background thread owns the receiving side of the socket. It sorts the incoming messages by their type,
+  * hands the replies over to the threads that wait for them and notes every DeviceListUpdated message.
+  * The callback about the DeviceListUpdated message is called from a second thread, because the receiving thread
+  * must stay free to deliver the replies to the requests the callback is likely to make. */
+
+class AsyncContext
+{
+
+ public:
+
+	AsyncContext( ClientSocket & socket, StatsRecorder & stats, std::function< void () > onDeviceListUpdated,
+	              bool isDeviceListOutOfDate ) noexcept;
+	~AsyncContext() noexcept;
+
+	/// Starts the receiving thread and the thread that calls the callback, if there is any.
+	bool start() noexcept;
+
+	/// Adds a reply that has been received before the thread started. Call only before start().
+	void addReply( const Header & header, std::vector< uint8_t > && body );
+
+	/// Stops the receiving thread and the callback thread and waits for them to finish.
+	/** The receiving thread is woken up right away. A callback that is running is finished first,
+	  * so this must not be called from the callback. */
+	void stop() noexcept;
+
+	/// Waits until the background thread receives a reply and moves it into the output parameters.
+	/** A zero timeout means no timeout. The previous content of \p body is taken over and reused
+	  * for receiving one of the next messages. */
+	RequestStatus awaitReply( Header & header, std::vector< uint8_t > & body, std::chrono::milliseconds timeout ) noexcept;
+
+	bool isDeviceListOutOfDate() const noexcept            { return _isDeviceListOutOfDate; }
+	void setDeviceListOutOfDate( bool outOfDate ) noexcept  { _isDeviceListOutOfDate = outOfDate; }
+
+	/// Anything else than Success means the receiving thread has ended because of this reason.
+	RequestStatus connectionStatus() const noexcept  { return _connectionStatus; }
+
+	/// Prevents bytes of messages sent from different threads from mixing together.
+	/** It's recursive, so that the client can hold it while preparing data for the message and still call sendMessage. */
+	std::recursive_mutex & sendMutex() noexcept  { return _sendMutex; }
+
+	/// Makes sure that only one thread at a time waits for a reply, so that the replies get to the correct requests.
+	std::mutex & requestMutex() noexcept  { return _requestMutex; }
+
+ private:
+
+	void receiveLoop() noexcept;
+	void callbackLoop() noexcept;
+	void finish( RequestStatus reason ) noexcept;
+
+	struct ReceivedMessage
+	{
+		Header header;
+		std::vector< uint8_t > body;
+	};
+
+	ClientSocket & _socket;
+	StatsRecorder & _stats;
+	std::function< void () > _onDeviceListUpdated;
+
+	std::thread _thread;
+	std::atomic< bool > _stopRequested;
+	std::atomic< bool > _isDeviceListOutOfDate;
+	std::atomic< RequestStatus > _connectionStatus;
+
+	std::mutex _repliesMutex;
+	std::condition_variable _repliesCond;
+	std::deque< ReceivedMessage > _replies;
+	std::vector< std::vector< uint8_t > > _spareBuffers;  ///< buffers returned by awaitReply, ready to receive again
+
+	std::thread _callbackThread;
+	std::mutex _callbackMutex;
+	std::condition_variable _callbackCond;
+	bool _callbackPending;  ///< several notifications that arrive while the callback is running result in one call
+	bool _callbackStopRequested;
+
+	std::recursive_mutex _sendMutex;
+	std::mutex _requestMutex;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_ASYNC_CONTEXT_INCLUDED
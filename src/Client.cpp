@@ -10,13 +10,15 @@
 #include "Essential.hpp"
 
 #include "ProtocolMessages.hpp"
+#include "AsyncContext.hpp"
+#include "StatsRecorder.hpp"
+#include "ContentHash.hpp"
 #include "OpenRGB/Exceptions.hpp"
+#include "OpenRGB/DeviceFrame.hpp"
 #include "BinaryStream.hpp"
 using own::BinaryOutputStream;
 using own::BinaryInputStream;
-#include "Socket.hpp"
-using own::TcpSocket;
-using own::SocketError;
+#include "ClientSocket.hpp"
 #include "SystemErrorInfo.hpp"
 using own::getLastError;
 using own::getErrorString;
@@ -31,10 +33,15 @@ using own::make_span;
 using std::string;
 #include <vector>
 using std::vector;
+#include <algorithm>
 #include <array>
 using std::array;
+#include <deque>
+using std::deque;
 #include <chrono>
 using std::chrono::milliseconds;
+#include <mutex>
+#include <future>
 
 
 namespace orgb {
@@ -123,12 +130,34 @@ const char * enumString( UpdateStatus status ) noexcept
 //======================================================================================================================
 //  Client: main API
 
+/// In the asynchronous mode the requests can come from multiple threads and their replies must not get mixed.
+static std::unique_lock< std::mutex > lockRequests( AsyncContext * asyncContext )
+{
+	if (asyncContext)
+		return std::unique_lock< std::mutex >( asyncContext->requestMutex() );
+	else
+		return std::unique_lock< std::mutex >();
+}
+
+/// In the asynchronous mode the messages can be sent from multiple threads and the shared buffers must be protected.
+static std::unique_lock< std::recursive_mutex > lockSending( AsyncContext * asyncContext )
+{
+	if (asyncContext)
+		return std::unique_lock< std::recursive_mutex >( asyncContext->sendMutex() );
+	else
+		return std::unique_lock< std::recursive_mutex >();
+}
+
 Client::Client( const std::string & clientName ) noexcept
 :
 	_clientName( clientName ),
-	_socket( new TcpSocket ),
+	_socket( new ClientSocket ),
 	_negotiatedProtocolVersion( 0 ),
-	_isDeviceListOutOfDate( true )
+	_timeout( 0 ),
+	_isDeviceListOutOfDate( true ),
+	_deviceListPipelineDepth( 1 ),
+	_lazyDeviceParsing( false ),
+	_stats( new StatsRecorder )
 {}
 
 Client::~Client() noexcept {}
@@ -138,6 +167,11 @@ bool Client::isConnected() const noexcept
 	return _socket->isConnected();
 }
 
+void Client::resetStats() noexcept
+{
+	_stats->reset();
+}
+
 ConnectStatus Client::_connect( const std::string & host, uint16_t port )
 {
 	SocketError connectRes = _socket->connect( host, port );
@@ -153,8 +187,13 @@ ConnectStatus Client::_connect( const std::string & host, uint16_t port )
 		}
 	}
 
+	_pendingMessages.clear();
+	// replies to the requests sent over the previous connection are never going to come
+	_stats->repliesAbandoned();
+
 	// rather set some default timeout for recv operations, user can always override this
-	_socket->setTimeout( milliseconds( 500 ) );
+	_timeout = milliseconds( 500 );
+	_socket->setTimeout( _timeout );
 
 	bool sendVersionRes = sendMessage< RequestProtocolVersion >( implementedProtocolVersion );
 	if (!sendVersionRes)
@@ -201,11 +240,17 @@ ConnectStatus Client::_connect( const std::string & host, uint16_t port )
 	// }
 	_isDeviceListOutOfDate = true;
 
+	// whatever we sent before belongs to another connection, maybe even to another server
+	forgetSentColors();
+
 	return ConnectStatus::Success;
 }
 
 bool Client::_disconnect() noexcept
 {
+	// the background thread must not be receiving from a socket that's being closed
+	_stopAsyncMode();
+
 	SocketError status = _socket->disconnect();
 	if (status == SocketError::Success)
 		return true;
@@ -227,7 +272,23 @@ bool Client::_setTimeout( std::chrono::milliseconds timeout ) noexcept
 		return false;
 	}
 
-	return _socket->setTimeout( timeout );
+	if (!_socket->setTimeout( timeout ))
+	{
+		return false;
+	}
+
+	_timeout = timeout;
+	return true;
+}
+
+void Client::setDeviceListPipelineDepth( uint32_t maxRequestsInFlight ) noexcept
+{
+	_deviceListPipelineDepth = maxRequestsInFlight;
+}
+
+void Client::setLazyDeviceParsing( bool enable ) noexcept
+{
+	_lazyDeviceParsing = enable;
 }
 
 DeviceListResult Client::_requestDeviceList()
@@ -237,50 +298,48 @@ DeviceListResult Client::_requestDeviceList()
 		return { RequestStatus::NotConnected, {} };
 	}
 
+	// the devices might have been reordered, so the remembered colors may no longer belong to the same indexes
+	forgetSentColors();
+
 	DeviceListResult result;
+	result.status = _updateDeviceList( result.devices ).status;
+	return result;
+}
 
-	do
-	{
-		result.devices.clear();
-		_isDeviceListOutOfDate = false;
+DeviceListUpdateResult Client::_updateDeviceList( DeviceList & devices )
+{
+	DeviceListUpdateResult result;
 
-		bool sent = sendMessage< RequestControllerCount >();
-		if (!sent)
-		{
-			result.status = RequestStatus::SendRequestFailed;
-			return result;
-		}
+	if (!_socket->isConnected())
+	{
+		result.status = RequestStatus::NotConnected;
+		return result;
+	}
 
-		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
-		if (deviceCountResult.status != RequestStatus::Success)
-		{
-			result.status = deviceCountResult.status;
-			return result;
-		}
+	auto requestLock = lockRequests( _asyncContext.get() );
 
-		for (uint32_t deviceIdx = 0; deviceIdx < deviceCountResult.message.count; ++deviceIdx)
-		{
-			sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
-			if (!sent)
-			{
-				result.status = RequestStatus::SendRequestFailed;
-				return result;
-			}
+	size_t originalSize = devices.size();
+	vector< bool > replacedEntries( originalSize, false );
 
-			auto deviceDataResult = awaitMessage< ReplyControllerData >();
-			if (deviceDataResult.status != RequestStatus::Success)
-			{
-				result.status = deviceDataResult.status;
-				return result;
-			}
+	result.status = downloadDeviceList( devices, replacedEntries );
 
-			result.devices.append( move( deviceDataResult.message.device_desc ) );
-		}
+	// An entry may have been replaced several times when the list kept changing during the update,
+	// but the caller only cares about how the final list differs from the one it gave us.
+	size_t finalSize = devices.size();
+	for (size_t deviceIdx = 0; deviceIdx < std::min( originalSize, finalSize ); ++deviceIdx)
+	{
+		if (replacedEntries[ deviceIdx ])
+			result.diff.changed.push_back( uint32_t( deviceIdx ) );
+	}
+	for (size_t deviceIdx = finalSize; deviceIdx < originalSize; ++deviceIdx)
+	{
+		result.diff.removed.push_back( uint32_t( deviceIdx ) );
+	}
+	for (size_t deviceIdx = originalSize; deviceIdx < finalSize; ++deviceIdx)
+	{
+		result.diff.added.push_back( uint32_t( deviceIdx ) );
 	}
-	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to start again.
-	while (_isDeviceListOutOfDate);
 
-	result.status = RequestStatus::Success;
 	return result;
 }
 
@@ -291,6 +350,8 @@ DeviceCountResult Client::_requestDeviceCount()
 		return { RequestStatus::NotConnected, 0 };
 	}
 
+	auto requestLock = lockRequests( _asyncContext.get() );
+
 	DeviceCountResult result;
 
 	bool sent = sendMessage< RequestControllerCount >();
@@ -319,6 +380,8 @@ DeviceInfoResult Client::_requestDeviceInfo( uint32_t deviceIdx )
 		return { RequestStatus::NotConnected, nullptr };
 	}
 
+	auto requestLock = lockRequests( _asyncContext.get() );
+
 	DeviceInfoResult result;
 
 	bool sent = sendMessage< RequestControllerData >( deviceIdx, _negotiatedProtocolVersion );
@@ -328,20 +391,42 @@ DeviceInfoResult Client::_requestDeviceInfo( uint32_t deviceIdx )
 		return result;
 	}
 
-	auto deviceDataResult = awaitMessage< ReplyControllerData >();
-	if (deviceDataResult.status != RequestStatus::Success)
+	ReplyControllerData reply;
+	RequestStatus replyStatus = awaitRawMessage( ReplyControllerData::thisType, reply.header );
+	if (replyStatus != RequestStatus::Success)
 	{
-		result.status = deviceDataResult.status;
+		result.status = replyStatus;
+		return result;
+	}
+	if (!parseDeviceReply( reply ))
+	{
+		result.status = RequestStatus::InvalidReply;
 		return result;
 	}
 
-	result.device.reset( new Device( move( deviceDataResult.message.device_desc ) ) );
+	result.device = move( reply.device_desc );
 	result.status = RequestStatus::Success;
 	return result;
 }
 
 UpdateStatus Client::_checkForDeviceUpdates() noexcept
 {
+	if (_asyncContext)
+	{
+		// The background thread receives all the messages, we only need to look at what it has found.
+		switch (_asyncContext->connectionStatus())
+		{
+			case RequestStatus::Success:
+				return _asyncContext->isDeviceListOutOfDate() ? UpdateStatus::OutOfDate : UpdateStatus::UpToDate;
+			case RequestStatus::ConnectionClosed:
+				return UpdateStatus::ConnectionClosed;
+			case RequestStatus::InvalidReply:
+				return UpdateStatus::UnexpectedMessage;
+			default:
+				return UpdateStatus::OtherSystemError;
+		}
+	}
+
 	if (_isDeviceListOutOfDate)
 	{
 		// Last time we found DeviceListUpdated message in the socket, and user haven't requested the new list yet,
@@ -367,6 +452,9 @@ RequestStatus Client::_switchToCustomMode( const Device & device )
 		return RequestStatus::NotConnected;
 	}
 
+	// the device may display something else now
+	forgetSentColorsOf( device.idx );
+
 	if (!sendMessage< SetCustomMode >( device.idx ))
 	{
 		return RequestStatus::SendRequestFailed;
@@ -382,6 +470,8 @@ RequestStatus Client::_changeMode( const Device & device, const Mode & mode )
 		return RequestStatus::NotConnected;
 	}
 
+	forgetSentColorsOf( device.idx );
+
 	if (!sendMessage< UpdateMode >( device.idx, mode.idx, mode, _negotiatedProtocolVersion ))
 	{
 		return RequestStatus::SendRequestFailed;
@@ -412,12 +502,247 @@ RequestStatus Client::_setDeviceColor( const Device & device, Color color )
 		return RequestStatus::NotConnected;
 	}
 
-	std::vector< Color > allColorsInDevice( device.leds.size(), color );
-	if (!sendMessage< UpdateLEDs >( device.idx, allColorsInDevice ))
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	_colorBuffer.assign( device.leds.size(), color );
+	return _setDeviceColors( device, _colorBuffer.data(), _colorBuffer.size() );
+}
+
+RequestStatus Client::_setDeviceColors( const Device & device, const Color * colors, size_t count )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	if (!sendMessage< UpdateLEDs >( device.idx, span< const Color >( colors, count ) ))
+	{
+		forgetSentColorsOf( device.idx );
+		return RequestStatus::SendRequestFailed;
+	}
+
+	// remember what the device shows for the delta encoding of updateDeviceColors()
+	sentColorsOf( device.idx ).assign( colors, colors + count );
+
+	return RequestStatus::Success;
+}
+
+RequestStatus Client::_updateDeviceColors( const Device & device, const Color * colors, size_t count )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	vector< Color > & sentColors = sentColorsOf( device.idx );
+	if (sentColors.size() != count)
+	{
+		// we don't know what the device shows, so there is nothing to compare against
+		return _setDeviceColors( device, colors, count );
+	}
+
+	const UpdateLEDs fullUpdate( device.idx, span< const Color >( colors, count ) );
+	const size_t fullUpdateSize = fullUpdate.header.size() + fullUpdate.header.message_size;
+
+	// Serialize the changes straight away, the size of the send buffer then tells how much the delta costs.
+	// As soon as it gets bigger than the full update, the delta is abandoned.
+	_sendBuffer.clear();
+	_stats->batchCleared();
+
+	const UpdateSingleLED singleUpdate( device.idx, 0, Color::Black );
+	const size_t singleUpdateSize = singleUpdate.header.size() + singleUpdate.header.message_size;
+
+	// Each zone is decided separately, either its changed LEDs go one by one, or the whole zone in one message.
+	// The LEDs that don't belong to any zone (if there are any) can only go one by one.
+	auto encodeChanges = [&]( const Zone * zone, size_t begin, size_t end )
+	{
+		size_t changedCount = 0;
+		for (size_t ledIdx = begin; ledIdx < end; ++ledIdx)
+		{
+			if (colors[ ledIdx ] != sentColors[ ledIdx ])
+			{
+				changedCount++;
+			}
+		}
+		if (changedCount == 0)
+		{
+			return;
+		}
+
+		if (zone)
+		{
+			const UpdateZoneLEDs zoneUpdate( device.idx, zone->idx, span< const Color >( colors + begin, end - begin ) );
+			if (zoneUpdate.header.size() + zoneUpdate.header.message_size < changedCount * singleUpdateSize)
+			{
+				appendToSendBuffer( zoneUpdate );
+				return;
+			}
+		}
+		for (size_t ledIdx = begin; ledIdx < end && _sendBuffer.size() < fullUpdateSize; ++ledIdx)
+		{
+			if (colors[ ledIdx ] != sentColors[ ledIdx ])
+			{
+				appendToSendBuffer( UpdateSingleLED( device.idx, uint32_t( ledIdx ), colors[ ledIdx ] ) );
+			}
+		}
+	};
+
+	size_t zoneBegin = 0;
+	for (const Zone & zone : device.zones)
+	{
+		size_t zoneEnd = zoneBegin + zone.leds_count;
+		if (zoneEnd > count || _sendBuffer.size() >= fullUpdateSize)
+		{
+			break;
+		}
+		encodeChanges( &zone, zoneBegin, zoneEnd );
+		zoneBegin = zoneEnd;
+	}
+	if (zoneBegin < count && _sendBuffer.size() < fullUpdateSize)
+	{
+		encodeChanges( nullptr, zoneBegin, count );
+	}
+
+	if (_sendBuffer.size() >= fullUpdateSize)
+	{
+		return _setDeviceColors( device, colors, count );
+	}
+	if (_sendBuffer.empty())
+	{
+		return RequestStatus::Success;  // nothing has changed
+	}
+
+	if (!sendBuffer())
+	{
+		forgetSentColorsOf( device.idx );
+		return RequestStatus::SendRequestFailed;
+	}
+
+	sentColors.assign( colors, colors + count );
+
+	return RequestStatus::Success;
+}
+
+RequestStatus Client::_sendFrame( DeviceFrame & frame )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+	if (!frame.isDirty())
+	{
+		return RequestStatus::Success;
+	}
+
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	const Device & device = frame.device();
+	const Color * colors = frame.colors();
+	const size_t count = frame.size();
+
+	if (frame.isAllDirty())
+	{
+		RequestStatus status = _setDeviceColors( device, colors, count );
+		if (status == RequestStatus::Success)
+		{
+			frame.markClean();
+		}
+		return status;
+	}
+
+	const UpdateLEDs fullUpdate( device.idx, span< const Color >( colors, count ) );
+	const size_t fullUpdateSize = fullUpdate.header.size() + fullUpdate.header.message_size;
+
+	// the same as in _updateDeviceColors(), the zones are serialized until they get bigger than the full update
+	_sendBuffer.clear();
+	_stats->batchCleared();
+
+	for (const Zone & zone : device.zones)
+	{
+		if (_sendBuffer.size() >= fullUpdateSize)
+		{
+			break;
+		}
+		if (frame.isDirty( zone ))
+		{
+			appendToSendBuffer( UpdateZoneLEDs( device.idx, zone.idx, span< const Color >( colors + zone.startIdx, zone.leds_count ) ) );
+		}
+	}
+
+	if (_sendBuffer.size() >= fullUpdateSize)
+	{
+		RequestStatus status = _setDeviceColors( device, colors, count );
+		if (status == RequestStatus::Success)
+		{
+			frame.markClean();
+		}
+		return status;
+	}
+
+	if (!sendBuffer())
 	{
+		forgetSentColorsOf( device.idx );
 		return RequestStatus::SendRequestFailed;
 	}
 
+	// the other zones didn't change since the last send, so if we know what the device showed, we know what it shows now
+	vector< Color > & sentColors = sentColorsOf( device.idx );
+	if (sentColors.size() == count)
+	{
+		for (const Zone & zone : device.zones)
+		{
+			if (frame.isDirty( zone ))
+			{
+				std::copy( colors + zone.startIdx, colors + zone.startIdx + zone.leds_count, sentColors.begin() + zone.startIdx );
+			}
+		}
+	}
+
+	frame.markClean();
+	return RequestStatus::Success;
+}
+
+RequestStatus Client::_sendPrecompiledMessages( const uint8_t * data, size_t size )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	// The messages are only walked through for the statistics, they are sent right from where they are.
+	_stats->batchCleared();
+	size_t offset = 0;
+	while (offset + Header::size() <= size)
+	{
+		Header header;
+		BinaryInputStream stream( own::const_byte_span( data + offset, Header::size() ) );
+		if (!header.deserialize( stream ))
+		{
+			_stats->batchCleared();
+			return RequestStatus::UnexpectedError;
+		}
+		_stats->messageQueued( header.message_type, Header::size() + header.message_size );
+
+		// we don't know the colors without parsing the whole message, the delta encoding must start over
+		forgetSentColorsOf( header.device_idx );
+
+		offset += Header::size() + header.message_size;
+	}
+
+	StatsRecorder::Clock::time_point startTime = _stats->now();
+	if (_socket->send( span< const uint8_t >( data, size ) ) != SocketError::Success)
+	{
+		_stats->batchCleared();
+		return RequestStatus::SendRequestFailed;
+	}
+	_stats->batchSent( startTime );
+
 	return RequestStatus::Success;
 }
 
@@ -428,12 +753,38 @@ RequestStatus Client::_setZoneColor( const Zone & zone, Color color )
 		return RequestStatus::NotConnected;
 	}
 
-	std::vector< Color > allColorsInZone( zone.leds_count, color );
-	if (!sendMessage< UpdateZoneLEDs >( zone.parentIdx, zone.idx, allColorsInZone ))
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	_colorBuffer.assign( zone.leds_count, color );
+	return _setZoneColors( zone, _colorBuffer.data(), _colorBuffer.size() );
+}
+
+RequestStatus Client::_setZoneColors( const Zone & zone, const Color * colors, size_t count )
+{
+	if (!_socket->isConnected())
+	{
+		return RequestStatus::NotConnected;
+	}
+
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	if (!sendMessage< UpdateZoneLEDs >( zone.parentIdx, zone.idx, span< const Color >( colors, count ) ))
 	{
+		forgetSentColorsOf( zone.parentIdx );
 		return RequestStatus::SendRequestFailed;
 	}
 
+	// the zone occupies its part of the device's LEDs, the rest of them stays as it was
+	vector< Color > & sentColors = sentColorsOf( zone.parentIdx );
+	if (count == zone.leds_count && size_t( zone.startIdx ) + count <= sentColors.size())
+	{
+		std::copy( colors, colors + count, sentColors.begin() + zone.startIdx );
+	}
+	else
+	{
+		forgetSentColorsOf( zone.parentIdx );
+	}
+
 	return RequestStatus::Success;
 }
 
@@ -444,6 +795,8 @@ RequestStatus Client::_setZoneSize( const Zone & zone, uint32_t newSize )
 		return RequestStatus::NotConnected;
 	}
 
+	forgetSentColorsOf( zone.parentIdx );
+
 	if (!sendMessage< ResizeZone >( zone.parentIdx, zone.idx, newSize ))
 	{
 		return RequestStatus::SendRequestFailed;
@@ -459,11 +812,20 @@ RequestStatus Client::_setLEDColor( const LED & led, Color color )
 		return RequestStatus::NotConnected;
 	}
 
+	auto sendLock = lockSending( _asyncContext.get() );
+
 	if (!sendMessage< UpdateSingleLED >( led.parentIdx, led.idx, color ))
 	{
+		forgetSentColorsOf( led.parentIdx );
 		return RequestStatus::SendRequestFailed;
 	}
 
+	vector< Color > & sentColors = sentColorsOf( led.parentIdx );
+	if (led.idx < sentColors.size())
+	{
+		sentColors[ led.idx ] = color;
+	}
+
 	return RequestStatus::Success;
 }
 
@@ -474,6 +836,8 @@ ProfileListResult Client::_requestProfileList()
 		return { RequestStatus::NotConnected, {} };
 	}
 
+	auto requestLock = lockRequests( _asyncContext.get() );
+
 	ProfileListResult result;
 
 	bool sent = sendMessage< RequestProfileList >();
@@ -517,6 +881,9 @@ RequestStatus Client::_loadProfile( const std::string & profileName )
 		return RequestStatus::NotConnected;
 	}
 
+	// the profile may change the colors of any device
+	forgetSentColors();
+
 	if (!sendMessage< RequestLoadProfile >( profileName ))
 	{
 		return RequestStatus::SendRequestFailed;
@@ -540,6 +907,54 @@ RequestStatus Client::_deleteProfile( const std::string & profileName )
 	return RequestStatus::Success;
 }
 
+bool Client::_startAsyncMode( std::function< void () > onDeviceListUpdated )
+{
+	if (!_socket->isConnected() || _asyncContext)
+	{
+		return false;
+	}
+
+	std::unique_ptr< AsyncContext > asyncContext(
+		new AsyncContext( *_socket, *_stats, move( onDeviceListUpdated ), _isDeviceListOutOfDate )
+	);
+	// hand over the messages that arrived during the last check for updates
+	for (auto & message : _pendingMessages)
+	{
+		Header header;
+		BinaryInputStream stream( make_span( message ) );
+		header.deserialize( stream );
+		asyncContext->addReply( header, vector< uint8_t >( message.begin() + Header::size(), message.end() ) );
+	}
+	_pendingMessages.clear();
+
+	if (!asyncContext->start())
+	{
+		return false;
+	}
+
+	_asyncContext = move( asyncContext );
+	return true;
+}
+
+bool Client::_stopAsyncMode() noexcept
+{
+	if (!_asyncContext)
+	{
+		return false;
+	}
+
+	_asyncContext->stop();
+	// take over what the background thread has found out
+	_isDeviceListOutOfDate = _asyncContext->isDeviceListOutOfDate();
+	_asyncContext.reset();
+	return true;
+}
+
+bool Client::isInAsyncMode() const noexcept
+{
+	return _asyncContext != nullptr;
+}
+
 system_error_t Client::getLastSystemError() const noexcept
 {
 	return _socket->getLastSystemError();
@@ -600,6 +1015,15 @@ DeviceListResult Client::requestDeviceList() noexcept
 	)
 }
 
+DeviceListUpdateResult Client::updateDeviceList( DeviceList & devices ) noexcept
+{
+	try {
+		return _updateDeviceList( devices );
+	} CATCH_ALL (
+		return { RequestStatus::UnexpectedError, {} };
+	)
+}
+
 DeviceCountResult Client::requestDeviceCount() noexcept
 {
 	try {
@@ -623,6 +1047,15 @@ UpdateStatus Client::checkForDeviceUpdates() noexcept
 	return _checkForDeviceUpdates();
 }
 
+ClientStats Client::stats() const noexcept
+{
+	try {
+		return _stats->snapshot();
+	} CATCH_ALL (
+		return ClientStats();
+	)
+}
+
 RequestStatus Client::switchToCustomMode( const Device & device ) noexcept
 {
 	try {
@@ -659,6 +1092,53 @@ RequestStatus Client::setDeviceColor( const Device & device, Color color ) noexc
 	)
 }
 
+RequestStatus Client::setDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept
+{
+	try {
+		return _setDeviceColors( device, colors.data(), colors.size() );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+RequestStatus Client::updateDeviceColors( const Device & device, const std::vector< Color > & colors ) noexcept
+{
+	try {
+		return _updateDeviceColors( device, colors.data(), colors.size() );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+RequestStatus Client::sendFrame( DeviceFrame & frame ) noexcept
+{
+	try {
+		return _sendFrame( frame );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+RequestStatus Client::sendPrecompiledMessages( const uint8_t * data, size_t size ) noexcept
+{
+	try {
+		return _sendPrecompiledMessages( data, size );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
+void Client::forgetSentColors() noexcept
+{
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	// keep the inner vectors, so that their capacity can be reused
+	for (auto & sentColors : _sentColors)
+	{
+		sentColors.clear();
+	}
+}
+
 RequestStatus Client::setZoneColor( const Zone & zone, Color color ) noexcept
 {
 	try {
@@ -668,6 +1148,15 @@ RequestStatus Client::setZoneColor( const Zone & zone, Color color ) noexcept
 	)
 }
 
+RequestStatus Client::setZoneColors( const Zone & zone, const std::vector< Color > & colors ) noexcept
+{
+	try {
+		return _setZoneColors( zone, colors.data(), colors.size() );
+	} CATCH_ALL (
+		return RequestStatus::UnexpectedError;
+	)
+}
+
 RequestStatus Client::setZoneSize( const Zone & zone, uint32_t newSize ) noexcept
 {
 	try {
@@ -722,6 +1211,40 @@ RequestStatus Client::deleteProfile( const std::string & profileName )
 	)
 }
 
+bool Client::startAsyncMode( std::function< void () > onDeviceListUpdated ) noexcept
+{
+	try {
+		return _startAsyncMode( move( onDeviceListUpdated ) );
+	} CATCH_ALL (
+		return false;
+	)
+}
+
+bool Client::stopAsyncMode() noexcept
+{
+	return _stopAsyncMode();
+}
+
+std::future< DeviceListResult > Client::requestDeviceListAsync()
+{
+	return runAsync< DeviceListResult >( [ this ]() { return requestDeviceList(); } );
+}
+
+std::future< DeviceCountResult > Client::requestDeviceCountAsync()
+{
+	return runAsync< DeviceCountResult >( [ this ]() { return requestDeviceCount(); } );
+}
+
+std::future< DeviceInfoResult > Client::requestDeviceInfoAsync( uint32_t deviceIdx )
+{
+	return runAsync< DeviceInfoResult >( [ this, deviceIdx ]() { return requestDeviceInfo( deviceIdx ); } );
+}
+
+std::future< ProfileListResult > Client::requestProfileListAsync()
+{
+	return runAsync< ProfileListResult >( [ this ]() { return requestProfileList(); } );
+}
+
 
 //======================================================================================================================
 //  Client: exception-oriented wrappers of the API
@@ -787,6 +1310,30 @@ void Client::setTimeoutX( std::chrono::milliseconds timeout )
 	}
 }
 
+void Client::startAsyncModeX( std::function< void () > onDeviceListUpdated )
+{
+	if (!_socket->isConnected())
+	{
+		throw UserError( "The client is not connected." );
+	}
+	if (_asyncContext)
+	{
+		throw UserError( "The client is already in the asynchronous mode." );
+	}
+	if (!_startAsyncMode( move( onDeviceListUpdated ) ))
+	{
+		throw SystemError( "Failed to start the receiving thread", getLastSystemError() );
+	}
+}
+
+void Client::stopAsyncModeX()
+{
+	if (!_stopAsyncMode())
+	{
+		throw UserError( "The client is not in the asynchronous mode." );
+	}
+}
+
 DeviceList Client::requestDeviceListX()
 {
 	DeviceListResult result = _requestDeviceList();
@@ -794,6 +1341,13 @@ DeviceList Client::requestDeviceListX()
 	return move( result.devices );
 }
 
+DeviceListDiff Client::updateDeviceListX( DeviceList & devices )
+{
+	DeviceListUpdateResult result = _updateDeviceList( devices );
+	requestStatusToException( result.status );
+	return move( result.diff );
+}
+
 uint32_t Client::requestDeviceCountX()
 {
 	DeviceCountResult result = _requestDeviceCount();
@@ -849,12 +1403,36 @@ void Client::setDeviceColorX( const Device & device, Color color )
 	requestStatusToException( status );
 }
 
+void Client::setDeviceColorsX( const Device & device, const std::vector< Color > & colors )
+{
+	RequestStatus status = _setDeviceColors( device, colors.data(), colors.size() );
+	requestStatusToException( status );
+}
+
+void Client::updateDeviceColorsX( const Device & device, const std::vector< Color > & colors )
+{
+	RequestStatus status = _updateDeviceColors( device, colors.data(), colors.size() );
+	requestStatusToException( status );
+}
+
+void Client::sendFrameX( DeviceFrame & frame )
+{
+	RequestStatus status = _sendFrame( frame );
+	requestStatusToException( status );
+}
+
 void Client::setZoneColorX( const Zone & zone, Color color )
 {
 	RequestStatus status = _setZoneColor( zone, color );
 	requestStatusToException( status );
 }
 
+void Client::setZoneColorsX( const Zone & zone, const std::vector< Color > & colors )
+{
+	RequestStatus status = _setZoneColors( zone, colors.data(), colors.size() );
+	requestStatusToException( status );
+}
+
 void Client::setZoneSizeX( const Zone & zone, uint32_t newSize )
 {
 	RequestStatus status = _setZoneSize( zone, newSize );
@@ -898,148 +1476,413 @@ void Client::deleteProfileX( const std::string & profileName )
 //======================================================================================================================
 //  Client: helpers
 
+bool Client::isDeviceListOutOfDate() const noexcept
+{
+	return _asyncContext ? _asyncContext->isDeviceListOutOfDate() : _isDeviceListOutOfDate;
+}
+
+void Client::setDeviceListOutOfDate( bool outOfDate ) noexcept
+{
+	if (_asyncContext)
+		_asyncContext->setDeviceListOutOfDate( outOfDate );
+	else
+		_isDeviceListOutOfDate = outOfDate;
+}
+
+template< typename Result, typename Func >
+std::future< Result > Client::runAsync( Func func )
+{
+	// Without the background thread there would be two threads receiving from the socket at the same time,
+	// so in the synchronous mode we leave the work for whoever asks for the result.
+	return std::async( _asyncContext ? std::launch::async : std::launch::deferred, func );
+}
+
 template< typename Message, typename ... ConstructorArgs >
-bool Client::sendMessage( ConstructorArgs ... args )
+bool Client::sendMessage( const ConstructorArgs & ... args )
 {
 	Message message( args ... );
 
-	// allocate buffer and serialize (header.message_size is calculated in constructor)
-	std::vector< uint8_t > buffer( message.header.size() + message.header.message_size );
-	BinaryOutputStream stream( make_span( buffer ) );
-	message.serialize( stream, _negotiatedProtocolVersion );
+	auto sendLock = lockSending( _asyncContext.get() );
 
-	return _socket->send( make_span( buffer ) ) == SocketError::Success;
+	_sendBuffer.clear();
+	_stats->batchCleared();
+	appendToSendBuffer( message );
+	return sendBuffer();
 }
 
 template< typename Message >
-Client::RecvResult< Message > Client::awaitMessage() noexcept
+void Client::appendToSendBuffer( const Message & message )
 {
-	RecvResult< Message > result;
+	// Serialize behind the messages already in the buffer (header.message_size is calculated in constructor).
+	// Once it grows to the size of the biggest batch, it will never need to be allocated again.
+	size_t offset = _sendBuffer.size();
+	_sendBuffer.resize( offset + message.header.size() + message.header.message_size );
+	BinaryOutputStream stream( span< uint8_t >( _sendBuffer.data() + offset, _sendBuffer.size() - offset ) );
+	message.serialize( stream, _negotiatedProtocolVersion );
+
+	_stats->messageQueued( Message::thisType, _sendBuffer.size() - offset );
+}
+
+bool Client::sendBuffer()
+{
+	// all the messages in the buffer go out in a single system call
+	StatsRecorder::Clock::time_point startTime = _stats->now();
+	bool sent = _socket->send( make_span( _sendBuffer ) ) == SocketError::Success;
+
+	if (sent)
+		_stats->batchSent( startTime );
+	else
+		_stats->batchCleared();
+	return sent;
+}
+
+vector< Color > & Client::sentColorsOf( uint32_t deviceIdx )
+{
+	if (deviceIdx >= _sentColors.size())
+	{
+		_sentColors.resize( deviceIdx + 1 );
+	}
+	return _sentColors[ deviceIdx ];
+}
+
+void Client::forgetSentColorsOf( uint32_t deviceIdx ) noexcept
+{
+	// Some callers (mode changes, zone resizing, device list downloads) hold only the request lock,
+	// while the senders may be growing the _sentColors on other threads. The lock is recursive,
+	// so it doesn't hurt the callers that already hold it.
+	auto sendLock = lockSending( _asyncContext.get() );
+
+	if (deviceIdx < _sentColors.size())
+	{
+		_sentColors[ deviceIdx ].clear();
+	}
+}
+
+RequestStatus Client::downloadDeviceList( DeviceList & devices, vector< bool > & replacedEntries )
+{
+	// the same device is serialized differently in different protocol versions
+	if (devices._protocolVersion != _negotiatedProtocolVersion)
+	{
+		devices._hashes.assign( devices._hashes.size(), 0 );
+		devices._protocolVersion = _negotiatedProtocolVersion;
+	}
 
 	do
 	{
-		// receive header into buffer
-		array< uint8_t, Header::size() > headerBuffer; size_t received;
-		SocketError headerStatus = _socket->receive( make_span( headerBuffer ), received );
-		if (headerStatus != SocketError::Success)
+		setDeviceListOutOfDate( false );
+
+		bool sent = sendMessage< RequestControllerCount >();
+		if (!sent)
 		{
-			if (headerStatus == SocketError::ConnectionClosed)
-				result.status = RequestStatus::ConnectionClosed;
-			else if (headerStatus == SocketError::Timeout)
-				result.status = RequestStatus::NoReply;
-			else
-				result.status = RequestStatus::ReceiveError;
-			return result;
+			return RequestStatus::SendRequestFailed;
 		}
 
-		// parse and validate the header
-		BinaryInputStream stream( make_span( headerBuffer ) );
-		if (!result.message.header.deserialize( stream ))
+		auto deviceCountResult = awaitMessage< ReplyControllerCount >();
+		if (deviceCountResult.status != RequestStatus::Success)
 		{
-			result.status = RequestStatus::InvalidReply;
-			return result;
+			return deviceCountResult.status;
 		}
 
-		// the server may have sent DeviceListUpdated messsage before it received our request
-		if (result.message.header.message_type == MessageType::DEVICE_LIST_UPDATED)
+		uint32_t deviceCount = deviceCountResult.message.count;
+		for (size_t deviceIdx = deviceCount; deviceIdx < devices.size(); ++deviceIdx)
 		{
-			// in that case just set our "out of date" flag and skip it for now
-			_isDeviceListOutOfDate = true;
+			forgetSentColorsOf( uint32_t( deviceIdx ) );
+		}
+		for (size_t deviceIdx = deviceCount; deviceIdx < replacedEntries.size(); ++deviceIdx)
+		{
+			replacedEntries[ deviceIdx ] = true;  // if it comes back in the next pass, it will be a new object
+		}
+		devices.truncate( deviceCount );
+		devices.reserve( deviceCount );
+
+		// The server answers the requests in the order it received them, so we don't need to wait for a reply
+		// before sending the next request, we only need to limit how many of them are pending at the same time.
+		uint32_t maxRequestsInFlight = _deviceListPipelineDepth != 0 ? _deviceListPipelineDepth : deviceCount;
+		uint32_t requestedCount = 0;
+		uint32_t receivedCount = 0;
+		while (receivedCount < deviceCount)
+		{
+			// When we find out the list has changed, there is no point in requesting more devices,
+			// we just need to collect the replies that are already on the way and then start again.
+			while (requestedCount < deviceCount && requestedCount - receivedCount < maxRequestsInFlight
+			    && !isDeviceListOutOfDate())
+			{
+				sent = sendMessage< RequestControllerData >( requestedCount, _negotiatedProtocolVersion );
+				if (!sent)
+				{
+					return RequestStatus::SendRequestFailed;
+				}
+				++requestedCount;
+			}
+
+			if (receivedCount == requestedCount)
+			{
+				break;  // list is out of date and all the pending replies have been collected
+			}
+
+			ReplyControllerData reply;
+			RequestStatus replyStatus = awaitRawMessage( ReplyControllerData::thisType, reply.header );
+			if (replyStatus != RequestStatus::Success)
+			{
+				return replyStatus;
+			}
+			if (reply.header.device_idx != receivedCount)
+			{
+				// the replies came in different order than the requests, something went wrong
+				return RequestStatus::InvalidReply;
+			}
+
+			// Hashing the raw reply is many times faster than parsing it, so we parse only the devices that changed.
+			uint64_t replyHash = hashBytes( _recvBuffer.data(), _recvBuffer.size() );
+			if (receivedCount < devices.size() && devices.contentHash( receivedCount ) == replyHash)
+			{
+				++receivedCount;
+				continue;
+			}
+
+			if (!parseDeviceReply( reply ))
+			{
+				return RequestStatus::InvalidReply;
+			}
+
+			if (receivedCount < devices.size())
+			{
+				devices.replace( receivedCount, move( reply.device_desc ), replyHash );
+				// it may now be a different device or have different LEDs
+				forgetSentColorsOf( receivedCount );
+				if (receivedCount < replacedEntries.size())
+					replacedEntries[ receivedCount ] = true;
+			}
+			else
+			{
+				devices.append( move( reply.device_desc ), replyHash );
+			}
+			++receivedCount;
 		}
 	}
-	while (result.message.header.message_type == MessageType::DEVICE_LIST_UPDATED);
+	// In the middle of the update we might receive DeviceListUpdated message. In that case we need to go through the list
+	// again, but the devices received so far stay in it, so the next pass only reparses those that changed again.
+	while (isDeviceListOutOfDate());
+
+	return RequestStatus::Success;
+}
 
-	if (result.message.header.message_type != Message::thisType)
+bool Client::parseDeviceReply( ReplyControllerData & reply ) noexcept
+{
+	if (_lazyDeviceParsing)
 	{
-		// the message is neither DeviceListUpdated, nor the type we expected
-		result.status = RequestStatus::InvalidReply;
-		return result;
+		return reply.deserializeBodyLazily( make_span( _recvBuffer ), _negotiatedProtocolVersion );
 	}
+	else
+	{
+		BinaryInputStream stream( make_span( _recvBuffer ) );
+		return reply.deserializeBody( stream, _negotiatedProtocolVersion );
+	}
+}
 
-	// receive the message body
-	vector< uint8_t > bodyBuffer;
-	SocketError bodyStatus = _socket->receive( bodyBuffer, result.message.header.message_size );
-	if (bodyStatus != SocketError::Success)
+template< typename Message >
+Client::RecvResult< Message > Client::awaitMessage() noexcept
+{
+	RecvResult< Message > result;
+
+	result.status = awaitRawMessage( Message::thisType, result.message.header );
+	if (result.status != RequestStatus::Success)
 	{
-		if (bodyStatus == SocketError::ConnectionClosed)
-			result.status = RequestStatus::ConnectionClosed;
-		else if (bodyStatus == SocketError::Timeout)
-			result.status = RequestStatus::NoReply;
-		else
-			result.status = RequestStatus::ReceiveError;
 		return result;
 	}
 
 	// parse and validate the body
-	BinaryInputStream stream( make_span( bodyBuffer ) );
+	BinaryInputStream stream( make_span( _recvBuffer ) );
 	if (!result.message.deserializeBody( stream, _negotiatedProtocolVersion ))
 	{
 		result.status = RequestStatus::InvalidReply;
 	}
+
+	return result;
+}
+
+RequestStatus Client::awaitRawMessage( MessageType expectedType, Header & header ) noexcept
+{
+	RequestStatus status = receiveRawMessage( expectedType, header );
+
+	if (status == RequestStatus::Success)
+	{
+		_stats->replyReceived( expectedType, Header::size() + header.message_size );
+	}
 	else
 	{
-		result.status = RequestStatus::Success;
+		// whatever comes next can't be reliably paired with the requests anymore
+		_stats->repliesAbandoned();
 	}
 
-	return result;
+	return status;
 }
 
-UpdateStatus Client::checkForUpdateMessageArrival() noexcept
+RequestStatus Client::receiveRawMessage( MessageType expectedType, Header & header ) noexcept
 {
-	// We only need to check if there is any TCP message in the system input buffer, but don't wait for it.
-	// So we switch the socket to non-blocking mode and try to receive.
+	// Reused by every reply, so that receiving a big device list doesn't allocate a new body buffer for every device.
+	vector< uint8_t > & bodyBuffer = _recvBuffer;
 
-	if (!_socket->setBlockingMode( false ))
+	if (_asyncContext)
 	{
-		return UpdateStatus::OtherSystemError;
+		// The background thread receives everything, we just pick up the next reply it has received.
+		RequestStatus status = _asyncContext->awaitReply( header, bodyBuffer, _timeout );
+		if (status != RequestStatus::Success)
+		{
+			return status;
+		}
+
+		if (header.message_type != expectedType)
+		{
+			return RequestStatus::InvalidReply;
+		}
 	}
+	else if (!_pendingMessages.empty())
+	{
+		// This one arrived earlier while the user was checking for device list updates.
+		vector< uint8_t > message = move( _pendingMessages.front() );
+		_pendingMessages.pop_front();
+
+		BinaryInputStream stream( make_span( message ) );
+		header.deserialize( stream );  // it has already been validated when it arrived
+		if (header.message_type != expectedType)
+		{
+			return RequestStatus::InvalidReply;
+		}
 
-	auto enableBlockingAndReturn = [ this ]( UpdateStatus returnStatus )
+		bodyBuffer.assign( message.begin() + Header::size(), message.end() );
+	}
+	else
 	{
-		if (!_socket->setBlockingMode( true ))
+		do
 		{
-			// This is bad, we changed the state of the socket and now we're unable to return it back.
-			// So rather burn everything to the ground and start from the beginning, than let things be in undefined state.
-			disconnect();
-			return UpdateStatus::CantRestoreSocket;
+			// receive header into buffer
+			array< uint8_t, Header::size() > headerBuffer; size_t received;
+			SocketError headerStatus = _socket->receive( make_span( headerBuffer ), received );
+			if (headerStatus != SocketError::Success)
+			{
+				if (headerStatus == SocketError::ConnectionClosed)
+					return RequestStatus::ConnectionClosed;
+				else if (headerStatus == SocketError::Timeout)
+					return RequestStatus::NoReply;
+				else
+					return RequestStatus::ReceiveError;
+			}
+
+			// parse and validate the header
+			BinaryInputStream stream( make_span( headerBuffer ) );
+			if (!header.deserialize( stream ))
+			{
+				return RequestStatus::InvalidReply;
+			}
+
+			// the server may have sent DeviceListUpdated messsage before it received our request
+			if (header.message_type == MessageType::DEVICE_LIST_UPDATED)
+			{
+				// in that case just set our "out of date" flag and skip it for now
+				_isDeviceListOutOfDate = true;
+				_stats->messageReceived( MessageType::DEVICE_LIST_UPDATED, Header::size() );
+			}
 		}
-		else
+		while (header.message_type == MessageType::DEVICE_LIST_UPDATED);
+
+		if (header.message_type != expectedType)
 		{
-			return returnStatus;
+			// the message is neither DeviceListUpdated, nor the type we expected
+			return RequestStatus::InvalidReply;
 		}
-	};
 
-	vector< uint8_t > buffer;
-	SocketError status = _socket->receive( buffer, Header::size() );
+		// receive the message body
+		SocketError bodyStatus = _socket->receive( bodyBuffer, header.message_size );
+		if (bodyStatus != SocketError::Success)
+		{
+			if (bodyStatus == SocketError::ConnectionClosed)
+				return RequestStatus::ConnectionClosed;
+			else if (bodyStatus == SocketError::Timeout)
+				return RequestStatus::NoReply;
+			else
+				return RequestStatus::ReceiveError;
+		}
+	}
+
+	return RequestStatus::Success;
+}
+
+UpdateStatus Client::checkForUpdateMessageArrival() noexcept
+{
+	// We only need to check if there is any TCP message in the system input buffer, but don't wait for it.
+	// Peeking without waiting is a single system call and it leaves the socket blocking for all the other operations.
+	array< uint8_t, Header::size() > headerBuffer; size_t received;
+	SocketError status = _socket->peek( make_span( headerBuffer ), received );
 	if (status == SocketError::WouldBlock)
 	{
 		// No message is currently in the socket, no indication that the device list is out of date.
-		return enableBlockingAndReturn( UpdateStatus::UpToDate );
+		return UpdateStatus::UpToDate;
 	}
 	else if (status == SocketError::ConnectionClosed)
 	{
-		return enableBlockingAndReturn( UpdateStatus::ConnectionClosed );
+		return UpdateStatus::ConnectionClosed;
 	}
 	else if (status != SocketError::Success)
 	{
-		return enableBlockingAndReturn( UpdateStatus::OtherSystemError );
+		return UpdateStatus::OtherSystemError;
+	}
+
+	if (received < headerBuffer.size())
+	{
+		// Only a part of the header has arrived so far, the rest will be there at one of the next checks.
+		return UpdateStatus::UpToDate;
+	}
+
+	// The whole header is there, so taking it out of the socket doesn't wait.
+	status = _socket->receive( make_span( headerBuffer ), received );
+	if (status == SocketError::ConnectionClosed)
+	{
+		return UpdateStatus::ConnectionClosed;
+	}
+	else if (status != SocketError::Success)
+	{
+		return UpdateStatus::OtherSystemError;
 	}
 
 	// We have some message, so let's check what it is.
 
 	Header header;
-	BinaryInputStream stream( make_span( buffer ) );
-	if (!header.deserialize( stream ) || header.message_type != MessageType::DEVICE_LIST_UPDATED)
+	BinaryInputStream stream( make_span( headerBuffer ) );
+	if (!header.deserialize( stream ))
 	{
 		// We received something, but something totally different than what we expected.
-		return enableBlockingAndReturn( UpdateStatus::UnexpectedMessage );
+		return UpdateStatus::UnexpectedMessage;
 	}
-	else
+
+	if (header.message_type == MessageType::DEVICE_LIST_UPDATED)
 	{
+		_stats->messageReceived( MessageType::DEVICE_LIST_UPDATED, Header::size() );
 		// We have received a DeviceListUpdated message from the server,
 		// signal to the user that he needs to request the list again.
-		return enableBlockingAndReturn( UpdateStatus::OutOfDate );
+		return UpdateStatus::OutOfDate;
 	}
+
+	// It's some other message, most likely a late reply to an earlier request. Its body is already on the way,
+	// so wait for it and keep the whole message for the next awaitMessage() instead of throwing it away.
+	vector< uint8_t > message( headerBuffer.begin(), headerBuffer.end() );
+	if (header.message_size > 0)
+	{
+		vector< uint8_t > body;
+		SocketError bodyStatus = _socket->receive( body, header.message_size );
+		if (bodyStatus == SocketError::ConnectionClosed)
+		{
+			return UpdateStatus::ConnectionClosed;
+		}
+		else if (bodyStatus != SocketError::Success)
+		{
+			return UpdateStatus::OtherSystemError;
+		}
+		message.insert( message.end(), body.begin(), body.end() );
+	}
+	_pendingMessages.push_back( move( message ) );
+
+	return UpdateStatus::UpToDate;
 }
 
 
@@ -0,0 +1,261 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: group of clients connected to multiple servers and operated in parallel
+//======================================================================================================================
+
+#include "OpenRGB/ClientGroup.hpp"
+
+#include "Essential.hpp"
+
+#include <cstdio>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <functional>
+using std::function;
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+#include <chrono>
+using std::chrono::milliseconds;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+ClientGroup::ClientGroup( const std::string & clientName, unsigned int threadCount ) noexcept
+:
+	_clientName( clientName ),
+	_threadCount( threadCount ),
+	_job( nullptr ),
+	_generation( 0 ),
+	_hostCount( 0 ),
+	_nextHost( 0 ),
+	_busyWorkers( 0 ),
+	_stopRequested( false )
+{}
+
+ClientGroup::~ClientGroup() noexcept
+{
+	{
+		unique_lock< mutex > lock( _poolMutex );
+		_stopRequested = true;
+	}
+	_workCond.notify_all();
+
+	for (std::thread & worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+size_t ClientGroup::addHost( const std::string & host, uint16_t port )
+{
+	_hosts.emplace_back( new Host( host, port, _clientName ) );
+	return _hosts.size() - 1;
+}
+
+GroupResult ClientGroup::connect() noexcept
+{
+	return runOnAllHosts( []( Host & host, size_t )
+	{
+		if (host.client.isConnected())
+		{
+			host.connectStatus = ConnectStatus::Success;
+		}
+		else
+		{
+			host.connectStatus = host.client.connect( host.name, host.port );
+		}
+		host.lastStatus = host.connectStatus == ConnectStatus::Success ? RequestStatus::Success : RequestStatus::NotConnected;
+		return host.connectStatus == ConnectStatus::Success;
+	});
+}
+
+void ClientGroup::disconnect() noexcept
+{
+	runOnAllHosts( []( Host & host, size_t )
+	{
+		host.client.disconnect();
+		host.lastStatus = RequestStatus::NotConnected;
+		return true;
+	});
+}
+
+GroupResult ClientGroup::setTimeout( milliseconds timeout ) noexcept
+{
+	return runOnAllHosts( [ timeout ]( Host & host, size_t )
+	{
+		host.lastStatus = host.client.setTimeout( timeout ) ? RequestStatus::Success : RequestStatus::NotConnected;
+		return host.lastStatus == RequestStatus::Success;
+	});
+}
+
+GroupResult ClientGroup::requestDeviceLists() noexcept
+{
+	return runOnAllHosts( []( Host & host, size_t )
+	{
+		DeviceListResult result = host.client.requestDeviceList();
+		host.lastStatus = result.status;
+		if (result.status == RequestStatus::Success)
+		{
+			host.devices = std::move( result.devices );
+		}
+		return result.status == RequestStatus::Success;
+	});
+}
+
+GroupResult ClientGroup::forEach( function< RequestStatus ( Client &, const DeviceList &, size_t ) > func ) noexcept
+{
+	return runOnAllHosts( [ &func ]( Host & host, size_t hostIdx )
+	{
+		if (!host.client.isConnected())
+		{
+			host.lastStatus = RequestStatus::NotConnected;
+			return false;
+		}
+		host.lastStatus = func( host.client, host.devices, hostIdx );
+		return host.lastStatus == RequestStatus::Success;
+	});
+}
+
+GroupResult ClientGroup::runOnAllHosts( const function< bool ( Host & host, size_t hostIdx ) > & job )
+{
+	GroupResult result;
+
+	if (_hosts.empty())
+	{
+		return result;
+	}
+
+	vector< char > succeeded( _hosts.size(), false );
+	auto measuredJob = [ & ]( Host & host, size_t hostIdx )
+	{
+		auto startTime = steady_clock::now();
+		succeeded[ hostIdx ] = job( host, hostIdx );
+		host.finishTime = steady_clock::now();
+		host.lastLatency = duration_cast< microseconds >( host.finishTime - startTime );
+	};
+
+	try {
+		if (!ensureWorkers())
+		{
+			// not a single thread could be started, do it at least sequentially
+			for (size_t hostIdx = 0; hostIdx < _hosts.size(); ++hostIdx)
+			{
+				measuredJob( *_hosts[ hostIdx ], hostIdx );
+			}
+		}
+		else
+		{
+			unique_lock< mutex > lock( _poolMutex );
+
+			// a worker that woke up late for the previous job could still be looking for a host
+			_doneCond.wait( lock, [ this ]() { return _busyWorkers == 0; } );
+
+			const function< void ( Host &, size_t ) > workerJob = measuredJob;
+			_job = &workerJob;
+			_hostCount = _hosts.size();
+			_nextHost = 0;
+			_generation++;
+			_workCond.notify_all();
+
+			// Wait until every host was taken and every worker has finished its last one.
+			_doneCond.wait( lock, [ this ]() { return _nextHost >= _hostCount && _busyWorkers == 0; } );
+			_job = nullptr;
+		}
+	} catch (const std::exception & ex) {
+		fprintf( stderr, "Unexpected std::exception was thrown: %s\n", ex.what() );
+	}
+
+	for (char hostSucceeded : succeeded)
+	{
+		(hostSucceeded ? result.succeeded : result.failed)++;
+	}
+
+	auto firstFinish = _hosts.front()->finishTime;
+	auto lastFinish = _hosts.front()->finishTime;
+	for (auto & host : _hosts)
+	{
+		result.maxLatency = std::max( result.maxLatency, host->lastLatency );
+		firstFinish = std::min( firstFinish, host->finishTime );
+		lastFinish = std::max( lastFinish, host->finishTime );
+	}
+	result.skew = duration_cast< microseconds >( lastFinish - firstFinish );
+
+	return result;
+}
+
+bool ClientGroup::ensureWorkers()
+{
+	size_t wantedCount = _threadCount > 0 ? std::min( size_t( _threadCount ), _hosts.size() ) : _hosts.size();
+
+	while (_workers.size() < wantedCount)
+	{
+		uint64_t currentGeneration;
+		{
+			unique_lock< mutex > lock( _poolMutex );
+			currentGeneration = _generation;
+		}
+		try {
+			_workers.emplace_back( &ClientGroup::workerLoop, this, currentGeneration );
+		} catch (const std::system_error &) {
+			// continue with the threads we already have
+			break;
+		}
+	}
+
+	return !_workers.empty();
+}
+
+void ClientGroup::workerLoop( uint64_t seenGeneration ) noexcept
+{
+	unique_lock< mutex > lock( _poolMutex );
+
+	while (true)
+	{
+		_workCond.wait( lock, [ & ]() { return _stopRequested || _generation != seenGeneration; } );
+		if (_stopRequested)
+		{
+			return;
+		}
+		seenGeneration = _generation;
+
+		if (!_job)
+		{
+			continue;  // woke up after the job has already been completed by the others
+		}
+		const function< void ( Host &, size_t ) > & job = *_job;
+		const size_t hostCount = _hostCount;
+		_busyWorkers++;
+		lock.unlock();
+
+		size_t hostIdx;
+		while ((hostIdx = _nextHost++) < hostCount)
+		{
+			job( *_hosts[ hostIdx ], hostIdx );
+		}
+
+		lock.lock();
+		_busyWorkers--;
+		if (_busyWorkers == 0)
+		{
+			_doneCond.notify_all();
+		}
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
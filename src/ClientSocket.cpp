@@ -0,0 +1,519 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: TCP socket of the client
+//======================================================================================================================
+
+#include "ClientSocket.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <climits>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <chrono>
+using std::chrono::milliseconds;
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <cerrno>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/time.h>
+	#include <netinet/in.h>
+	#include <netdb.h>
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  system differences
+
+#ifdef _WIN32
+
+using native_socket_t = SOCKET;
+using io_result_t = int;
+static const socket_handle_t invalidSocket = socket_handle_t( INVALID_SOCKET );
+static const int sendFlags = 0;
+
+static system_error_t lastSocketError() noexcept  { return system_error_t( WSAGetLastError() ); }
+
+static bool isInterrupted( system_error_t error ) noexcept     { return error == WSAEINTR; }
+static bool isWouldBlock( system_error_t error ) noexcept      { return error == WSAEWOULDBLOCK; }
+static bool isTimeout( system_error_t error ) noexcept         { return error == WSAETIMEDOUT; }
+static bool isConnectionLost( system_error_t error ) noexcept  { return error == WSAECONNRESET || error == WSAECONNABORTED; }
+
+/// The system calls take the size as int.
+static int chunkSize( size_t size ) noexcept  { return size < size_t( INT_MAX ) ? int( size ) : INT_MAX; }
+
+static bool initNetworking() noexcept
+{
+	struct Winsock
+	{
+		bool initialized;
+		Winsock() noexcept  { WSADATA data; initialized = WSAStartup( MAKEWORD( 2, 2 ), &data ) == 0; }
+		~Winsock() noexcept  { if (initialized) WSACleanup(); }
+	};
+	static const Winsock winsock;
+	return winsock.initialized;
+}
+
+static void closeSocket( socket_handle_t socket ) noexcept  { closesocket( native_socket_t( socket ) ); }
+static const int shutdownBoth = SD_BOTH;
+
+#else
+
+using native_socket_t = int;
+using io_result_t = ssize_t;
+static const socket_handle_t invalidSocket = -1;
+#ifdef MSG_NOSIGNAL
+	static const int sendFlags = MSG_NOSIGNAL;  // a closed connection must be reported by the error, not kill the process
+#else
+	static const int sendFlags = 0;  // macOS doesn't have it, SO_NOSIGPIPE is set on the socket instead
+#endif
+
+static system_error_t lastSocketError() noexcept  { return errno; }
+
+static bool isInterrupted( system_error_t error ) noexcept     { return error == EINTR; }
+static bool isWouldBlock( system_error_t error ) noexcept      { return error == EAGAIN || error == EWOULDBLOCK; }
+static bool isTimeout( system_error_t error ) noexcept         { return error == EAGAIN || error == EWOULDBLOCK; }  // SO_RCVTIMEO
+static bool isConnectionLost( system_error_t error ) noexcept  { return error == ECONNRESET || error == EPIPE; }
+
+static size_t chunkSize( size_t size ) noexcept  { return size; }
+
+static bool initNetworking() noexcept  { return true; }
+
+static void closeSocket( socket_handle_t socket ) noexcept  { ::close( socket ); }
+static const int shutdownBoth = SHUT_RDWR;
+
+#endif // _WIN32
+
+
+//======================================================================================================================
+//  ClientSocket
+
+ClientSocket::ClientSocket() noexcept
+:
+	_socket( invalidSocket ),
+	_wakeupReceiver( invalidSocket ),
+	_wakeupSender( invalidSocket ),
+	_isConnected( false ),
+	_lastSystemError( 0 )
+{}
+
+ClientSocket::~ClientSocket() noexcept
+{
+	close();
+}
+
+SocketError ClientSocket::connect( const string & host, uint16_t port ) noexcept
+{
+	if (_isConnected)
+	{
+		return SocketError::AlreadyConnected;
+	}
+
+	if (!initNetworking())
+	{
+		_lastSystemError = lastSocketError();
+		return SocketError::NetworkingInitFailed;
+	}
+
+	addrinfo hints;
+	memset( &hints, 0, sizeof(hints) );
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	char portStr [8];
+	snprintf( portStr, sizeof(portStr), "%u", unsigned( port ) );
+
+	addrinfo * addresses = nullptr;
+	if (getaddrinfo( host.c_str(), portStr, &hints, &addresses ) != 0)
+	{
+		_lastSystemError = lastSocketError();
+		return SocketError::HostNotResolved;
+	}
+
+	for (addrinfo * address = addresses; address != nullptr; address = address->ai_next)
+	{
+		socket_handle_t newSocket = socket_handle_t( ::socket( address->ai_family, address->ai_socktype, address->ai_protocol ) );
+		if (newSocket == invalidSocket)
+		{
+			_lastSystemError = lastSocketError();
+			continue;
+		}
+		if (::connect( native_socket_t( newSocket ), address->ai_addr, socklen_t( address->ai_addrlen ) ) == 0)
+		{
+			_socket = newSocket;
+			break;
+		}
+		_lastSystemError = lastSocketError();
+		closeSocket( newSocket );
+	}
+	freeaddrinfo( addresses );
+
+	if (_socket == invalidSocket)
+	{
+		return SocketError::ConnectFailed;
+	}
+
+	if (!openWakeupChannel())
+	{
+		close();
+		return SocketError::Other;
+	}
+
+ #ifdef SO_NOSIGPIPE
+	int enable = 1;
+	setsockopt( _socket, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable) );
+ #endif
+
+	_isConnected = true;
+	return SocketError::Success;
+}
+
+SocketError ClientSocket::disconnect() noexcept
+{
+	if (!_isConnected)
+	{
+		return SocketError::NotConnected;
+	}
+
+	// fails when the server has already ended the connection forcibly, the socket gets closed anyway
+	bool shutdownFailed = ::shutdown( native_socket_t( _socket ), shutdownBoth ) != 0;
+	if (shutdownFailed)
+	{
+		_lastSystemError = lastSocketError();
+	}
+	close();
+
+	return shutdownFailed ? SocketError::Other : SocketError::Success;
+}
+
+void ClientSocket::close() noexcept
+{
+	if (_socket != invalidSocket)
+	{
+		closeSocket( _socket );
+		_socket = invalidSocket;
+	}
+	closeWakeupChannel();
+	_isConnected = false;
+}
+
+bool ClientSocket::openWakeupChannel() noexcept
+{
+ #ifdef _WIN32
+
+	// a UDP socket bound to a free port on the loopback and connected to itself, so that it can send to itself
+	SOCKET wakeupSocket = ::socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+	if (wakeupSocket == INVALID_SOCKET)
+	{
+		_lastSystemError = lastSocketError();
+		return false;
+	}
+	sockaddr_in address;
+	memset( &address, 0, sizeof(address) );
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	address.sin_port = 0;
+	int addressLen = sizeof(address);
+	u_long nonBlocking = 1;
+	if (::bind( wakeupSocket, reinterpret_cast< const sockaddr * >( &address ), sizeof(address) ) != 0
+	 || ::getsockname( wakeupSocket, reinterpret_cast< sockaddr * >( &address ), &addressLen ) != 0
+	 || ::connect( wakeupSocket, reinterpret_cast< const sockaddr * >( &address ), addressLen ) != 0
+	 || ::ioctlsocket( wakeupSocket, FIONBIO, &nonBlocking ) != 0)
+	{
+		_lastSystemError = lastSocketError();
+		closesocket( wakeupSocket );
+		return false;
+	}
+	_wakeupReceiver = socket_handle_t( wakeupSocket );
+	_wakeupSender = socket_handle_t( wakeupSocket );
+
+ #else
+
+	int pipeEnds [2];
+	if (::pipe( pipeEnds ) != 0)
+	{
+		_lastSystemError = lastSocketError();
+		return false;
+	}
+	// neither a full pipe nor draining an empty one may block
+	for (int end : pipeEnds)
+	{
+		::fcntl( end, F_SETFL, ::fcntl( end, F_GETFL ) | O_NONBLOCK );
+	}
+	_wakeupReceiver = pipeEnds[0];
+	_wakeupSender = pipeEnds[1];
+
+ #endif // _WIN32
+
+	return true;
+}
+
+void ClientSocket::closeWakeupChannel() noexcept
+{
+	if (_wakeupSender != invalidSocket && _wakeupSender != _wakeupReceiver)
+	{
+		closeSocket( _wakeupSender );
+	}
+	if (_wakeupReceiver != invalidSocket)
+	{
+		closeSocket( _wakeupReceiver );
+	}
+	_wakeupReceiver = invalidSocket;
+	_wakeupSender = invalidSocket;
+}
+
+bool ClientSocket::setTimeout( milliseconds timeout ) noexcept
+{
+	if (!_isConnected)
+	{
+		return false;
+	}
+
+ #ifdef _WIN32
+	DWORD value = DWORD( timeout.count() );
+ #else
+	timeval value;
+	value.tv_sec = time_t( timeout.count() / 1000 );
+	value.tv_usec = suseconds_t( (timeout.count() % 1000) * 1000 );
+ #endif
+	// zero means no timeout on all the systems
+	if (setsockopt( native_socket_t( _socket ), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast< const char * >( &value ), sizeof(value) ) != 0)
+	{
+		_lastSystemError = lastSocketError();
+		return false;
+	}
+
+	return true;
+}
+
+SocketError ClientSocket::send( own::const_byte_span buffer ) noexcept
+{
+	if (!_isConnected)
+	{
+		return SocketError::NotConnected;
+	}
+
+	size_t sentTotal = 0;
+	while (sentTotal < buffer.size())
+	{
+		io_result_t sent = ::send( native_socket_t( _socket ), reinterpret_cast< const char * >( buffer.data() + sentTotal ),
+		                           chunkSize( buffer.size() - sentTotal ), sendFlags );
+		if (sent < 0)
+		{
+			system_error_t error = lastSocketError();
+			if (isInterrupted( error ))
+			{
+				continue;
+			}
+			_lastSystemError = error;
+			return isConnectionLost( error ) ? SocketError::ConnectionClosed : SocketError::SendFailed;
+		}
+		sentTotal += size_t( sent );
+	}
+
+	return SocketError::Success;
+}
+
+SocketError ClientSocket::receive( own::byte_span buffer, size_t & received ) noexcept
+{
+	received = 0;
+	if (!_isConnected)
+	{
+		return SocketError::NotConnected;
+	}
+
+	while (received < buffer.size())
+	{
+		io_result_t result = ::recv( native_socket_t( _socket ), reinterpret_cast< char * >( buffer.data() + received ),
+		                             chunkSize( buffer.size() - received ), MSG_WAITALL );
+		if (result > 0)
+		{
+			received += size_t( result );
+			continue;
+		}
+		if (result == 0)
+		{
+			return SocketError::ConnectionClosed;
+		}
+		system_error_t error = lastSocketError();
+		if (isInterrupted( error ))
+		{
+			continue;
+		}
+		_lastSystemError = error;
+		if (isTimeout( error ))
+			return SocketError::Timeout;
+		else if (isConnectionLost( error ))
+			return SocketError::ConnectionClosed;
+		else
+			return SocketError::Other;
+	}
+
+	return SocketError::Success;
+}
+
+SocketError ClientSocket::receive( vector< uint8_t > & buffer, size_t size ) noexcept
+{
+	try {
+		buffer.resize( size );
+	} catch (const std::bad_alloc &) {
+		return SocketError::Other;
+	}
+
+	size_t received;
+	return receive( own::byte_span( buffer.data(), buffer.size() ), received );
+}
+
+SocketError ClientSocket::peek( own::byte_span buffer, size_t & received ) noexcept
+{
+	received = 0;
+	if (!_isConnected)
+	{
+		return SocketError::NotConnected;
+	}
+	if (buffer.size() == 0)
+	{
+		return SocketError::Success;
+	}
+
+ #ifdef _WIN32
+	// Windows has no flag for a single non-blocking receive, but select() with a zero timeout tells it without waiting
+	// and the receive then doesn't wait either.
+	fd_set readable;
+	FD_ZERO( &readable );
+	FD_SET( native_socket_t( _socket ), &readable );
+	timeval noWait = { 0, 0 };
+	int ready = ::select( 0, &readable, nullptr, nullptr, &noWait );
+	if (ready == 0)
+	{
+		return SocketError::WouldBlock;
+	}
+	io_result_t result = ready < 0 ? SOCKET_ERROR
+		: ::recv( native_socket_t( _socket ), reinterpret_cast< char * >( buffer.data() ), chunkSize( buffer.size() ), MSG_PEEK );
+ #else
+	io_result_t result;
+	do
+	{
+		result = ::recv( _socket, buffer.data(), buffer.size(), MSG_PEEK | MSG_DONTWAIT );
+	}
+	while (result < 0 && isInterrupted( lastSocketError() ));
+ #endif
+
+	if (result > 0)
+	{
+		received = size_t( result );
+		return SocketError::Success;
+	}
+	if (result == 0)
+	{
+		return SocketError::ConnectionClosed;
+	}
+	system_error_t error = lastSocketError();
+	if (isWouldBlock( error ))
+	{
+		return SocketError::WouldBlock;
+	}
+	_lastSystemError = error;
+	return isConnectionLost( error ) ? SocketError::ConnectionClosed : SocketError::Other;
+}
+
+SocketError ClientSocket::waitForData() noexcept
+{
+	if (!_isConnected)
+	{
+		return SocketError::NotConnected;
+	}
+
+	bool hasData, wokenUp;
+
+ #ifdef _WIN32
+
+	// select() is enough for 2 sockets and unlike WSAPoll() it's available on all versions of Windows
+	fd_set readable;
+	FD_ZERO( &readable );
+	FD_SET( native_socket_t( _socket ), &readable );
+	FD_SET( native_socket_t( _wakeupReceiver ), &readable );
+	int ready = ::select( 0, &readable, nullptr, nullptr, nullptr );
+	if (ready < 0)
+	{
+		_lastSystemError = lastSocketError();
+		return SocketError::Other;
+	}
+	hasData = FD_ISSET( native_socket_t( _socket ), &readable ) != 0;
+	wokenUp = FD_ISSET( native_socket_t( _wakeupReceiver ), &readable ) != 0;
+
+ #else
+
+	pollfd waited [2];
+	waited[0].fd = _socket;
+	waited[0].events = POLLIN;
+	waited[1].fd = _wakeupReceiver;
+	waited[1].events = POLLIN;
+	int ready;
+	do
+	{
+		ready = ::poll( waited, 2, -1 );
+	}
+	while (ready < 0 && isInterrupted( lastSocketError() ));
+	if (ready < 0)
+	{
+		_lastSystemError = lastSocketError();
+		return SocketError::Other;
+	}
+	// the end of the connection and errors are reported as well, the next receive tells which one it is
+	hasData = waited[0].revents != 0;
+	wokenUp = waited[1].revents != 0;
+
+ #endif // _WIN32
+
+	if (wokenUp)
+	{
+		// take out all the wake-ups, so that the next wait doesn't return right away
+		char drained [16];
+	 #ifdef _WIN32
+		while (::recv( native_socket_t( _wakeupReceiver ), drained, sizeof(drained), 0 ) > 0) {}
+	 #else
+		while (::read( _wakeupReceiver, drained, sizeof(drained) ) > 0) {}
+	 #endif
+		return SocketError::Interrupted;
+	}
+
+	return hasData ? SocketError::Success : SocketError::Other;
+}
+
+void ClientSocket::interruptWait() noexcept
+{
+	if (_wakeupSender == invalidSocket)
+	{
+		return;
+	}
+
+	// When the channel is full, there are enough wake-ups in it already.
+	const char wakeup = 0;
+ #ifdef _WIN32
+	::send( native_socket_t( _wakeupSender ), &wakeup, 1, 0 );
+ #else
+	ssize_t written = ::write( _wakeupSender, &wakeup, 1 );
+	(void)written;
+ #endif
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
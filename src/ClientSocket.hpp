@@ -0,0 +1,129 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: TCP socket of the client
+//======================================================================================================================
+
+#ifndef OPENRGB_CLIENT_SOCKET_INCLUDED
+#define OPENRGB_CLIENT_SOCKET_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ContainerUtils.hpp"  // span
+#include "OpenRGB/SystemErrorType.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+enum class SocketError
+{
+	Success,
+	NetworkingInitFailed,
+	AlreadyConnected,
+	HostNotResolved,
+	ConnectFailed,
+	NotConnected,
+	SendFailed,
+	ConnectionClosed,
+	Timeout,
+	WouldBlock,
+	Interrupted,
+	Other,
+};
+
+#ifdef _WIN32
+	using socket_handle_t = uintptr_t;  // should be SOCKET but let's not include the whole winsock2.h just because of this
+#else
+	using socket_handle_t = int;
+#endif
+
+
+//======================================================================================================================
+/// Blocking TCP socket that can also look into the receive buffer without waiting and be woken up from waiting.
+/** The generic TcpSocket of CppUtils-Network can only switch the whole socket into the non-blocking mode,
+  * which costs a system call there and another one back. Checking for device list updates every frame needs
+  * a check that costs a single system call and leaves the socket as it is. And the receiving thread
+  * of the asynchronous mode needs to wait for messages without a timeout and still stop immediately. */
+
+class ClientSocket
+{
+
+ public:
+
+	ClientSocket() noexcept;
+	~ClientSocket() noexcept;
+
+	ClientSocket( const ClientSocket & other ) = delete;
+	ClientSocket & operator=( const ClientSocket & other ) = delete;
+
+	/// Resolves the host and connects to the first of its addresses that accepts the connection.
+	SocketError connect( const std::string & host, uint16_t port ) noexcept;
+
+	SocketError disconnect() noexcept;
+
+	bool isConnected() const noexcept  { return _isConnected; }
+
+	/// Limits how long the receive operations wait, zero means no limit.
+	bool setTimeout( std::chrono::milliseconds timeout ) noexcept;
+
+	/// Sends the whole buffer, waits until the system accepts all of it.
+	SocketError send( own::const_byte_span buffer ) noexcept;
+
+	/// Receives exactly buffer.size() bytes, waits for them at most the timeout.
+	/** When it fails, \p received tells how many bytes have been received before that. */
+	SocketError receive( own::byte_span buffer, size_t & received ) noexcept;
+
+	/// Resizes the buffer to \p size and receives exactly that many bytes into it.
+	SocketError receive( std::vector< uint8_t > & buffer, size_t size ) noexcept;
+
+	/// Copies the bytes that have already arrived into the buffer without waiting and without removing them.
+	/** \p received can be lower than buffer.size() when only a part has arrived so far.
+	  * \returns WouldBlock when nothing has arrived */
+	SocketError peek( own::byte_span buffer, size_t & received ) noexcept;
+
+	/// Waits without any timeout until something arrives, the connection ends or interruptWait() is called.
+	/** Nothing is received, the data stay in the socket for the next receive.
+	  * \returns Success when there is something to receive or the connection has ended,
+	  *          Interrupted when it has been woken up by interruptWait(), Other when the wait itself failed */
+	SocketError waitForData() noexcept;
+
+	/// Wakes up waitForData() waiting in another thread. When nobody is waiting, the next waitForData() returns
+	/// right away, so the wake-up can't get lost.
+	void interruptWait() noexcept;
+
+	system_error_t getLastSystemError() const noexcept  { return _lastSystemError; }
+
+ private:
+
+	void close() noexcept;
+	bool openWakeupChannel() noexcept;
+	void closeWakeupChannel() noexcept;
+
+	socket_handle_t _socket;
+	/// interruptWait() writes a byte into the sender end, waitForData() waits for the receiver end too.
+	/// A pipe on Unix, a UDP socket connected to itself on Windows, where only sockets can be waited for.
+	socket_handle_t _wakeupReceiver;
+	socket_handle_t _wakeupSender;
+	bool _isConnected;
+	system_error_t _lastSystemError;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_CLIENT_SOCKET_INCLUDED
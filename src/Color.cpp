@@ -9,6 +9,7 @@
 
 #include "Essential.hpp"
 
+#include "ColorModels.hpp"
 #include "MiscUtils.hpp"
 #include "StringUtils.hpp"
 #include "BinaryStream.hpp"
@@ -83,6 +84,45 @@ bool Color::fromString( const std::string & str ) noexcept
 	return false;
 }
 
+Color Color::fromHSV( HSV hsv ) noexcept
+{
+	return hsvToColor( hsv );
+}
+
+Color Color::fromHSL( HSL hsl ) noexcept
+{
+	return hslToColor( hsl );
+}
+
+const ColorModelReciprocals & colorModelReciprocals() noexcept
+{
+	struct Tables : ColorModelReciprocals
+	{
+		Tables()
+		{
+			hue[0] = 0;
+			saturation[0] = 0;
+			for (uint32_t i = 1; i < 256; ++i)
+			{
+				hue[i] = ((1u << 31) + 3 * i) / (6 * i);
+				saturation[i] = ((255u << 16) + i / 2) / i;
+			}
+		}
+	};
+	static const Tables tables;
+	return tables;
+}
+
+HSV Color::toHSV() const noexcept
+{
+	return colorToHSV( *this, colorModelReciprocals() );
+}
+
+HSL Color::toHSL() const noexcept
+{
+	return colorToHSL( *this, colorModelReciprocals() );
+}
+
 BinaryOutputStream & operator<<( BinaryOutputStream & stream, Color color )
 {
 	stream << color.r << color.g << color.b << color.padding;
@@ -0,0 +1,355 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: fast bulk operations over buffers of colors
+//======================================================================================================================
+
+#include "OpenRGB/ColorBuffer.hpp"
+
+#include "Essential.hpp"
+
+#include "ColorKernels.hpp"
+#include "ColorModels.hpp"
+
+#include <cmath>
+#include <atomic>
+#include <initializer_list>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  scalar implementation
+//
+//  This one defines the results, the vector implementations must match it exactly.
+
+static void fillScalar( Color * dst, size_t count, Color color )
+{
+	color.padding = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = color;
+	}
+}
+
+static void blendScalar( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount )
+{
+	const uint32_t toWeight = amount;
+	const uint32_t fromWeight = 255 - toWeight;
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			div255( from[i].r * fromWeight + to[i].r * toWeight ),
+			div255( from[i].g * fromWeight + to[i].g * toWeight ),
+			div255( from[i].b * fromWeight + to[i].b * toWeight )
+		);
+	}
+}
+
+static void scaleScalar( Color * dst, const Color * src, size_t count, uint8_t brightness )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			div255( src[i].r * uint32_t( brightness ) ),
+			div255( src[i].g * uint32_t( brightness ) ),
+			div255( src[i].b * uint32_t( brightness ) )
+		);
+	}
+}
+
+static inline uint8_t applyGain( uint8_t value, uint16_t gain ) noexcept
+{
+	uint32_t result = (uint32_t( value ) * gain) >> 8;
+	return uint8_t( result < 255 ? result : 255 );
+}
+
+static void gainScalar( Color * dst, const Color * src, size_t count, uint16_t redGain, uint16_t greenGain, uint16_t blueGain )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			applyGain( src[i].r, redGain ),
+			applyGain( src[i].g, greenGain ),
+			applyGain( src[i].b, blueGain )
+		);
+	}
+}
+
+static inline uint8_t addSaturated( uint8_t a, uint8_t b ) noexcept
+{
+	unsigned sum = unsigned( a ) + unsigned( b );
+	return uint8_t( sum < 255 ? sum : 255 );
+}
+
+static void addScalar( Color * dst, const Color * src, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			addSaturated( dst[i].r, src[i].r ),
+			addSaturated( dst[i].g, src[i].g ),
+			addSaturated( dst[i].b, src[i].b )
+		);
+	}
+}
+
+static inline uint8_t max8( uint8_t a, uint8_t b ) noexcept  { return a > b ? a : b; }
+static inline uint8_t min8( uint8_t a, uint8_t b ) noexcept  { return a < b ? a : b; }
+
+static void maxScalar( Color * dst, const Color * src, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			max8( dst[i].r, src[i].r ),
+			max8( dst[i].g, src[i].g ),
+			max8( dst[i].b, src[i].b )
+		);
+	}
+}
+
+static void clampScalar( Color * dst, const Color * src, size_t count, Color min, Color max )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor(
+			min8( max8( src[i].r, min.r ), max.r ),
+			min8( max8( src[i].g, min.g ), max.g ),
+			min8( max8( src[i].b, min.b ), max.b )
+		);
+	}
+}
+
+static void fromHSVScalar( Color * dst, const HSV * src, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = hsvToColor( src[i] );
+	}
+}
+
+static void fromHSLScalar( Color * dst, const HSL * src, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = hslToColor( src[i] );
+	}
+}
+
+static void toHSVScalar( HSV * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = colorToHSV( src[i], reciprocals );
+	}
+}
+
+static void toHSLScalar( HSL * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = colorToHSL( src[i], reciprocals );
+	}
+}
+
+static void gatherScalar( Color * dst, const Color * src, const uint32_t * indexes, size_t count )
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Color color = src[ indexes[i] ];
+		dst[i] = makeColor( color.r, color.g, color.b );
+	}
+}
+
+const ColorKernels scalarColorKernels =
+{
+	SimdLevel::Scalar,
+	fillScalar,
+	blendScalar,
+	scaleScalar,
+	gainScalar,
+	addScalar,
+	maxScalar,
+	clampScalar,
+	fromHSVScalar,
+	fromHSLScalar,
+	toHSVScalar,
+	toHSLScalar,
+	gatherScalar,
+};
+
+
+//======================================================================================================================
+//  instruction set selection
+
+const char * enumString( SimdLevel level ) noexcept
+{
+	switch (level)
+	{
+		case SimdLevel::Scalar:  return "Scalar";
+		case SimdLevel::SSE2:    return "SSE2";
+		case SimdLevel::AVX2:    return "AVX2";
+		case SimdLevel::NEON:    return "NEON";
+		default:                 return "<invalid>";
+	}
+}
+
+static const ColorKernels * kernelsFor( SimdLevel level ) noexcept
+{
+	switch (level)
+	{
+		case SimdLevel::Scalar:  return &scalarColorKernels;
+		case SimdLevel::SSE2:    return sse2ColorKernels();
+		case SimdLevel::AVX2:    return avx2ColorKernels();
+		case SimdLevel::NEON:    return neonColorKernels();
+		default:                 return nullptr;
+	}
+}
+
+static std::atomic< const ColorKernels * > selectedKernels( nullptr );
+
+static const ColorKernels & kernels() noexcept
+{
+	const ColorKernels * current = selectedKernels.load( std::memory_order_acquire );
+	if (current)
+	{
+		return *current;
+	}
+
+	const ColorKernels * best = &scalarColorKernels;
+	for (SimdLevel level : { SimdLevel::NEON, SimdLevel::SSE2, SimdLevel::AVX2 })  // from the worst to the best
+	{
+		if (const ColorKernels * supported = kernelsFor( level ))
+			best = supported;
+	}
+
+	// don't override a selection made by setSimdLevel() in the meantime
+	if (!selectedKernels.compare_exchange_strong( current, best, std::memory_order_acq_rel ))
+	{
+		return *current;
+	}
+	return *best;
+}
+
+SimdLevel activeSimdLevel() noexcept
+{
+	return kernels().level;
+}
+
+bool setSimdLevel( SimdLevel level ) noexcept
+{
+	const ColorKernels * requested = kernelsFor( level );
+	if (!requested)
+	{
+		return false;
+	}
+	selectedKernels.store( requested, std::memory_order_release );
+	return true;
+}
+
+
+//======================================================================================================================
+//  operations
+
+void fillColors( Color * dst, size_t count, Color color ) noexcept
+{
+	kernels().fill( dst, count, color );
+}
+
+void blendColors( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount ) noexcept
+{
+	kernels().blend( dst, from, to, count, amount );
+}
+
+void scaleColors( Color * dst, const Color * src, size_t count, uint8_t brightness ) noexcept
+{
+	kernels().scale( dst, src, count, brightness );
+}
+
+static uint16_t toFixedPointGain( float gain ) noexcept
+{
+	// the vector implementations need the products to fit into a signed 16-bit number
+	if (!(gain > 0.0f))  // also catches NaN
+		return 0;
+	if (gain >= 0x7FFF / 256.0f)
+		return 0x7FFF;
+	return uint16_t( gain * 256.0f + 0.5f );
+}
+
+void gainColors( Color * dst, const Color * src, size_t count, float redGain, float greenGain, float blueGain ) noexcept
+{
+	kernels().gain( dst, src, count, toFixedPointGain( redGain ), toFixedPointGain( greenGain ), toFixedPointGain( blueGain ) );
+}
+
+void addColors( Color * dst, const Color * src, size_t count ) noexcept
+{
+	kernels().add( dst, src, count );
+}
+
+void maxColors( Color * dst, const Color * src, size_t count ) noexcept
+{
+	kernels().max( dst, src, count );
+}
+
+void clampColors( Color * dst, const Color * src, size_t count, Color min, Color max ) noexcept
+{
+	kernels().clamp( dst, src, count, min, max );
+}
+
+
+void colorsFromHSV( Color * dst, const HSV * src, size_t count ) noexcept
+{
+	kernels().fromHSV( dst, src, count );
+}
+
+void colorsFromHSL( Color * dst, const HSL * src, size_t count ) noexcept
+{
+	kernels().fromHSL( dst, src, count );
+}
+
+void colorsToHSV( HSV * dst, const Color * src, size_t count ) noexcept
+{
+	kernels().toHSV( dst, src, count );
+}
+
+void colorsToHSL( HSL * dst, const Color * src, size_t count ) noexcept
+{
+	kernels().toHSL( dst, src, count );
+}
+
+void gatherColors( Color * dst, const Color * src, const uint32_t * indexes, size_t count ) noexcept
+{
+	kernels().gather( dst, src, indexes, count );
+}
+
+
+//======================================================================================================================
+//  GammaTable
+
+GammaTable::GammaTable( double gamma ) noexcept
+{
+	for (unsigned input = 0; input < 256; ++input)
+	{
+		double value = 255.0 * std::pow( input / 255.0, gamma ) + 0.5;
+		_values[ input ] = !(value > 0.0) ? 0 : value < 255.0 ? uint8_t( value ) : 255;  // NaN gives 0
+	}
+}
+
+void applyGamma( Color * dst, const Color * src, size_t count, const GammaTable & table ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] = makeColor( table[ src[i].r ], table[ src[i].g ], table[ src[i].b ] );
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
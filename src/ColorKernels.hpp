@@ -0,0 +1,67 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: implementations of the color buffer operations for the individual instruction sets
+//======================================================================================================================
+
+#ifndef OPENRGB_COLOR_KERNELS_INCLUDED
+#define OPENRGB_COLOR_KERNELS_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ColorBuffer.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define OPENRGB_X86_KERNELS
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+	#define OPENRGB_NEON_KERNELS
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// One implementation of all the operations that can be vectorized.
+/** The gains are in fixed point with 8 fractional bits, already limited to 0x7FFF. */
+
+struct ColorKernels
+{
+	SimdLevel level;
+	void (*fill)( Color * dst, size_t count, Color color );
+	void (*blend)( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount );
+	void (*scale)( Color * dst, const Color * src, size_t count, uint8_t brightness );
+	void (*gain)( Color * dst, const Color * src, size_t count, uint16_t redGain, uint16_t greenGain, uint16_t blueGain );
+	void (*add)( Color * dst, const Color * src, size_t count );
+	void (*max)( Color * dst, const Color * src, size_t count );
+	void (*clamp)( Color * dst, const Color * src, size_t count, Color min, Color max );
+	void (*fromHSV)( Color * dst, const HSV * src, size_t count );
+	void (*fromHSL)( Color * dst, const HSL * src, size_t count );
+	void (*toHSV)( HSV * dst, const Color * src, size_t count );
+	void (*toHSL)( HSL * dst, const Color * src, size_t count );
+	void (*gather)( Color * dst, const Color * src, const uint32_t * indexes, size_t count );
+};
+
+/// Always available, the vector implementations use it for the colors that don't fill a whole vector.
+extern const ColorKernels scalarColorKernels;
+
+// These return nullptr when the instruction set is not supported by this build or this CPU.
+const ColorKernels * sse2ColorKernels() noexcept;
+const ColorKernels * avx2ColorKernels() noexcept;
+const ColorKernels * neonColorKernels() noexcept;
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_COLOR_KERNELS_INCLUDED
@@ -0,0 +1,296 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: NEON implementation of the color buffer operations
+//======================================================================================================================
+
+#include "ColorKernels.hpp"
+
+#ifdef OPENRGB_NEON_KERNELS
+
+#include <arm_neon.h>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  NEON, 4 colors at once
+//
+//  NEON is part of every ARMv8 CPU and the 32-bit ARM builds get here only when compiled with NEON enabled,
+//  so there is nothing to detect at runtime. The vectors are always built from bytes in memory order,
+//  so that it works the same on big-endian.
+
+static inline const uint8_t * bytes( const Color * colors )  { return reinterpret_cast< const uint8_t * >( colors ); }
+static inline uint8_t * bytes( Color * colors )              { return reinterpret_cast< uint8_t * >( colors ); }
+
+/// Loads the color 4 times into a vector, with zero padding.
+static inline uint8x16_t repeatColor( Color color )
+{
+	const uint8_t repeated [16] =
+	{
+		color.r, color.g, color.b, 0,  color.r, color.g, color.b, 0,
+		color.r, color.g, color.b, 0,  color.r, color.g, color.b, 0,
+	};
+	return vld1q_u8( repeated );
+}
+
+static inline uint8x16_t paddingMask()
+{
+	return repeatColor( Color( 0xFF, 0xFF, 0xFF ) );
+}
+
+/// x / 255 rounded to the nearest, narrowed to 8 bits, the same as div255() of the scalar implementation.
+static inline uint8x8_t div255( uint16x8_t x )
+{
+	// (x + ((x + 128) >> 8) + 128) >> 8, the intermediate sum never exceeds 16 bits for x <= 255 * 255
+	return vraddhn_u16( x, vrshrq_n_u16( x, 8 ) );
+}
+
+static void fillNEON( Color * dst, size_t count, Color color )
+{
+	const uint8x16_t colors = repeatColor( color );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		vst1q_u8( bytes( dst + i ), colors );
+	}
+	scalarColorKernels.fill( dst + i, count - i, color );
+}
+
+static void blendNEON( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount )
+{
+	const uint8x16_t mask = paddingMask();
+	const uint8x8_t toWeight = vdup_n_u8( amount );
+	const uint8x8_t fromWeight = vdup_n_u8( uint8_t( 255 - amount ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t a = vld1q_u8( bytes( from + i ) );
+		uint8x16_t b = vld1q_u8( bytes( to + i ) );
+		uint16x8_t lo = vmlal_u8( vmull_u8( vget_low_u8( a ), fromWeight ), vget_low_u8( b ), toWeight );
+		uint16x8_t hi = vmlal_u8( vmull_u8( vget_high_u8( a ), fromWeight ), vget_high_u8( b ), toWeight );
+		vst1q_u8( bytes( dst + i ), vandq_u8( vcombine_u8( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.blend( dst + i, from + i, to + i, count - i, amount );
+}
+
+static void scaleNEON( Color * dst, const Color * src, size_t count, uint8_t brightness )
+{
+	const uint8x16_t mask = paddingMask();
+	const uint8x8_t factor = vdup_n_u8( brightness );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t x = vld1q_u8( bytes( src + i ) );
+		uint16x8_t lo = vmull_u8( vget_low_u8( x ), factor );
+		uint16x8_t hi = vmull_u8( vget_high_u8( x ), factor );
+		vst1q_u8( bytes( dst + i ), vandq_u8( vcombine_u8( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.scale( dst + i, src + i, count - i, brightness );
+}
+
+/// x * gain >> 8 for 8 components, saturated to 8 bits.
+static inline uint8x8_t applyGain( uint8x8_t x, uint16x8_t gains )
+{
+	uint16x8_t wide = vmovl_u8( x );
+	uint32x4_t lo = vmull_u16( vget_low_u16( wide ), vget_low_u16( gains ) );
+	uint32x4_t hi = vmull_u16( vget_high_u16( wide ), vget_high_u16( gains ) );
+	return vqmovn_u16( vcombine_u16( vqshrn_n_u32( lo, 8 ), vqshrn_n_u32( hi, 8 ) ) );
+}
+
+static void gainNEON( Color * dst, const Color * src, size_t count, uint16_t redGain, uint16_t greenGain, uint16_t blueGain )
+{
+	// zero gain for the padding takes care of clearing it
+	const uint16_t gainValues [8] = { redGain, greenGain, blueGain, 0, redGain, greenGain, blueGain, 0 };
+	const uint16x8_t gains = vld1q_u16( gainValues );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t x = vld1q_u8( bytes( src + i ) );
+		vst1q_u8( bytes( dst + i ), vcombine_u8( applyGain( vget_low_u8( x ), gains ), applyGain( vget_high_u8( x ), gains ) ) );
+	}
+	scalarColorKernels.gain( dst + i, src + i, count - i, redGain, greenGain, blueGain );
+}
+
+static void addNEON( Color * dst, const Color * src, size_t count )
+{
+	const uint8x16_t mask = paddingMask();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t sum = vqaddq_u8( vld1q_u8( bytes( dst + i ) ), vld1q_u8( bytes( src + i ) ) );
+		vst1q_u8( bytes( dst + i ), vandq_u8( sum, mask ) );
+	}
+	scalarColorKernels.add( dst + i, src + i, count - i );
+}
+
+static void maxNEON( Color * dst, const Color * src, size_t count )
+{
+	const uint8x16_t mask = paddingMask();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t higher = vmaxq_u8( vld1q_u8( bytes( dst + i ) ), vld1q_u8( bytes( src + i ) ) );
+		vst1q_u8( bytes( dst + i ), vandq_u8( higher, mask ) );
+	}
+	scalarColorKernels.max( dst + i, src + i, count - i );
+}
+
+static void clampNEON( Color * dst, const Color * src, size_t count, Color min, Color max )
+{
+	const uint8x16_t lower = repeatColor( min );
+	const uint8x16_t upper = repeatColor( max );  // its zero padding clears the padding
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		vst1q_u8( bytes( dst + i ), vminq_u8( vmaxq_u8( vld1q_u8( bytes( src + i ) ), lower ), upper ) );
+	}
+	scalarColorKernels.clamp( dst + i, src + i, count - i, min, max );
+}
+
+/// The same as hueToColor() for 8 colors in 16-bit lanes, returns them as planes of components.
+static inline void hueToPlanes( uint16x8_t hue, uint16x8_t max, uint16x8_t min, uint16x8_t chroma, uint8x8_t & r, uint8x8_t & g, uint8x8_t & b )
+{
+	uint32x4_t scaledLo = vmull_n_u16( vget_low_u16( hue ), 6 );
+	uint32x4_t scaledHi = vmull_n_u16( vget_high_u16( hue ), 6 );
+	uint16x8_t sector = vcombine_u16( vshrn_n_u32( scaledLo, 16 ), vshrn_n_u32( scaledHi, 16 ) );
+	uint16x8_t progress = vandq_u16( vcombine_u16( vshrn_n_u32( scaledLo, 8 ), vshrn_n_u32( scaledHi, 8 ) ), vdupq_n_u16( 0xFF ) );
+	uint16x8_t rise = vaddw_u8( min, div255( vmulq_u16( chroma, progress ) ) );
+	uint16x8_t fall = vaddw_u8( min, div255( vmulq_u16( chroma, vsubq_u16( vdupq_n_u16( 255 ), progress ) ) ) );
+
+	uint16x8_t in0 = vceqq_u16( sector, vdupq_n_u16( 0 ) );
+	uint16x8_t in1 = vceqq_u16( sector, vdupq_n_u16( 1 ) );
+	uint16x8_t in2 = vceqq_u16( sector, vdupq_n_u16( 2 ) );
+	uint16x8_t in3 = vceqq_u16( sector, vdupq_n_u16( 3 ) );
+	uint16x8_t in4 = vceqq_u16( sector, vdupq_n_u16( 4 ) );
+	uint16x8_t in5 = vceqq_u16( sector, vdupq_n_u16( 5 ) );
+
+	r = vmovn_u16( vbslq_u16( vorrq_u16( in0, in5 ), max, vbslq_u16( in1, fall, vbslq_u16( in4, rise, min ) ) ) );
+	g = vmovn_u16( vbslq_u16( vorrq_u16( in1, in2 ), max, vbslq_u16( in0, rise, vbslq_u16( in3, fall, min ) ) ) );
+	b = vmovn_u16( vbslq_u16( vorrq_u16( in3, in4 ), max, vbslq_u16( in2, rise, vbslq_u16( in5, fall, min ) ) ) );
+}
+
+static inline uint16x8_t joinHue( uint8x8_t lowBytes, uint8x8_t highBytes )
+{
+	return vorrq_u16( vmovl_u8( lowBytes ), vshlq_n_u16( vmovl_u8( highBytes ), 8 ) );
+}
+
+static inline void hsvToPlanes( uint8x8_t hueLow, uint8x8_t hueHigh, uint8x8_t saturation, uint8x8_t value,
+                                uint8x8_t & r, uint8x8_t & g, uint8x8_t & b )
+{
+	uint16x8_t max = vmovl_u8( value );
+	uint16x8_t chroma = vmovl_u8( div255( vmull_u8( value, saturation ) ) );
+	hueToPlanes( joinHue( hueLow, hueHigh ), max, vsubq_u16( max, chroma ), chroma, r, g, b );
+}
+
+static inline void hslToPlanes( uint8x8_t hueLow, uint8x8_t hueHigh, uint8x8_t saturation, uint8x8_t lightness,
+                                uint8x8_t & r, uint8x8_t & g, uint8x8_t & b )
+{
+	uint16x8_t doubleLightness = vshll_n_u8( lightness, 1 );
+	uint16x8_t range = vminq_u16( doubleLightness, vsubq_u16( vdupq_n_u16( 510 ), doubleLightness ) );
+	uint16x8_t chroma = vmovl_u8( div255( vmulq_u16( range, vmovl_u8( saturation ) ) ) );
+	uint16x8_t min = vsubq_u16( vmovl_u8( lightness ), vshrq_n_u16( chroma, 1 ) );
+	hueToPlanes( joinHue( hueLow, hueHigh ), vaddq_u16( min, chroma ), min, chroma, r, g, b );
+}
+
+// vld4 splits the 16-bit hue into its bytes in memory order, which is correct only on little-endian
+#ifndef __ARM_BIG_ENDIAN
+
+static void fromHSVNEON( Color * dst, const HSV * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t hsv = vld4q_u8( reinterpret_cast< const uint8_t * >( src + i ) );
+		uint8x8_t r [2], g [2], b [2];
+		hsvToPlanes( vget_low_u8( hsv.val[0] ), vget_low_u8( hsv.val[1] ), vget_low_u8( hsv.val[2] ), vget_low_u8( hsv.val[3] ), r[0], g[0], b[0] );
+		hsvToPlanes( vget_high_u8( hsv.val[0] ), vget_high_u8( hsv.val[1] ), vget_high_u8( hsv.val[2] ), vget_high_u8( hsv.val[3] ), r[1], g[1], b[1] );
+		uint8x16x4_t rgb;
+		rgb.val[0] = vcombine_u8( r[0], r[1] );
+		rgb.val[1] = vcombine_u8( g[0], g[1] );
+		rgb.val[2] = vcombine_u8( b[0], b[1] );
+		rgb.val[3] = vdupq_n_u8( 0 );
+		vst4q_u8( bytes( dst + i ), rgb );
+	}
+	scalarColorKernels.fromHSV( dst + i, src + i, count - i );
+}
+
+static void fromHSLNEON( Color * dst, const HSL * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		uint8x16x4_t hsl = vld4q_u8( reinterpret_cast< const uint8_t * >( src + i ) );
+		uint8x8_t r [2], g [2], b [2];
+		hslToPlanes( vget_low_u8( hsl.val[0] ), vget_low_u8( hsl.val[1] ), vget_low_u8( hsl.val[2] ), vget_low_u8( hsl.val[3] ), r[0], g[0], b[0] );
+		hslToPlanes( vget_high_u8( hsl.val[0] ), vget_high_u8( hsl.val[1] ), vget_high_u8( hsl.val[2] ), vget_high_u8( hsl.val[3] ), r[1], g[1], b[1] );
+		uint8x16x4_t rgb;
+		rgb.val[0] = vcombine_u8( r[0], r[1] );
+		rgb.val[1] = vcombine_u8( g[0], g[1] );
+		rgb.val[2] = vcombine_u8( b[0], b[1] );
+		rgb.val[3] = vdupq_n_u8( 0 );
+		vst4q_u8( bytes( dst + i ), rgb );
+	}
+	scalarColorKernels.fromHSL( dst + i, src + i, count - i );
+}
+
+#else
+
+static void fromHSVNEON( Color * dst, const HSV * src, size_t count )  { scalarColorKernels.fromHSV( dst, src, count ); }
+static void fromHSLNEON( Color * dst, const HSL * src, size_t count )  { scalarColorKernels.fromHSL( dst, src, count ); }
+
+#endif // __ARM_BIG_ENDIAN
+
+// NEON has no table lookups of 32-bit values, which the conversions to HSV and HSL need instead of a division,
+// they could be loaded one by one like on SSE2, but that can't be tested without an ARM machine yet
+static void toHSVNEON( HSV * dst, const Color * src, size_t count )  { scalarColorKernels.toHSV( dst, src, count ); }
+static void toHSLNEON( HSL * dst, const Color * src, size_t count )  { scalarColorKernels.toHSL( dst, src, count ); }
+
+// and no gather instructions either
+static void gatherNEON( Color * dst, const Color * src, const uint32_t * indexes, size_t count )
+{
+	scalarColorKernels.gather( dst, src, indexes, count );
+}
+
+static const ColorKernels neonKernels =
+{
+	SimdLevel::NEON,
+	fillNEON,
+	blendNEON,
+	scaleNEON,
+	gainNEON,
+	addNEON,
+	maxNEON,
+	clampNEON,
+	fromHSVNEON,
+	fromHSLNEON,
+	toHSVNEON,
+	toHSLNEON,
+	gatherNEON,
+};
+
+const ColorKernels * neonColorKernels() noexcept
+{
+	return &neonKernels;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#else // OPENRGB_NEON_KERNELS
+
+
+namespace orgb {
+
+const ColorKernels * neonColorKernels() noexcept  { return nullptr; }
+
+} // namespace orgb
+
+
+#endif // OPENRGB_NEON_KERNELS
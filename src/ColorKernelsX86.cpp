@@ -0,0 +1,734 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: SSE2 and AVX2 implementations of the color buffer operations
+//======================================================================================================================
+
+#include "ColorKernels.hpp"
+#include "ColorModels.hpp"
+
+#ifdef OPENRGB_X86_KERNELS
+
+#include <cstring>  // memcpy
+#include <cstddef>  // offsetof
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>
+	// MSVC allows the intrinsics of any instruction set without special compiler options
+	#define TARGET_SSE2
+	#define TARGET_AVX2
+#else
+	#include <immintrin.h>
+	// The library is compiled for the baseline CPU, only these functions may use the newer instructions,
+	// and only after checking that the CPU has them.
+	#define TARGET_SSE2 __attribute__(( target("sse2") ))
+	#define TARGET_AVX2 __attribute__(( target("avx2") ))
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  CPU detection
+
+#if defined(_MSC_VER) && !defined(__clang__)
+
+static bool cpuHasSSE2() noexcept
+{
+	int info [4];
+	__cpuid( info, 1 );
+	return (info[3] & (1 << 26)) != 0;
+}
+
+static bool cpuHasAVX2() noexcept
+{
+	int info [4];
+	__cpuid( info, 0 );
+	if (info[0] < 7)
+		return false;
+
+	// the OS must also save the upper halves of the registers on context switch
+	__cpuid( info, 1 );
+	bool osSupportsAVX = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv( 0 ) & 6) == 6;
+	if (!osSupportsAVX)
+		return false;
+
+	__cpuidex( info, 7, 0 );
+	return (info[1] & (1 << 5)) != 0;
+}
+
+#else
+
+static bool cpuHasSSE2() noexcept
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "sse2" );
+}
+
+static bool cpuHasAVX2() noexcept
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+}
+
+#endif
+
+
+//======================================================================================================================
+//  common
+//
+//  A color loaded into a 32-bit lane is 0xPPBBGGRR, x86 is always little-endian.
+
+static inline uint32_t colorBits( Color color ) noexcept
+{
+	color.padding = 0;
+	uint32_t bits;
+	memcpy( &bits, &color, sizeof(bits) );
+	return bits;
+}
+
+static constexpr int noPadding = 0x00FFFFFF;
+
+// HSV and HSL are loaded into the same lanes as colors, as 0xVVSSHHHH and 0xLLSSHHHH
+static_assert( sizeof(HSV) == 4 && offsetof(HSV, saturation) == 2 && offsetof(HSV, value) == 3, "unexpected layout of HSV" );
+static_assert( sizeof(HSL) == 4 && offsetof(HSL, saturation) == 2 && offsetof(HSL, lightness) == 3, "unexpected layout of HSL" );
+
+
+//======================================================================================================================
+//  SSE2, 4 colors at once
+
+TARGET_SSE2 static inline __m128i load128( const Color * colors )
+{
+	return _mm_loadu_si128( reinterpret_cast< const __m128i * >( colors ) );
+}
+
+TARGET_SSE2 static inline void store128( Color * colors, __m128i value )
+{
+	_mm_storeu_si128( reinterpret_cast< __m128i * >( colors ), value );
+}
+
+/// x / 255 rounded to the nearest in each 16-bit lane, the same as div255() of the scalar implementation.
+TARGET_SSE2 static inline __m128i div255( __m128i x )
+{
+	x = _mm_add_epi16( x, _mm_set1_epi16( 128 ) );
+	return _mm_srli_epi16( _mm_add_epi16( x, _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+TARGET_SSE2 static void fillSSE2( Color * dst, size_t count, Color color )
+{
+	const __m128i colors = _mm_set1_epi32( int( colorBits( color ) ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		store128( dst + i, colors );
+	}
+	scalarColorKernels.fill( dst + i, count - i, color );
+}
+
+TARGET_SSE2 static void blendSSE2( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi32( noPadding );
+	const __m128i toWeight = _mm_set1_epi16( short( amount ) );
+	const __m128i fromWeight = _mm_set1_epi16( short( 255 - amount ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i a = load128( from + i );
+		__m128i b = load128( to + i );
+		// the weights add up to 255, so the sums fit into 16 bits
+		__m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( a, zero ), fromWeight ),
+		                            _mm_mullo_epi16( _mm_unpacklo_epi8( b, zero ), toWeight ) );
+		__m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( a, zero ), fromWeight ),
+		                            _mm_mullo_epi16( _mm_unpackhi_epi8( b, zero ), toWeight ) );
+		store128( dst + i, _mm_and_si128( _mm_packus_epi16( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.blend( dst + i, from + i, to + i, count - i, amount );
+}
+
+TARGET_SSE2 static void scaleSSE2( Color * dst, const Color * src, size_t count, uint8_t brightness )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi32( noPadding );
+	const __m128i factor = _mm_set1_epi16( short( brightness ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i x = load128( src + i );
+		__m128i lo = _mm_mullo_epi16( _mm_unpacklo_epi8( x, zero ), factor );
+		__m128i hi = _mm_mullo_epi16( _mm_unpackhi_epi8( x, zero ), factor );
+		store128( dst + i, _mm_and_si128( _mm_packus_epi16( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.scale( dst + i, src + i, count - i, brightness );
+}
+
+TARGET_SSE2 static void gainSSE2( Color * dst, const Color * src, size_t count, uint16_t redGain, uint16_t greenGain, uint16_t blueGain )
+{
+	const __m128i zero = _mm_setzero_si128();
+	// zero gain for the padding takes care of clearing it
+	const __m128i gains = _mm_set_epi16( 0, short( blueGain ), short( greenGain ), short( redGain ),
+	                                     0, short( blueGain ), short( greenGain ), short( redGain ) );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i x = load128( src + i );
+		// (x << 8) * gain >> 16 == x * gain >> 8, and with the gain limited to 0x7FFF the result stays positive,
+		// so the signed saturation of the packing clamps it correctly
+		__m128i lo = _mm_mulhi_epu16( _mm_slli_epi16( _mm_unpacklo_epi8( x, zero ), 8 ), gains );
+		__m128i hi = _mm_mulhi_epu16( _mm_slli_epi16( _mm_unpackhi_epi8( x, zero ), 8 ), gains );
+		store128( dst + i, _mm_packus_epi16( lo, hi ) );
+	}
+	scalarColorKernels.gain( dst + i, src + i, count - i, redGain, greenGain, blueGain );
+}
+
+TARGET_SSE2 static void addSSE2( Color * dst, const Color * src, size_t count )
+{
+	const __m128i mask = _mm_set1_epi32( noPadding );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		store128( dst + i, _mm_and_si128( _mm_adds_epu8( load128( dst + i ), load128( src + i ) ), mask ) );
+	}
+	scalarColorKernels.add( dst + i, src + i, count - i );
+}
+
+TARGET_SSE2 static void maxSSE2( Color * dst, const Color * src, size_t count )
+{
+	const __m128i mask = _mm_set1_epi32( noPadding );
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		store128( dst + i, _mm_and_si128( _mm_max_epu8( load128( dst + i ), load128( src + i ) ), mask ) );
+	}
+	scalarColorKernels.max( dst + i, src + i, count - i );
+}
+
+TARGET_SSE2 static void clampSSE2( Color * dst, const Color * src, size_t count, Color min, Color max )
+{
+	const __m128i lower = _mm_set1_epi32( int( colorBits( min ) ) );
+	const __m128i upper = _mm_set1_epi32( int( colorBits( max ) ) );  // its zero padding clears the padding
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		store128( dst + i, _mm_min_epu8( _mm_max_epu8( load128( src + i ), lower ), upper ) );
+	}
+	scalarColorKernels.clamp( dst + i, src + i, count - i, min, max );
+}
+
+/// Splits 8 HSV or HSL values from two vectors into 16-bit lanes of the hue and the two other components.
+TARGET_SSE2 static inline void splitHueModel( const void * src, __m128i & hue, __m128i & second, __m128i & third )
+{
+	__m128i x0 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src ) );
+	__m128i x1 = _mm_loadu_si128( reinterpret_cast< const __m128i * >( src ) + 1 );
+	// the hue is sign-extended only to survive the signed saturation of the packing, its bits stay the same
+	hue = _mm_packs_epi32( _mm_srai_epi32( _mm_slli_epi32( x0, 16 ), 16 ), _mm_srai_epi32( _mm_slli_epi32( x1, 16 ), 16 ) );
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	second = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( x0, 16 ), byteMask ), _mm_and_si128( _mm_srli_epi32( x1, 16 ), byteMask ) );
+	third = _mm_packs_epi32( _mm_srli_epi32( x0, 24 ), _mm_srli_epi32( x1, 24 ) );
+}
+
+/// The same as hueToColor() for 8 colors in 16-bit lanes, stores them into dst.
+TARGET_SSE2 static inline void storeHueColors( Color * dst, __m128i hue, __m128i max, __m128i min, __m128i chroma )
+{
+	const __m128i six = _mm_set1_epi16( 6 );
+	__m128i sector = _mm_mulhi_epu16( hue, six );
+	__m128i progress = _mm_srli_epi16( _mm_mullo_epi16( hue, six ), 8 );
+	__m128i rise = _mm_add_epi16( min, div255( _mm_mullo_epi16( chroma, progress ) ) );
+	__m128i fall = _mm_add_epi16( min, div255( _mm_mullo_epi16( chroma, _mm_sub_epi16( _mm_set1_epi16( 255 ), progress ) ) ) );
+
+	__m128i in0 = _mm_cmpeq_epi16( sector, _mm_setzero_si128() );
+	__m128i in1 = _mm_cmpeq_epi16( sector, _mm_set1_epi16( 1 ) );
+	__m128i in2 = _mm_cmpeq_epi16( sector, _mm_set1_epi16( 2 ) );
+	__m128i in3 = _mm_cmpeq_epi16( sector, _mm_set1_epi16( 3 ) );
+	__m128i in4 = _mm_cmpeq_epi16( sector, _mm_set1_epi16( 4 ) );
+	__m128i in5 = _mm_cmpeq_epi16( sector, _mm_set1_epi16( 5 ) );
+
+	__m128i r = _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_or_si128( in0, in5 ), max ), _mm_and_si128( in1, fall ) ),
+	                          _mm_or_si128( _mm_and_si128( _mm_or_si128( in2, in3 ), min ), _mm_and_si128( in4, rise ) ) );
+	__m128i g = _mm_or_si128( _mm_or_si128( _mm_and_si128( in0, rise ), _mm_and_si128( _mm_or_si128( in1, in2 ), max ) ),
+	                          _mm_or_si128( _mm_and_si128( in3, fall ), _mm_and_si128( _mm_or_si128( in4, in5 ), min ) ) );
+	__m128i b = _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_or_si128( in0, in1 ), min ), _mm_and_si128( in2, rise ) ),
+	                          _mm_or_si128( _mm_and_si128( _mm_or_si128( in3, in4 ), max ), _mm_and_si128( in5, fall ) ) );
+
+	// the blue lanes have zero upper bytes, which become the padding
+	__m128i rg = _mm_or_si128( r, _mm_slli_epi16( g, 8 ) );
+	store128( dst, _mm_unpacklo_epi16( rg, b ) );
+	store128( dst + 4, _mm_unpackhi_epi16( rg, b ) );
+}
+
+TARGET_SSE2 static void fromHSVSSE2( Color * dst, const HSV * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i hue, saturation, value;
+		splitHueModel( src + i, hue, saturation, value );
+		__m128i chroma = div255( _mm_mullo_epi16( value, saturation ) );
+		storeHueColors( dst + i, hue, value, _mm_sub_epi16( value, chroma ), chroma );
+	}
+	scalarColorKernels.fromHSV( dst + i, src + i, count - i );
+}
+
+TARGET_SSE2 static void fromHSLSSE2( Color * dst, const HSL * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i hue, saturation, lightness;
+		splitHueModel( src + i, hue, saturation, lightness );
+		__m128i doubleLightness = _mm_slli_epi16( lightness, 1 );
+		__m128i range = _mm_min_epi16( doubleLightness, _mm_sub_epi16( _mm_set1_epi16( 510 ), doubleLightness ) );
+		__m128i chroma = div255( _mm_mullo_epi16( range, saturation ) );
+		__m128i min = _mm_sub_epi16( lightness, _mm_srli_epi16( chroma, 1 ) );
+		storeHueColors( dst + i, hue, _mm_add_epi16( min, chroma ), min, chroma );
+	}
+	scalarColorKernels.fromHSL( dst + i, src + i, count - i );
+}
+
+/// Low 32 bits of the products of 32-bit lanes, SSE2 can multiply only the even lanes at once.
+TARGET_SSE2 static inline __m128i mullo32( __m128i a, __m128i b )
+{
+	__m128i even = _mm_mul_epu32( a, b );
+	__m128i odd = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+/// table[ indexes ] for 4 indexes in 32-bit lanes, SSE2 has no gather instructions, so they are loaded one by one.
+TARGET_SSE2 static inline __m128i lookup128( const uint32_t * table, __m128i indexes )
+{
+	alignas(16) uint32_t idx [4];
+	_mm_store_si128( reinterpret_cast< __m128i * >( idx ), indexes );
+	return _mm_setr_epi32( int( table[ idx[0] ] ), int( table[ idx[1] ] ), int( table[ idx[2] ] ), int( table[ idx[3] ] ) );
+}
+
+/// Components of 4 colors in 32-bit lanes, with the values that both HSV and HSL need.
+struct SplitColors128
+{
+	__m128i max, min, chroma;
+	__m128i hue;  ///< already in the lower 16 bits
+};
+
+/// The same as hueOf() for 4 colors, including the grey ones, whose reciprocal 0 makes the hue 0.
+TARGET_SSE2 static inline SplitColors128 splitColors128( const Color * src, const ColorModelReciprocals & reciprocals )
+{
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	__m128i x = load128( src );
+	__m128i r = _mm_and_si128( x, byteMask );
+	__m128i g = _mm_and_si128( _mm_srli_epi32( x, 8 ), byteMask );
+	__m128i b = _mm_and_si128( _mm_srli_epi32( x, 16 ), byteMask );
+
+	// the components fit into bytes, so the byte operations do what SSE2 lacks for 32-bit lanes
+	SplitColors128 split;
+	split.max = _mm_max_epu8( r, _mm_max_epu8( g, b ) );
+	split.min = _mm_min_epu8( r, _mm_min_epu8( g, b ) );
+	split.chroma = _mm_sub_epi32( split.max, split.min );
+
+	__m128i doubleChroma = _mm_add_epi32( split.chroma, split.chroma );
+	__m128i fromRed = _mm_sub_epi32( g, b );
+	__m128i fromGreen = _mm_add_epi32( doubleChroma, _mm_sub_epi32( b, r ) );
+	__m128i fromBlue = _mm_add_epi32( _mm_add_epi32( doubleChroma, doubleChroma ), _mm_sub_epi32( r, g ) );
+	// the same priority as in hueOf(), red wins over green and green over blue
+	__m128i isRed = _mm_cmpeq_epi32( split.max, r );
+	__m128i isGreen = _mm_andnot_si128( isRed, _mm_cmpeq_epi32( split.max, g ) );
+	__m128i isBlue = _mm_andnot_si128( _mm_or_si128( isRed, isGreen ), _mm_set1_epi32( -1 ) );
+	__m128i position = _mm_or_si128( _mm_or_si128( _mm_and_si128( isRed, fromRed ), _mm_and_si128( isGreen, fromGreen ) ),
+	                                 _mm_and_si128( isBlue, fromBlue ) );
+	__m128i fullCircle = _mm_add_epi32( doubleChroma, _mm_add_epi32( doubleChroma, doubleChroma ) );
+	position = _mm_add_epi32( position, _mm_and_si128( fullCircle, _mm_srai_epi32( position, 31 ) ) );
+
+	__m128i hueReciprocal = lookup128( reciprocals.hue, split.chroma );
+	__m128i hue = _mm_srli_epi32( _mm_add_epi32( mullo32( position, hueReciprocal ), _mm_set1_epi32( 0x4000 ) ), 15 );
+	split.hue = _mm_and_si128( hue, _mm_set1_epi32( 0xFFFF ) );
+	return split;
+}
+
+/// The same as saturationOf() for 4 colors, the divisors are at most 255.
+TARGET_SSE2 static inline __m128i saturationOf( __m128i chroma, __m128i divisor, const ColorModelReciprocals & reciprocals )
+{
+	__m128i reciprocal = lookup128( reciprocals.saturation, divisor );
+	return _mm_srli_epi32( _mm_add_epi32( mullo32( chroma, reciprocal ), _mm_set1_epi32( 0x8000 ) ), 16 );
+}
+
+TARGET_SSE2 static void toHSVSSE2( HSV * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		SplitColors128 split = splitColors128( src + i, reciprocals );
+		__m128i saturation = saturationOf( split.chroma, split.max, reciprocals );
+		__m128i hsv = _mm_or_si128( split.hue, _mm_or_si128( _mm_slli_epi32( saturation, 16 ), _mm_slli_epi32( split.max, 24 ) ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), hsv );
+	}
+	scalarColorKernels.toHSV( dst + i, src + i, count - i );
+}
+
+TARGET_SSE2 static void toHSLSSE2( HSL * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		SplitColors128 split = splitColors128( src + i, reciprocals );
+		__m128i sum = _mm_add_epi32( split.max, split.min );
+		__m128i lightness = _mm_srli_epi32( _mm_add_epi32( sum, _mm_set1_epi32( 1 ) ), 1 );
+		__m128i range = _mm_sub_epi32( _mm_set1_epi32( 510 ), sum );
+		// both are at most 510, so the signed 16-bit minimum works in the lower halves of the lanes
+		range = _mm_min_epi16( sum, range );
+		__m128i saturation = saturationOf( split.chroma, range, reciprocals );
+		__m128i hsl = _mm_or_si128( split.hue, _mm_or_si128( _mm_slli_epi32( saturation, 16 ), _mm_slli_epi32( lightness, 24 ) ) );
+		_mm_storeu_si128( reinterpret_cast< __m128i * >( dst + i ), hsl );
+	}
+	scalarColorKernels.toHSL( dst + i, src + i, count - i );
+}
+
+// neither does it have any gather instructions
+static void gatherSSE2( Color * dst, const Color * src, const uint32_t * indexes, size_t count )
+{
+	scalarColorKernels.gather( dst, src, indexes, count );
+}
+
+static const ColorKernels sse2Kernels =
+{
+	SimdLevel::SSE2,
+	fillSSE2,
+	blendSSE2,
+	scaleSSE2,
+	gainSSE2,
+	addSSE2,
+	maxSSE2,
+	clampSSE2,
+	fromHSVSSE2,
+	fromHSLSSE2,
+	toHSVSSE2,
+	toHSLSSE2,
+	gatherSSE2,
+};
+
+const ColorKernels * sse2ColorKernels() noexcept
+{
+	static const bool supported = cpuHasSSE2();
+	return supported ? &sse2Kernels : nullptr;
+}
+
+
+//======================================================================================================================
+//  AVX2, 8 colors at once
+//
+//  The unpacking and packing work within the 128-bit halves, so together they keep the colors in place
+//  just like in SSE2.
+
+TARGET_AVX2 static inline __m256i load256( const Color * colors )
+{
+	return _mm256_loadu_si256( reinterpret_cast< const __m256i * >( colors ) );
+}
+
+TARGET_AVX2 static inline void store256( Color * colors, __m256i value )
+{
+	_mm256_storeu_si256( reinterpret_cast< __m256i * >( colors ), value );
+}
+
+TARGET_AVX2 static inline __m256i div255( __m256i x )
+{
+	x = _mm256_add_epi16( x, _mm256_set1_epi16( 128 ) );
+	return _mm256_srli_epi16( _mm256_add_epi16( x, _mm256_srli_epi16( x, 8 ) ), 8 );
+}
+
+TARGET_AVX2 static void fillAVX2( Color * dst, size_t count, Color color )
+{
+	const __m256i colors = _mm256_set1_epi32( int( colorBits( color ) ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		store256( dst + i, colors );
+	}
+	scalarColorKernels.fill( dst + i, count - i, color );
+}
+
+TARGET_AVX2 static void blendAVX2( Color * dst, const Color * from, const Color * to, size_t count, uint8_t amount )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i mask = _mm256_set1_epi32( noPadding );
+	const __m256i toWeight = _mm256_set1_epi16( short( amount ) );
+	const __m256i fromWeight = _mm256_set1_epi16( short( 255 - amount ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i a = load256( from + i );
+		__m256i b = load256( to + i );
+		__m256i lo = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( a, zero ), fromWeight ),
+		                               _mm256_mullo_epi16( _mm256_unpacklo_epi8( b, zero ), toWeight ) );
+		__m256i hi = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( a, zero ), fromWeight ),
+		                               _mm256_mullo_epi16( _mm256_unpackhi_epi8( b, zero ), toWeight ) );
+		store256( dst + i, _mm256_and_si256( _mm256_packus_epi16( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.blend( dst + i, from + i, to + i, count - i, amount );
+}
+
+TARGET_AVX2 static void scaleAVX2( Color * dst, const Color * src, size_t count, uint8_t brightness )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i mask = _mm256_set1_epi32( noPadding );
+	const __m256i factor = _mm256_set1_epi16( short( brightness ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i x = load256( src + i );
+		__m256i lo = _mm256_mullo_epi16( _mm256_unpacklo_epi8( x, zero ), factor );
+		__m256i hi = _mm256_mullo_epi16( _mm256_unpackhi_epi8( x, zero ), factor );
+		store256( dst + i, _mm256_and_si256( _mm256_packus_epi16( div255( lo ), div255( hi ) ), mask ) );
+	}
+	scalarColorKernels.scale( dst + i, src + i, count - i, brightness );
+}
+
+TARGET_AVX2 static void gainAVX2( Color * dst, const Color * src, size_t count, uint16_t redGain, uint16_t greenGain, uint16_t blueGain )
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i gains = _mm256_set_epi16( 0, short( blueGain ), short( greenGain ), short( redGain ),
+	                                        0, short( blueGain ), short( greenGain ), short( redGain ),
+	                                        0, short( blueGain ), short( greenGain ), short( redGain ),
+	                                        0, short( blueGain ), short( greenGain ), short( redGain ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i x = load256( src + i );
+		__m256i lo = _mm256_mulhi_epu16( _mm256_slli_epi16( _mm256_unpacklo_epi8( x, zero ), 8 ), gains );
+		__m256i hi = _mm256_mulhi_epu16( _mm256_slli_epi16( _mm256_unpackhi_epi8( x, zero ), 8 ), gains );
+		store256( dst + i, _mm256_packus_epi16( lo, hi ) );
+	}
+	scalarColorKernels.gain( dst + i, src + i, count - i, redGain, greenGain, blueGain );
+}
+
+TARGET_AVX2 static void addAVX2( Color * dst, const Color * src, size_t count )
+{
+	const __m256i mask = _mm256_set1_epi32( noPadding );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		store256( dst + i, _mm256_and_si256( _mm256_adds_epu8( load256( dst + i ), load256( src + i ) ), mask ) );
+	}
+	scalarColorKernels.add( dst + i, src + i, count - i );
+}
+
+TARGET_AVX2 static void maxAVX2( Color * dst, const Color * src, size_t count )
+{
+	const __m256i mask = _mm256_set1_epi32( noPadding );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		store256( dst + i, _mm256_and_si256( _mm256_max_epu8( load256( dst + i ), load256( src + i ) ), mask ) );
+	}
+	scalarColorKernels.max( dst + i, src + i, count - i );
+}
+
+TARGET_AVX2 static void clampAVX2( Color * dst, const Color * src, size_t count, Color min, Color max )
+{
+	const __m256i lower = _mm256_set1_epi32( int( colorBits( min ) ) );
+	const __m256i upper = _mm256_set1_epi32( int( colorBits( max ) ) );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		store256( dst + i, _mm256_min_epu8( _mm256_max_epu8( load256( src + i ), lower ), upper ) );
+	}
+	scalarColorKernels.clamp( dst + i, src + i, count - i, min, max );
+}
+
+TARGET_AVX2 static inline void splitHueModel( const void * src, __m256i & hue, __m256i & second, __m256i & third )
+{
+	__m256i x0 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( src ) );
+	__m256i x1 = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( src ) + 1 );
+	hue = _mm256_packs_epi32( _mm256_srai_epi32( _mm256_slli_epi32( x0, 16 ), 16 ), _mm256_srai_epi32( _mm256_slli_epi32( x1, 16 ), 16 ) );
+	const __m256i byteMask = _mm256_set1_epi32( 0xFF );
+	second = _mm256_packs_epi32( _mm256_and_si256( _mm256_srli_epi32( x0, 16 ), byteMask ), _mm256_and_si256( _mm256_srli_epi32( x1, 16 ), byteMask ) );
+	third = _mm256_packs_epi32( _mm256_srli_epi32( x0, 24 ), _mm256_srli_epi32( x1, 24 ) );
+}
+
+/// Stores 16 colors, the packing in splitHueModel() and the unpacking here mix the halves in opposite ways.
+TARGET_AVX2 static inline void storeHueColors( Color * dst, __m256i hue, __m256i max, __m256i min, __m256i chroma )
+{
+	const __m256i six = _mm256_set1_epi16( 6 );
+	__m256i sector = _mm256_mulhi_epu16( hue, six );
+	__m256i progress = _mm256_srli_epi16( _mm256_mullo_epi16( hue, six ), 8 );
+	__m256i rise = _mm256_add_epi16( min, div255( _mm256_mullo_epi16( chroma, progress ) ) );
+	__m256i fall = _mm256_add_epi16( min, div255( _mm256_mullo_epi16( chroma, _mm256_sub_epi16( _mm256_set1_epi16( 255 ), progress ) ) ) );
+
+	__m256i in0 = _mm256_cmpeq_epi16( sector, _mm256_setzero_si256() );
+	__m256i in1 = _mm256_cmpeq_epi16( sector, _mm256_set1_epi16( 1 ) );
+	__m256i in2 = _mm256_cmpeq_epi16( sector, _mm256_set1_epi16( 2 ) );
+	__m256i in3 = _mm256_cmpeq_epi16( sector, _mm256_set1_epi16( 3 ) );
+	__m256i in4 = _mm256_cmpeq_epi16( sector, _mm256_set1_epi16( 4 ) );
+	__m256i in5 = _mm256_cmpeq_epi16( sector, _mm256_set1_epi16( 5 ) );
+
+	__m256i r = _mm256_or_si256( _mm256_or_si256( _mm256_and_si256( _mm256_or_si256( in0, in5 ), max ), _mm256_and_si256( in1, fall ) ),
+	                             _mm256_or_si256( _mm256_and_si256( _mm256_or_si256( in2, in3 ), min ), _mm256_and_si256( in4, rise ) ) );
+	__m256i g = _mm256_or_si256( _mm256_or_si256( _mm256_and_si256( in0, rise ), _mm256_and_si256( _mm256_or_si256( in1, in2 ), max ) ),
+	                             _mm256_or_si256( _mm256_and_si256( in3, fall ), _mm256_and_si256( _mm256_or_si256( in4, in5 ), min ) ) );
+	__m256i b = _mm256_or_si256( _mm256_or_si256( _mm256_and_si256( _mm256_or_si256( in0, in1 ), min ), _mm256_and_si256( in2, rise ) ),
+	                             _mm256_or_si256( _mm256_and_si256( _mm256_or_si256( in3, in4 ), max ), _mm256_and_si256( in5, fall ) ) );
+
+	__m256i rg = _mm256_or_si256( r, _mm256_slli_epi16( g, 8 ) );
+	store256( dst, _mm256_unpacklo_epi16( rg, b ) );
+	store256( dst + 8, _mm256_unpackhi_epi16( rg, b ) );
+}
+
+TARGET_AVX2 static void fromHSVAVX2( Color * dst, const HSV * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i hue, saturation, value;
+		splitHueModel( src + i, hue, saturation, value );
+		__m256i chroma = div255( _mm256_mullo_epi16( value, saturation ) );
+		storeHueColors( dst + i, hue, value, _mm256_sub_epi16( value, chroma ), chroma );
+	}
+	scalarColorKernels.fromHSV( dst + i, src + i, count - i );
+}
+
+TARGET_AVX2 static void fromHSLAVX2( Color * dst, const HSL * src, size_t count )
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i hue, saturation, lightness;
+		splitHueModel( src + i, hue, saturation, lightness );
+		__m256i doubleLightness = _mm256_slli_epi16( lightness, 1 );
+		__m256i range = _mm256_min_epi16( doubleLightness, _mm256_sub_epi16( _mm256_set1_epi16( 510 ), doubleLightness ) );
+		__m256i chroma = div255( _mm256_mullo_epi16( range, saturation ) );
+		__m256i min = _mm256_sub_epi16( lightness, _mm256_srli_epi16( chroma, 1 ) );
+		storeHueColors( dst + i, hue, _mm256_add_epi16( min, chroma ), min, chroma );
+	}
+	scalarColorKernels.fromHSL( dst + i, src + i, count - i );
+}
+
+/// Components of 8 colors in 32-bit lanes, with the values that both HSV and HSL need.
+struct SplitColors
+{
+	__m256i max, min, chroma;
+	__m256i hue;  ///< already in the lower 16 bits
+};
+
+/// The same as hueOf() for 8 colors, including the grey ones, whose reciprocal 0 makes the hue 0.
+TARGET_AVX2 static inline SplitColors splitColors( const Color * src, const ColorModelReciprocals & reciprocals )
+{
+	const __m256i byteMask = _mm256_set1_epi32( 0xFF );
+	__m256i x = load256( src );
+	__m256i r = _mm256_and_si256( x, byteMask );
+	__m256i g = _mm256_and_si256( _mm256_srli_epi32( x, 8 ), byteMask );
+	__m256i b = _mm256_and_si256( _mm256_srli_epi32( x, 16 ), byteMask );
+
+	SplitColors split;
+	split.max = _mm256_max_epi32( r, _mm256_max_epi32( g, b ) );
+	split.min = _mm256_min_epi32( r, _mm256_min_epi32( g, b ) );
+	split.chroma = _mm256_sub_epi32( split.max, split.min );
+
+	__m256i doubleChroma = _mm256_add_epi32( split.chroma, split.chroma );
+	__m256i fromRed = _mm256_sub_epi32( g, b );
+	__m256i fromGreen = _mm256_add_epi32( doubleChroma, _mm256_sub_epi32( b, r ) );
+	__m256i fromBlue = _mm256_add_epi32( _mm256_add_epi32( doubleChroma, doubleChroma ), _mm256_sub_epi32( r, g ) );
+	// the same priority as in hueOf(), red wins over green and green over blue
+	__m256i position = _mm256_blendv_epi8( fromBlue, fromGreen, _mm256_cmpeq_epi32( split.max, g ) );
+	position = _mm256_blendv_epi8( position, fromRed, _mm256_cmpeq_epi32( split.max, r ) );
+	__m256i fullCircle = _mm256_add_epi32( doubleChroma, _mm256_add_epi32( doubleChroma, doubleChroma ) );
+	position = _mm256_add_epi32( position, _mm256_and_si256( fullCircle, _mm256_srai_epi32( position, 31 ) ) );
+
+	__m256i hueReciprocal = _mm256_i32gather_epi32( reinterpret_cast< const int * >( reciprocals.hue ), split.chroma, 4 );
+	__m256i hue = _mm256_srli_epi32( _mm256_add_epi32( _mm256_mullo_epi32( position, hueReciprocal ), _mm256_set1_epi32( 0x4000 ) ), 15 );
+	split.hue = _mm256_and_si256( hue, _mm256_set1_epi32( 0xFFFF ) );
+	return split;
+}
+
+/// The same as saturationOf() for 8 colors, the divisors are at most 255.
+TARGET_AVX2 static inline __m256i saturationOf( __m256i chroma, __m256i divisor, const ColorModelReciprocals & reciprocals )
+{
+	__m256i reciprocal = _mm256_i32gather_epi32( reinterpret_cast< const int * >( reciprocals.saturation ), divisor, 4 );
+	return _mm256_srli_epi32( _mm256_add_epi32( _mm256_mullo_epi32( chroma, reciprocal ), _mm256_set1_epi32( 0x8000 ) ), 16 );
+}
+
+TARGET_AVX2 static void toHSVAVX2( HSV * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		SplitColors split = splitColors( src + i, reciprocals );
+		__m256i saturation = saturationOf( split.chroma, split.max, reciprocals );
+		__m256i hsv = _mm256_or_si256( split.hue, _mm256_or_si256( _mm256_slli_epi32( saturation, 16 ), _mm256_slli_epi32( split.max, 24 ) ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), hsv );
+	}
+	scalarColorKernels.toHSV( dst + i, src + i, count - i );
+}
+
+TARGET_AVX2 static void toHSLAVX2( HSL * dst, const Color * src, size_t count )
+{
+	const ColorModelReciprocals & reciprocals = colorModelReciprocals();
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		SplitColors split = splitColors( src + i, reciprocals );
+		__m256i sum = _mm256_add_epi32( split.max, split.min );
+		__m256i lightness = _mm256_srli_epi32( _mm256_add_epi32( sum, _mm256_set1_epi32( 1 ) ), 1 );
+		__m256i range = _mm256_min_epi32( sum, _mm256_sub_epi32( _mm256_set1_epi32( 510 ), sum ) );
+		__m256i saturation = saturationOf( split.chroma, range, reciprocals );
+		__m256i hsl = _mm256_or_si256( split.hue, _mm256_or_si256( _mm256_slli_epi32( saturation, 16 ), _mm256_slli_epi32( lightness, 24 ) ) );
+		_mm256_storeu_si256( reinterpret_cast< __m256i * >( dst + i ), hsl );
+	}
+	scalarColorKernels.toHSL( dst + i, src + i, count - i );
+}
+
+TARGET_AVX2 static void gatherAVX2( Color * dst, const Color * src, const uint32_t * indexes, size_t count )
+{
+	const __m256i mask = _mm256_set1_epi32( noPadding );
+	const int * base = reinterpret_cast< const int * >( src );
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i offsets = _mm256_loadu_si256( reinterpret_cast< const __m256i * >( indexes + i ) );
+		store256( dst + i, _mm256_and_si256( _mm256_i32gather_epi32( base, offsets, 4 ), mask ) );
+	}
+	scalarColorKernels.gather( dst + i, src, indexes + i, count - i );
+}
+
+static const ColorKernels avx2Kernels =
+{
+	SimdLevel::AVX2,
+	fillAVX2,
+	blendAVX2,
+	scaleAVX2,
+	gainAVX2,
+	addAVX2,
+	maxAVX2,
+	clampAVX2,
+	fromHSVAVX2,
+	fromHSLAVX2,
+	toHSVAVX2,
+	toHSLAVX2,
+	gatherAVX2,
+};
+
+const ColorKernels * avx2ColorKernels() noexcept
+{
+	static const bool supported = cpuHasAVX2();
+	return supported ? &avx2Kernels : nullptr;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#else // OPENRGB_X86_KERNELS
+
+
+namespace orgb {
+
+const ColorKernels * sse2ColorKernels() noexcept  { return nullptr; }
+const ColorKernels * avx2ColorKernels() noexcept  { return nullptr; }
+
+} // namespace orgb
+
+
+#endif // OPENRGB_X86_KERNELS
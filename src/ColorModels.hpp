@@ -0,0 +1,149 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: integer conversions between RGB, HSV and HSL shared by Color and the color buffer operations
+//======================================================================================================================
+
+#ifndef OPENRGB_COLOR_MODELS_INCLUDED
+#define OPENRGB_COLOR_MODELS_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "OpenRGB/Color.hpp"
+
+#include <cstdint>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  These define the results, the vector implementations in ColorKernels*.cpp must match them exactly.
+
+/// x / 255 rounded to the nearest, exact for all x <= 255 * 255.
+inline uint8_t div255( uint32_t x ) noexcept
+{
+	x += 128;
+	return uint8_t( (x + (x >> 8)) >> 8 );
+}
+
+inline Color makeColor( uint8_t r, uint8_t g, uint8_t b ) noexcept
+{
+	Color color( r, g, b );
+	color.padding = 0;
+	return color;
+}
+
+/// Common part of HSV and HSL to RGB, the colors of the hue between the brightest and the darkest component.
+/** The circle is divided into 6 sectors, in each of them one component rises or falls and the other two are constant. */
+inline Color hueToColor( uint16_t hue, uint8_t max, uint8_t min, uint8_t chroma ) noexcept
+{
+	uint32_t scaledHue = uint32_t( hue ) * 6;
+	uint32_t sector = scaledHue >> 16;
+	uint32_t progress = (scaledHue >> 8) & 0xFF;
+	uint8_t rise = uint8_t( min + div255( chroma * progress ) );
+	uint8_t fall = uint8_t( min + div255( chroma * (255 - progress) ) );
+
+	switch (sector)
+	{
+		case 0:  return makeColor( max, rise, min );
+		case 1:  return makeColor( fall, max, min );
+		case 2:  return makeColor( min, max, rise );
+		case 3:  return makeColor( min, fall, max );
+		case 4:  return makeColor( rise, min, max );
+		default: return makeColor( max, min, fall );
+	}
+}
+
+inline Color hsvToColor( HSV hsv ) noexcept
+{
+	uint8_t chroma = div255( uint32_t( hsv.value ) * hsv.saturation );
+	return hueToColor( hsv.hue, hsv.value, uint8_t( hsv.value - chroma ), chroma );
+}
+
+inline Color hslToColor( HSL hsl ) noexcept
+{
+	// the chroma can be the highest in the middle of the lightness range and falls to 0 towards black and white
+	uint32_t doubleLightness = uint32_t( hsl.lightness ) * 2;
+	uint32_t range = doubleLightness < 255 ? doubleLightness : 510 - doubleLightness;
+	uint8_t chroma = div255( range * hsl.saturation );
+	uint8_t min = uint8_t( hsl.lightness - chroma / 2 );
+	return hueToColor( hsl.hue, uint8_t( min + chroma ), min, chroma );
+}
+
+/// Reciprocals that replace the divisions of the conversions to HSV and HSL, which would be the slowest part.
+struct ColorModelReciprocals
+{
+	uint32_t hue [256];         ///< 2^31 / (6 * chroma), rounded to the nearest
+	uint32_t saturation [256];  ///< 255 * 2^16 / divisor, rounded to the nearest
+};
+/// Built on the first use.
+const ColorModelReciprocals & colorModelReciprocals() noexcept;
+
+/// Hue of a color whose highest component is max and chroma = max - min is not 0.
+inline uint16_t hueOf( Color color, uint8_t max, uint32_t chroma, const ColorModelReciprocals & reciprocals ) noexcept
+{
+	// position on the circle in units where a sector is chroma long, from 0 to 6 * chroma,
+	// the sector of the highest component is selected by masks, because a branch on random colors is mispredicted often
+	int32_t fromRed   = int32_t( color.g ) - int32_t( color.b );
+	int32_t fromGreen = int32_t( 2 * chroma ) + int32_t( color.b ) - int32_t( color.r );
+	int32_t fromBlue  = int32_t( 4 * chroma ) + int32_t( color.r ) - int32_t( color.g );
+	int32_t isRed   = -int32_t( max == color.r );
+	int32_t isGreen = -int32_t( max == color.g ) & ~isRed;
+	int32_t isBlue  = ~(isRed | isGreen);
+	int32_t position = (fromRed & isRed) | (fromGreen & isGreen) | (fromBlue & isBlue);
+	position += int32_t( 6 * chroma ) & (position >> 31);  // only red can be negative, wrap it around
+
+	// position * 65536 / (6 * chroma) rounded to the nearest, the full circle becomes 0,
+	// the product stays below 2^31 + 3 * chroma because position is lower than 6 * chroma
+	return uint16_t( (uint32_t( position ) * reciprocals.hue[ chroma ] + 0x4000) >> 15 );
+}
+
+/// chroma * 255 / divisor rounded to the nearest, chroma must not be higher than divisor.
+inline uint8_t saturationOf( uint32_t chroma, uint32_t divisor, const ColorModelReciprocals & reciprocals ) noexcept
+{
+	return uint8_t( (chroma * reciprocals.saturation[ divisor ] + 0x8000) >> 16 );
+}
+
+inline HSV colorToHSV( Color color, const ColorModelReciprocals & reciprocals ) noexcept
+{
+	uint8_t max = color.r > color.g ? color.r : color.g;
+	max = max > color.b ? max : color.b;
+	uint8_t min = color.r < color.g ? color.r : color.g;
+	min = min < color.b ? min : color.b;
+	uint32_t chroma = uint32_t( max - min );
+
+	if (chroma == 0)
+		return HSV( 0, 0, max );  // grey has no hue
+
+	return HSV( hueOf( color, max, chroma, reciprocals ), saturationOf( chroma, max, reciprocals ), max );
+}
+
+inline HSL colorToHSL( Color color, const ColorModelReciprocals & reciprocals ) noexcept
+{
+	uint8_t max = color.r > color.g ? color.r : color.g;
+	max = max > color.b ? max : color.b;
+	uint8_t min = color.r < color.g ? color.r : color.g;
+	min = min < color.b ? min : color.b;
+	uint32_t chroma = uint32_t( max - min );
+	uint8_t lightness = uint8_t( (uint32_t( max ) + min + 1) / 2 );
+
+	if (chroma == 0)
+		return HSL( 0, 0, lightness );
+
+	// the highest chroma possible at this lightness, never lower than the actual chroma
+	uint32_t sum = uint32_t( max ) + min;
+	uint32_t range = sum < 255 ? sum : 510 - sum;
+	return HSL( hueOf( color, max, chroma, reciprocals ), saturationOf( chroma, range, reciprocals ), lightness );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_COLOR_MODELS_INCLUDED
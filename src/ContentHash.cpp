@@ -0,0 +1,60 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: fast non-cryptographic hash for detecting changed data
+//======================================================================================================================
+
+#include "ContentHash.hpp"
+
+#include <cstring>
+
+
+namespace orgb {
+
+
+static inline uint64_t rotateLeft( uint64_t value, unsigned bits ) noexcept
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+/// Final mixing step of MurmurHash3, spreads every input bit over the whole result.
+static inline uint64_t finalMix( uint64_t value ) noexcept
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return value;
+}
+
+uint64_t hashBytes( const uint8_t * data, size_t size ) noexcept
+{
+	const uint64_t multiplier1 = 0x87c37b91114253d5ULL;
+	const uint64_t multiplier2 = 0x4cf5ad432745937fULL;
+
+	uint64_t hash = 0x9e3779b97f4a7c15ULL ^ (uint64_t( size ) * multiplier1);
+
+	size_t pos = 0;
+	for (; pos + 8 <= size; pos += 8)
+	{
+		uint64_t word;
+		memcpy( &word, data + pos, 8 );  // compiles to a single unaligned load
+		hash ^= rotateLeft( word * multiplier1, 31 ) * multiplier2;
+		hash = rotateLeft( hash, 27 ) * 5 + 0x52dce729;
+	}
+
+	uint64_t tail = 0;
+	for (unsigned shift = 0; pos < size; ++pos, shift += 8)
+	{
+		tail |= uint64_t( data[ pos ] ) << shift;
+	}
+	hash ^= rotateLeft( tail * multiplier1, 31 ) * multiplier2;
+
+	hash = finalMix( hash );
+	return hash != 0 ? hash : 1;
+}
+
+
+} // namespace orgb
@@ -0,0 +1,31 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: fast non-cryptographic hash for detecting changed data
+//======================================================================================================================
+
+#ifndef OPENRGB_CONTENT_HASH_INCLUDED
+#define OPENRGB_CONTENT_HASH_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace orgb {
+
+
+/// Hash of a block of bytes, used to tell whether a device description has changed without comparing it whole.
+/** It processes 8 bytes per step, so it's much faster than parsing the data. It is not cryptographic and the values
+  * depend on the endianness of the host, so they must never leave the machine. Never returns 0, so that 0 can mean
+  * "unknown". */
+uint64_t hashBytes( const uint8_t * data, size_t size ) noexcept;
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_CONTENT_HASH_INCLUDED
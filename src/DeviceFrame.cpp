@@ -0,0 +1,99 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: colors of all the LEDs of a device, composed zone by zone
+//======================================================================================================================
+
+#include "OpenRGB/DeviceFrame.hpp"
+
+#include "Essential.hpp"
+
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+DeviceFrame::DeviceFrame( const Device & device ) noexcept
+:
+	_device( &device ),
+	_colors( device.colors ),
+	_dirtyZones( device.zones.size(), false ),
+	_dirtyZoneCount( 0 ),
+	_allDirty( false )
+{
+	// the server should report a color for every LED, but let's not rely on it
+	_colors.resize( device.leds.size(), Color::Black );
+}
+
+bool DeviceFrame::belongsHere( const Zone & zone ) const noexcept
+{
+	return zone.parentIdx == _device->idx
+	    && zone.idx < _dirtyZones.size()
+	    && size_t( zone.startIdx ) + zone.leds_count <= _colors.size();
+}
+
+const Color * DeviceFrame::zoneColors( const Zone & zone ) const noexcept
+{
+	return belongsHere( zone ) ? _colors.data() + zone.startIdx : nullptr;
+}
+
+Color * DeviceFrame::editColors() noexcept
+{
+	_allDirty = true;
+	return _colors.data();
+}
+
+Color * DeviceFrame::editZone( const Zone & zone ) noexcept
+{
+	if (!belongsHere( zone ))
+	{
+		return nullptr;
+	}
+	markDirty( zone );
+	return _colors.data() + zone.startIdx;
+}
+
+void DeviceFrame::setZoneColor( const Zone & zone, Color color ) noexcept
+{
+	Color * colors = editZone( zone );
+	if (colors)
+	{
+		std::fill( colors, colors + zone.leds_count, color );
+	}
+}
+
+void DeviceFrame::markDirty( const Zone & zone ) noexcept
+{
+	if (belongsHere( zone ) && !_dirtyZones[ zone.idx ])
+	{
+		_dirtyZones[ zone.idx ] = true;
+		_dirtyZoneCount++;
+	}
+}
+
+void DeviceFrame::markAllDirty() noexcept
+{
+	_allDirty = true;
+}
+
+void DeviceFrame::markClean() noexcept
+{
+	_dirtyZones.assign( _dirtyZones.size(), false );
+	_dirtyZoneCount = 0;
+	_allDirty = false;
+}
+
+bool DeviceFrame::isDirty( const Zone & zone ) const noexcept
+{
+	return belongsHere( zone ) && (_allDirty || _dirtyZones[ zone.idx ]);
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
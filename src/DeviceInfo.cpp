@@ -17,10 +17,24 @@ using own::BinaryInputStream;
 using own::unconst;
 #include "MiscUtils.hpp"
 
+#include "ContainerUtils.hpp"
+using own::make_span;
+#include "ContentHash.hpp"
+
+#include <cstring>
 #include <string>
 using std::string;
+#include <vector>
+using std::vector;
+#include <memory>
+using std::shared_ptr;
+#include <mutex>
+#include <utility>
+using std::move;
+#include <unordered_map>
 #include <sstream>
 using std::ostringstream;  // flags to string
+#include <algorithm>
 
 
 namespace orgb {
@@ -259,6 +273,7 @@ Zone::Zone()
 :
 	idx(),
 	parentIdx(),
+	startIdx(),
 	name(),
 	type(),
 	leds_min(),
@@ -308,10 +323,7 @@ void Zone::serialize( BinaryOutputStream & stream, uint32_t /*protocolVersion*/
 	{
 		stream << matrix_height;
 		stream << matrix_width;
-		for (auto val : matrix_values)
-		{
-			stream << val;
-		}
+		protocol::writeElements( stream, matrix_values.data(), matrix_values.size() );
 	}
 }
 
@@ -336,12 +348,17 @@ bool Zone::deserialize( BinaryInputStream & stream, uint32_t /*protocolVersion*/
 	{
 		stream >> unconst( matrix_height );
 		stream >> unconst( matrix_width );
-		size_t matrixSize = matrix_height * matrix_width;
-		unconst( matrix_values ).resize( matrixSize );
-		for (size_t i = 0; i < matrixSize; ++i)
+		size_t matrixSize = size_t( matrix_height ) * size_t( matrix_width );
+		// the dimensions must fit into the announced length of the block, otherwise they are garbage
+		// and we would try to allocate gigabytes for them
+		size_t valuesLength = matrix_length - std::min< size_t >( matrix_length, sizeof( matrix_height ) + sizeof( matrix_width ) );
+		if (stream.hasFailed() || matrixSize > valuesLength / sizeof( uint32_t ))
 		{
-			stream >> unconst( matrix_values )[i];
+			stream.setFailed();
+			return false;
 		}
+		unconst( matrix_values ).resize( matrixSize );
+		protocol::readElements( stream, unconst( matrix_values ).data(), matrixSize );
 	}
 
 	if (!isValidZoneType( type ))
@@ -358,6 +375,7 @@ void print( const Zone & zone, unsigned int indentLevel )
 	indent( indentLevel + 1 ); printf( "leds_min = %u;\n", zone.leds_min );
 	indent( indentLevel + 1 ); printf( "leds_max = %u;\n", zone.leds_max );
 	indent( indentLevel + 1 ); printf( "leds_count = %u;\n", zone.leds_count );
+	indent( indentLevel + 1 ); printf( "startIdx = %u;\n", zone.startIdx );
 	indent( indentLevel + 1 ); printf( "matrix_height = %u;\n", zone.matrix_height );
 	indent( indentLevel + 1 ); printf( "matrix_width = %u;\n", zone.matrix_width );
 	indent( indentLevel ); printf( "},\n" );
@@ -371,6 +389,7 @@ void print( std::ostream & os, const Zone & zone, unsigned int indentLevel )
 	indent( os, indentLevel + 1 ); os << "leds_min = "<<zone.leds_min<<";\n";
 	indent( os, indentLevel + 1 ); os << "leds_max = "<<zone.leds_max<<";\n";
 	indent( os, indentLevel + 1 ); os << "leds_count = "<<zone.leds_count<<";\n";
+	indent( os, indentLevel + 1 ); os << "startIdx = "<<zone.startIdx<<";\n";
 	indent( os, indentLevel + 1 ); os << "matrix_height = "<<zone.matrix_height<<";\n";
 	indent( os, indentLevel + 1 ); os << "matrix_width = "<<zone.matrix_width<<";\n";
 	indent( os, indentLevel ); os << "},\n";
@@ -541,6 +560,138 @@ void print( std::ostream & os, const Mode & mode, unsigned int indentLevel )
 }
 
 
+//======================================================================================================================
+//  LazyArray
+
+/// Copy of the device description, from which the lazy arrays decode their elements.
+struct LazyDeviceData
+{
+	vector< uint8_t > bytes;  ///< the device description without the data_size prefix
+	uint32_t protocolVersion;
+	uint32_t deviceIdx;
+};
+
+/// The decoding happens only once per array, so a single lock for all of them is enough.
+static std::mutex & lazyDecodingMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+template< typename Elem >
+void LazyArray< Elem >::decode() const
+{
+	std::lock_guard< std::mutex > lock( lazyDecodingMutex() );
+
+	if (_isDecoded.load( std::memory_order_relaxed ))
+	{
+		return;  // another thread was faster
+	}
+
+	// the bytes were validated when the device was received, so this can't fail
+	vector< Elem > elements;
+	Device::decodeLazily( *_source, elements );
+	_elements = move( elements );
+
+	_isDecoded.store( true, std::memory_order_release );
+}
+
+template class LazyArray< Mode >;
+template class LazyArray< LED >;
+
+
+//======================================================================================================================
+//  NameIndex
+
+static uint64_t stringKey( const char * chars, size_t length ) noexcept
+{
+	return hashBytes( reinterpret_cast< const uint8_t * >( chars ), length );
+}
+
+static bool equals( const string & str, const char * chars, size_t length ) noexcept
+{
+	return str.size() == length && memcmp( str.data(), chars, length ) == 0;
+}
+
+/// Each table is built only once, so a single lock for all of them is enough.
+static std::mutex & nameIndexMutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+template< typename Elems >
+void NameIndex::build( const Elems & elems ) const
+{
+	std::lock_guard< std::mutex > lock( nameIndexMutex() );
+
+	if (_isBuilt.load( std::memory_order_relaxed ))
+	{
+		return;  // another thread was faster
+	}
+
+	// at most half full, so that the probe sequences stay short
+	size_t capacity = 4;
+	while (capacity < 2 * elems.size())
+		capacity *= 2;
+	const size_t mask = capacity - 1;
+
+	vector< Slot > slots( capacity, Slot{ 0, 0 } );
+	for (size_t elemIdx = 0; elemIdx < elems.size(); ++elemIdx)
+	{
+		const string & name = elems[ elemIdx ].name;
+		uint64_t hash = stringKey( name.data(), name.size() );
+		uint32_t hashTop = uint32_t( hash >> 32 );
+
+		// the names are not guaranteed to be unique, only the first one goes in, as a linear search would find it
+		size_t pos = size_t( hash ) & mask;
+		bool isDuplicate = false;
+		while (slots[ pos ].elemIdx != 0 && !isDuplicate)
+		{
+			isDuplicate = slots[ pos ].hash == hashTop && elems[ slots[ pos ].elemIdx - 1 ].name == name;
+			pos = (pos + 1) & mask;
+		}
+		if (!isDuplicate)
+		{
+			slots[ pos ] = Slot{ hashTop, uint32_t( elemIdx + 1 ) };
+		}
+	}
+	_slots = move( slots );
+
+	_isBuilt.store( true, std::memory_order_release );
+}
+
+template< typename Elems >
+size_t NameIndex::find( const Elems & elems, const char * name, size_t length ) const noexcept
+{
+	if (!_isBuilt.load( std::memory_order_acquire ))
+	{
+		try {
+			build( elems );
+		} catch (...) {
+			// without memory for the table we can still search the old way
+			for (size_t elemIdx = 0; elemIdx < elems.size(); ++elemIdx)
+				if (equals( elems[ elemIdx ].name, name, length ))
+					return elemIdx;
+			return notFound;
+		}
+	}
+
+	uint64_t hash = stringKey( name, length );
+	uint32_t hashTop = uint32_t( hash >> 32 );
+	const size_t mask = _slots.size() - 1;
+	for (size_t pos = size_t( hash ) & mask; _slots[ pos ].elemIdx != 0; pos = (pos + 1) & mask)
+	{
+		const Slot & slot = _slots[ pos ];
+		if (slot.hash == hashTop && equals( elems[ slot.elemIdx - 1 ].name, name, length ))
+		{
+			return slot.elemIdx - 1;
+		}
+	}
+	return notFound;
+}
+
+
 //======================================================================================================================
 //  Device
 
@@ -558,7 +709,10 @@ Device::Device()
 	modes(),
 	zones(),
 	leds(),
-	colors()
+	colors(),
+	_modeIndex(),
+	_zoneIndex(),
+	_ledIndex()
 {}
 
 size_t Device::calcSize( uint32_t protocolVersion ) const noexcept
@@ -574,9 +728,9 @@ size_t Device::calcSize( uint32_t protocolVersion ) const noexcept
 	size += protocol::sizeofString( location );
 
 	size += sizeof( active_mode );
-	size += protocol::sizeofArray( modes, protocolVersion );
+	size += protocol::sizeofArray( modes.elements(), protocolVersion );
 	size += protocol::sizeofArray( zones, protocolVersion );
-	size += protocol::sizeofArray( leds, protocolVersion );
+	size += protocol::sizeofArray( leds.elements(), protocolVersion );
 	size += protocol::sizeofArray( colors );
 
 	return size;
@@ -599,18 +753,12 @@ void Device::serialize( BinaryOutputStream & stream, uint32_t protocolVersion )
 		mode.serialize( stream, protocolVersion );
 	}
 	protocol::writeArray( stream, zones, protocolVersion );
-	protocol::writeArray( stream, leds, protocolVersion );
+	protocol::writeArray( stream, leds.elements(), protocolVersion );
 	protocol::writeArray( stream, colors );
 }
 
-bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept
+uint16_t Device::deserializeHeader( BinaryInputStream & stream ) noexcept
 {
-	// This hack with const casts allows us to restrict the user from changing attributes that are a static description
-	// and allow him to change only the parameters that are meant to be changed.
-
-	// fill in our metadata
-	unconst( idx ) = deviceIdx;
-
 	stream >> unconst( type );
 	protocol::readString( stream, unconst( name ) );
 	protocol::readString( stream, unconst( vendor ) );
@@ -619,19 +767,51 @@ bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion,
 	protocol::readString( stream, unconst( serial ) );
 	protocol::readString( stream, unconst( location ) );
 
-	uint16_t num_modes;
+	uint16_t num_modes = 0;
 	stream >> num_modes;  // the size is not directly before the array, so it must be read manually
 	stream >> unconst( active_mode );
-	unconst( modes ).reserve( num_modes );
+	return num_modes;
+}
+
+void Device::computeZoneOffsets() noexcept
+{
+	uint32_t startIdx = 0;
+	for (const Zone & zone : zones)
+	{
+		unconst( zone.startIdx ) = startIdx;
+		startIdx += zone.leds_count;
+	}
+}
+
+bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept
+{
+	// This hack with const casts allows us to restrict the user from changing attributes that are a static description
+	// and allow him to change only the parameters that are meant to be changed.
+
+	// fill in our metadata
+	unconst( idx ) = deviceIdx;
+	resetNameIndexes();
+
+	uint16_t num_modes = deserializeHeader( stream );
+
+	vector< Mode > newModes;
+	newModes.reserve( num_modes );
 	for (uint32_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
 	{
-		Mode mode;
-		if (!mode.deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
+		// deserialize in place, moving a Mode would copy all its const members
+		newModes.push_back( Mode() );
+		if (!newModes.back().deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
 			return false;
-		unconst( modes ).emplace_back( move(mode) );
 	}
+	unconst( modes ).assign( move( newModes ) );
+
 	protocol::readArray( stream, unconst( zones ), protocolVersion, deviceIdx );
-	protocol::readArray( stream, unconst( leds ), protocolVersion, deviceIdx );
+	computeZoneOffsets();
+
+	vector< LED > newLeds;
+	protocol::readArray( stream, newLeds, protocolVersion, deviceIdx );
+	unconst( leds ).assign( move( newLeds ) );
+
 	protocol::readArray( stream, unconst( colors ) );
 
 	// Let's tolerate invalid device classes in case the server adds some without increasing protocol version
@@ -641,6 +821,239 @@ bool Device::deserialize( BinaryInputStream & stream, uint32_t protocolVersion,
 	return !stream.hasFailed();
 }
 
+bool Device::deserializeLazily( const uint8_t * data, size_t size, uint32_t protocolVersion, uint32_t deviceIdx ) noexcept
+{
+	unconst( idx ) = deviceIdx;
+	resetNameIndexes();
+
+	shared_ptr< LazyDeviceData > source = std::make_shared< LazyDeviceData >();
+	source->bytes.assign( data, data + size );
+	source->protocolVersion = protocolVersion;
+	source->deviceIdx = deviceIdx;
+
+	BinaryInputStream stream( make_span( source->bytes ) );
+
+	uint16_t num_modes = deserializeHeader( stream );
+
+	// The skipped parts still have to be validated now, the decoding later has no way to report an error.
+	// A single object is reused for all of them, so its strings and vectors are allocated only a few times.
+	Mode scratchMode;
+	for (uint32_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
+	{
+		if (!scratchMode.deserialize( stream, protocolVersion, modeIdx, deviceIdx ))
+			return false;
+	}
+
+	protocol::readArray( stream, unconst( zones ), protocolVersion, deviceIdx );
+	computeZoneOffsets();
+
+	// LEDs have nothing to validate except their size
+	uint16_t num_leds = 0;
+	stream >> num_leds;
+	for (uint32_t ledIdx = 0; ledIdx < num_leds; ++ledIdx)
+	{
+		protocol::skipString( stream );  // name
+		stream.skip( sizeof( LED::value ) );
+	}
+
+	protocol::readArray( stream, unconst( colors ) );
+
+	if (stream.hasFailed())
+		return false;
+
+	unconst( modes ).assignLazy( source, num_modes );
+	unconst( leds ).assignLazy( source, num_leds );
+	return true;
+}
+
+void Device::decodeLazily( const LazyDeviceData & source, vector< Mode > & modes )
+{
+	BinaryInputStream stream( make_span( source.bytes ) );
+
+	Device header;
+	uint16_t num_modes = header.deserializeHeader( stream );
+
+	modes.reserve( num_modes );
+	for (uint32_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
+	{
+		modes.push_back( Mode() );
+		modes.back().deserialize( stream, source.protocolVersion, modeIdx, source.deviceIdx );
+	}
+}
+
+void Device::decodeLazily( const LazyDeviceData & source, vector< LED > & leds )
+{
+	BinaryInputStream stream( make_span( source.bytes ) );
+
+	// the LEDs are at the end, so everything before them has to be walked through again
+	Device header;
+	uint16_t num_modes = header.deserializeHeader( stream );
+	Mode scratchMode;
+	for (uint32_t modeIdx = 0; modeIdx < num_modes; ++modeIdx)
+	{
+		scratchMode.deserialize( stream, source.protocolVersion, modeIdx, source.deviceIdx );
+	}
+	vector< Zone > scratchZones;
+	protocol::readArray( stream, scratchZones, source.protocolVersion, source.deviceIdx );
+
+	protocol::readArray( stream, leds, source.protocolVersion, source.deviceIdx );
+}
+
+const Mode * Device::findModeByName( const char * name, size_t length ) const noexcept
+{
+	size_t modeIdx = _modeIndex.find( modes, name, length );
+	return modeIdx != NameIndex::notFound ? &modes[ modeIdx ] : nullptr;
+}
+
+const Zone * Device::findZoneByName( const char * name, size_t length ) const noexcept
+{
+	size_t zoneIdx = _zoneIndex.find( zones, name, length );
+	return zoneIdx != NameIndex::notFound ? &zones[ zoneIdx ] : nullptr;
+}
+
+const LED * Device::findLEDByName( const char * name, size_t length ) const noexcept
+{
+	size_t ledIdx = _ledIndex.find( leds, name, length );
+	return ledIdx != NameIndex::notFound ? &leds[ ledIdx ] : nullptr;
+}
+
+
+
+//======================================================================================================================
+//  DeviceList
+
+static void addToIndex( std::unordered_map< uint64_t, vector< uint32_t > > & index, uint64_t key, uint32_t deviceIdx )
+{
+	// the indexes must stay in ascending order, so that the lookups find the first device like a linear scan would
+	vector< uint32_t > & deviceIndexes = index[ key ];
+	deviceIndexes.insert( std::lower_bound( deviceIndexes.begin(), deviceIndexes.end(), deviceIdx ), deviceIdx );
+}
+
+static void removeFromIndex( std::unordered_map< uint64_t, vector< uint32_t > > & index, uint64_t key, uint32_t deviceIdx ) noexcept
+{
+	auto iter = index.find( key );
+	if (iter == index.end())
+	{
+		return;
+	}
+	vector< uint32_t > & deviceIndexes = iter->second;
+	auto pos = std::lower_bound( deviceIndexes.begin(), deviceIndexes.end(), deviceIdx );
+	if (pos != deviceIndexes.end() && *pos == deviceIdx)
+	{
+		deviceIndexes.erase( pos );
+	}
+	// empty entries would make the lookups return an empty list instead of nullptr
+	if (deviceIndexes.empty())
+	{
+		index.erase( iter );
+	}
+}
+
+void DeviceList::indexDevice( uint32_t deviceIdx )
+{
+	const Device & device = *_list[ deviceIdx ];
+	try {
+		addToIndex( _nameIndex, stringKey( device.name.data(), device.name.size() ), deviceIdx );
+		addToIndex( _vendorIndex, stringKey( device.vendor.data(), device.vendor.size() ), deviceIdx );
+		addToIndex( _typeIndex, uint64_t( device.type ), deviceIdx );
+	} catch (...) {
+		// don't leave the device half-indexed
+		unindexDevice( deviceIdx );
+		throw;
+	}
+}
+
+void DeviceList::unindexDevice( uint32_t deviceIdx ) noexcept
+{
+	const Device & device = *_list[ deviceIdx ];
+	removeFromIndex( _nameIndex, stringKey( device.name.data(), device.name.size() ), deviceIdx );
+	removeFromIndex( _vendorIndex, stringKey( device.vendor.data(), device.vendor.size() ), deviceIdx );
+	removeFromIndex( _typeIndex, uint64_t( device.type ), deviceIdx );
+}
+
+void DeviceList::append( std::unique_ptr< Device > && device, uint64_t contentHash )
+{
+	_hashes.resize( _list.size(), 0 );
+	_hashes.push_back( contentHash );
+	_list.push_back( move(device) );
+	try {
+		indexDevice( uint32_t( _list.size() - 1 ) );
+	} catch (...) {
+		_list.pop_back();
+		_hashes.pop_back();
+		throw;
+	}
+}
+
+void DeviceList::replace( uint32_t deviceIdx, std::unique_ptr< Device > && device, uint64_t contentHash )
+{
+	if (deviceIdx >= _hashes.size())
+	{
+		_hashes.resize( deviceIdx + 1, 0 );
+	}
+	unindexDevice( deviceIdx );
+	_list[ deviceIdx ] = move(device);
+	_hashes[ deviceIdx ] = contentHash;
+	indexDevice( deviceIdx );
+}
+
+void DeviceList::truncate( size_t newSize ) noexcept
+{
+	// removing from the back keeps the erasures from the indexes cheap, the removed index is always the last one
+	while (_list.size() > newSize)
+	{
+		unindexDevice( uint32_t( _list.size() - 1 ) );
+		_list.pop_back();
+	}
+	if (newSize < _hashes.size())
+	{
+		_hashes.resize( newSize );
+	}
+}
+
+void DeviceList::clear() noexcept
+{
+	_list.clear();
+	_hashes.clear();
+	_nameIndex.clear();
+	_vendorIndex.clear();
+	_typeIndex.clear();
+}
+
+const Device * DeviceList::findByName( const char * name, size_t length ) const noexcept
+{
+	auto iter = _nameIndex.find( stringKey( name, length ) );
+	if (iter == _nameIndex.end())
+	{
+		return nullptr;
+	}
+	// different names can have the same hash
+	for (uint32_t deviceIdx : iter->second)
+	{
+		if (equals( _list[ deviceIdx ]->name, name, length ))
+		{
+			return _list[ deviceIdx ].get();
+		}
+	}
+	return nullptr;
+}
+
+const vector< uint32_t > * DeviceList::vendorCandidates( const char * vendor, size_t length ) const noexcept
+{
+	auto iter = _vendorIndex.find( stringKey( vendor, length ) );
+	return iter != _vendorIndex.end() ? &iter->second : nullptr;
+}
+
+const vector< uint32_t > * DeviceList::typeCandidates( DeviceType deviceType ) const noexcept
+{
+	auto iter = _typeIndex.find( uint64_t( deviceType ) );
+	return iter != _typeIndex.end() ? &iter->second : nullptr;
+}
+
+
+//======================================================================================================================
+//  printing utils
+
 void print( const Device & device, unsigned int indentLevel )
 {
 	indent( indentLevel ); printf( "[%u] = {\n", device.idx );
@@ -0,0 +1,211 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: storing the device list into a file and loading it back
+//======================================================================================================================
+
+#include "OpenRGB/DeviceInfo.hpp"
+
+#include "Essential.hpp"
+
+#include "ProtocolMessages.hpp"  // implementedProtocolVersion
+#include "ContentHash.hpp"
+#include "MappedFile.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryOutputStream;
+using own::BinaryInputStream;
+#include "ContainerUtils.hpp"
+using own::span;
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  file format
+//
+//  header:
+//    8 bytes  magic "ORGBDLC" followed by the format version
+//    uint32   protocol version the devices are serialized in
+//    uint32   number of devices
+//  for every device:
+//    uint64   hash of the body, the same one the Client computes from the server reply
+//    uint32   size of the body
+//    body     exactly what the server sends in the REQUEST_CONTROLLER_DATA reply (data_size + device description)
+//
+//  All numbers are little-endian like in the OpenRGB protocol.
+
+static const uint8_t cacheMagic [8] = { 'O','R','G','B','D','L','C', 1 };
+static constexpr size_t cacheHeaderSize = sizeof(cacheMagic) + 2 * sizeof(uint32_t);
+static constexpr size_t entryHeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+
+//======================================================================================================================
+
+bool DeviceList::saveToFile( const string & filePath ) const noexcept
+{
+	try {
+
+		uint32_t protocolVersion = _protocolVersion != 0 ? _protocolVersion : implementedProtocolVersion;
+
+		// serialize everything into memory first, so that the file is written in a single call
+		size_t totalSize = cacheHeaderSize;
+		for (const auto & device : _list)
+		{
+			totalSize += entryHeaderSize + sizeof(uint32_t) + device->calcSize( protocolVersion );
+		}
+		vector< uint8_t > buffer( totalSize );
+
+		BinaryOutputStream headerStream( span< uint8_t >( buffer.data(), cacheHeaderSize ) );
+		headerStream.writeBytes( own::const_byte_span( cacheMagic, sizeof(cacheMagic) ) );
+		headerStream << protocolVersion;
+		headerStream << uint32_t( _list.size() );
+
+		size_t offset = cacheHeaderSize;
+		for (const auto & device : _list)
+		{
+			uint8_t * entry = buffer.data() + offset;
+			uint32_t bodySize = uint32_t( sizeof(uint32_t) + device->calcSize( protocolVersion ) );
+
+			// The hash must match the one computed from the server reply, so it's always computed from the serialized
+			// bytes, the serialization reproduces the reply exactly.
+			uint8_t * body = entry + entryHeaderSize;
+			BinaryOutputStream bodyStream( span< uint8_t >( body, bodySize ) );
+			bodyStream << bodySize;  // data_size
+			device->serialize( bodyStream, protocolVersion );
+
+			BinaryOutputStream entryStream( span< uint8_t >( entry, entryHeaderSize ) );
+			entryStream << hashBytes( body, bodySize );
+			entryStream << bodySize;
+
+			offset += entryHeaderSize + bodySize;
+		}
+
+		string tempPath = filePath + ".tmp";
+		FILE * file = fopen( tempPath.c_str(), "wb" );
+		if (!file)
+		{
+			return false;
+		}
+		bool written = fwrite( buffer.data(), 1, buffer.size(), file ) == buffer.size();
+		written = (fclose( file ) == 0) && written;
+		if (!written)
+		{
+			remove( tempPath.c_str() );
+			return false;
+		}
+
+		if (rename( tempPath.c_str(), filePath.c_str() ) != 0)
+		{
+			// Windows doesn't allow renaming over an existing file
+			remove( filePath.c_str() );
+			if (rename( tempPath.c_str(), filePath.c_str() ) != 0)
+			{
+				remove( tempPath.c_str() );
+				return false;
+			}
+		}
+
+		return true;
+
+	} catch (...) {
+		return false;
+	}
+}
+
+bool DeviceList::loadFromFile( const string & filePath ) noexcept
+{
+	try {
+
+		MappedFile file;
+		if (!file.open( filePath ))
+		{
+			return false;
+		}
+		const uint8_t * data = file.data();
+		size_t fileSize = file.size();
+
+		if (fileSize < cacheHeaderSize || memcmp( data, cacheMagic, sizeof(cacheMagic) ) != 0)
+		{
+			return false;
+		}
+
+		uint32_t protocolVersion, deviceCount;
+		BinaryInputStream headerStream( own::const_byte_span( data + sizeof(cacheMagic), cacheHeaderSize - sizeof(cacheMagic) ) );
+		headerStream >> protocolVersion;
+		headerStream >> deviceCount;
+		if (headerStream.hasFailed() || protocolVersion == 0 || protocolVersion > implementedProtocolVersion)
+		{
+			return false;
+		}
+		// a damaged count must not make us allocate gigabytes
+		if (deviceCount > (fileSize - cacheHeaderSize) / entryHeaderSize)
+		{
+			return false;
+		}
+
+		DeviceList newList;
+		newList._protocolVersion = protocolVersion;
+		newList.reserve( deviceCount );
+
+		size_t offset = cacheHeaderSize;
+		for (uint32_t deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+		{
+			if (fileSize - offset < entryHeaderSize)
+			{
+				return false;
+			}
+			uint64_t contentHash; uint32_t bodySize;
+			BinaryInputStream entryStream( own::const_byte_span( data + offset, entryHeaderSize ) );
+			entryStream >> contentHash;
+			entryStream >> bodySize;
+			offset += entryHeaderSize;
+
+			if (fileSize - offset < bodySize)
+			{
+				return false;
+			}
+			const uint8_t * body = data + offset;
+			offset += bodySize;
+
+			// the hash doubles as a checksum against a damaged file
+			if (hashBytes( body, bodySize ) != contentHash)
+			{
+				return false;
+			}
+
+			BinaryInputStream bodyStream( own::const_byte_span( body, bodySize ) );
+			uint32_t dataSize;
+			bodyStream >> dataSize;
+			unique_ptr< Device > device( new Device );
+			if (!device->deserialize( bodyStream, protocolVersion, deviceIdx ) || bodyStream.hasFailed())
+			{
+				return false;
+			}
+
+			newList.append( std::move( device ), contentHash );
+		}
+
+		*this = std::move( newList );
+		return true;
+
+	} catch (...) {
+		return false;
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
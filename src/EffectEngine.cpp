@@ -0,0 +1,273 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: rendering of effects at a fixed frame rate
+//======================================================================================================================
+
+#include "OpenRGB/EffectEngine.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ThreadPool.hpp"
+#include "LatencyHistogram.hpp"
+
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+#include <algorithm>
+#include <chrono>
+using std::chrono::nanoseconds;
+using std::chrono::duration;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static int64_t framePeriodOf( unsigned int framesPerSecond ) noexcept
+{
+	return 1000000000 / int64_t( std::max( framesPerSecond, 1u ) );
+}
+
+EffectEngine::EffectEngine( Client & client, unsigned int framesPerSecond ) noexcept
+:
+	_client( client ),
+	_stopRequested( false ),
+	_framePeriodNs( framePeriodOf( framesPerSecond ) ),
+	_threadPool( nullptr ),
+	_startTime( Clock::now().time_since_epoch().count() ),
+	_frameIdx( 0 ),
+	_lastFrameStatus( RequestStatus::Success ),
+	_statsSince( Clock::now().time_since_epoch().count() ),
+	_renderedFrames( 0 ),
+	_skippedFrames( 0 ),
+	_jitter( new LatencyHistogram ),
+	_frameTime( new LatencyHistogram )
+{}
+
+EffectEngine::~EffectEngine() noexcept
+{
+	stop();
+}
+
+void EffectEngine::setEffect( const Device & device, unique_ptr< Effect > effect ) noexcept
+{
+	unique_lock< mutex > lock( _effectsMutex );
+
+	auto pos = std::lower_bound( _effects.begin(), _effects.end(), device.idx,
+		[]( const DeviceEffect & deviceEffect, uint32_t deviceIdx ) { return deviceEffect.device->idx < deviceIdx; }
+	);
+	if (pos == _effects.end() || pos->device->idx != device.idx)
+	{
+		pos = _effects.insert( pos, DeviceEffect() );
+	}
+	pos->device = &device;
+	pos->effect = std::move( effect );
+	pos->colors.assign( device.leds.size(), Color::Black );  // the new effect starts from black
+	pos->rendered = false;
+}
+
+void EffectEngine::removeEffect( const Device & device ) noexcept
+{
+	unique_lock< mutex > lock( _effectsMutex );
+
+	_effects.erase( std::remove_if( _effects.begin(), _effects.end(),
+		[ &device ]( const DeviceEffect & deviceEffect ) { return deviceEffect.device->idx == device.idx; }
+	), _effects.end() );
+}
+
+void EffectEngine::clearEffects() noexcept
+{
+	unique_lock< mutex > lock( _effectsMutex );
+
+	_effects.clear();
+}
+
+void EffectEngine::setFrameRate( unsigned int framesPerSecond ) noexcept
+{
+	_framePeriodNs = framePeriodOf( framesPerSecond );
+}
+
+void EffectEngine::setThreadPool( ThreadPool * pool ) noexcept
+{
+	unique_lock< mutex > lock( _effectsMutex );
+
+	_threadPool = pool;
+}
+
+unsigned int EffectEngine::frameRate() const noexcept
+{
+	return unsigned( (1000000000 + _framePeriodNs / 2) / _framePeriodNs );
+}
+
+RequestStatus EffectEngine::renderFrame() noexcept
+{
+	return renderFrameAt( Clock::now() );
+}
+
+RequestStatus EffectEngine::renderFrameAt( Clock::time_point frameTime ) noexcept
+{
+	unique_lock< mutex > lock( _effectsMutex );
+
+	FrameTime time;
+	time.sinceStart = frameTime - Clock::time_point( Clock::duration( _startTime ) );
+	time.frameIdx = _frameIdx++;
+
+	// Each effect renders only into the colors of its own device, so the devices can be rendered in parallel,
+	// and the result is the same no matter which thread renders which device.
+	auto renderDevices = [ this, &time, frameTime ]( size_t begin, size_t end )
+	{
+		FrameTime deviceTime = time;
+		for (size_t i = begin; i < end; ++i)
+		{
+			DeviceEffect & deviceEffect = _effects[i];
+			deviceTime.sincePrevious = deviceEffect.rendered ? frameTime - deviceEffect.lastFrame : nanoseconds( 0 );
+			deviceEffect.lastFrame = frameTime;
+			deviceEffect.rendered = true;
+
+			// the device may have been re-parsed with a different number of LEDs, resize() allocates only then
+			deviceEffect.colors.resize( deviceEffect.device->leds.size() );
+			deviceEffect.effect->render( deviceEffect.colors.data(), deviceEffect.colors.size(), deviceTime );
+		}
+	};
+
+	ThreadPool * pool = _threadPool;
+	if (pool && _effects.size() > 1)
+	{
+		pool->parallelFor( _effects.size(), 1, renderDevices );
+	}
+	else
+	{
+		renderDevices( 0, _effects.size() );
+	}
+
+	// the frames are always sent from this thread in the order of the devices
+	RequestStatus firstError = RequestStatus::Success;
+	for (DeviceEffect & deviceEffect : _effects)
+	{
+		RequestStatus status = _client.updateDeviceColors( *deviceEffect.device, deviceEffect.colors );
+		if (status != RequestStatus::Success && firstError == RequestStatus::Success)
+		{
+			firstError = status;
+		}
+	}
+
+	_renderedFrames++;
+	_lastFrameStatus = firstError;
+	return firstError;
+}
+
+bool EffectEngine::start() noexcept
+{
+	unique_lock< mutex > lock( _threadMutex );
+
+	if (_thread.joinable())
+	{
+		return false;
+	}
+
+	_stopRequested = false;
+	_startTime = Clock::now().time_since_epoch().count();
+	resetStats();
+	try {
+		_thread = std::thread( &EffectEngine::renderLoop, this );
+		return true;
+	} catch (const std::system_error &) {
+		return false;
+	}
+}
+
+void EffectEngine::stop() noexcept
+{
+	{
+		unique_lock< mutex > lock( _threadMutex );
+		_stopRequested = true;
+	}
+	_stopCond.notify_all();
+
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+bool EffectEngine::isRunning() const noexcept
+{
+	return _thread.joinable();
+}
+
+void EffectEngine::renderLoop() noexcept
+{
+	// Deadlines are absolute, so that the time spent by rendering and sending doesn't add up into a drift.
+	Clock::time_point deadline = Clock::time_point( Clock::duration( _startTime ) );
+
+	unique_lock< mutex > lock( _threadMutex );
+	while (!_stopRequested)
+	{
+		if (_stopCond.wait_until( lock, deadline, [ this ]() { return _stopRequested; } ))
+		{
+			break;
+		}
+		lock.unlock();
+
+		Clock::time_point wakeUp = Clock::now();
+		_jitter->record( wakeUp - deadline );
+
+		renderFrameAt( deadline );
+
+		Clock::time_point now = Clock::now();
+		_frameTime->record( now - wakeUp );
+
+		lock.lock();
+
+		nanoseconds period( _framePeriodNs );
+		deadline += period;
+		if (deadline < now)
+		{
+			// The frame took longer than the period, skip the missed frames instead of rendering them in a burst,
+			// but stay aligned to the original schedule.
+			int64_t missed = (now - deadline) / period + 1;
+			deadline += missed * period;
+			_skippedFrames += uint64_t( missed );
+		}
+	}
+}
+
+EffectEngineStats EffectEngine::stats() const noexcept
+{
+	EffectEngineStats stats;
+
+	stats.renderedFrames = _renderedFrames;
+	stats.skippedFrames = _skippedFrames;
+	stats.jitter = _jitter->summarize();
+	stats.frameTime = _frameTime->summarize();
+
+	duration< double > elapsed = Clock::now() - Clock::time_point( Clock::duration( _statsSince ) );
+	if (elapsed.count() > 0.0)
+	{
+		stats.achievedFps = double( stats.renderedFrames ) / elapsed.count();
+	}
+
+	return stats;
+}
+
+void EffectEngine::resetStats() noexcept
+{
+	_statsSince = Clock::now().time_since_epoch().count();
+	_renderedFrames = 0;
+	_skippedFrames = 0;
+	_jitter->reset();
+	_frameTime->reset();
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,37 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: helpers shared by the built-in effects of Effects and SpatialCanvas
+//======================================================================================================================
+
+#ifndef OPENRGB_EFFECT_UTILS_INCLUDED
+#define OPENRGB_EFFECT_UTILS_INCLUDED
+
+
+#include <cmath>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+constexpr double twoPi = 6.283185307179586;
+/// For the per-LED computations, which stay in float to be fast.
+constexpr float twoPiFloat = float( twoPi );
+
+/// Fraction of a full cycle in the range [0, 1), also for negative values.
+inline double fractionOf( double cycles ) noexcept
+{
+	return cycles - std::floor( cycles );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_EFFECT_UTILS_INCLUDED
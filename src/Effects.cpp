@@ -0,0 +1,213 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: animated effects rendered by the EffectEngine
+//======================================================================================================================
+
+#include "OpenRGB/Effects.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ColorBuffer.hpp"
+#include "ColorModels.hpp"
+#include "EffectUtils.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+using std::chrono::nanoseconds;
+using std::chrono::milliseconds;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  utils
+
+/// The colors between a and b, amount 0 gives a, 255 gives b, the same as blendColors() for a single color.
+static Color mix( Color a, Color b, uint8_t amount ) noexcept
+{
+	uint32_t inverse = 255u - amount;
+	return makeColor(
+		div255( a.r * inverse + b.r * amount ),
+		div255( a.g * inverse + b.g * amount ),
+		div255( a.b * inverse + b.b * amount )
+	);
+}
+
+
+//======================================================================================================================
+//  StaticEffect
+
+void StaticEffect::render( Color * colors, size_t count, const FrameTime & ) noexcept
+{
+	fillColors( colors, count, _color );
+}
+
+
+//======================================================================================================================
+//  RainbowWaveEffect
+
+RainbowWaveEffect::RainbowWaveEffect( double cyclesPerSecond, double ledsPerCycle, uint8_t saturation, uint8_t value ) noexcept
+:
+	_cyclesPerSecond( cyclesPerSecond ),
+	// a whole cycle per LED wraps around to 0, which is the same
+	_huePerLed( uint32_t( uint64_t( 4294967296.0 / std::max( ledsPerCycle, 1.0 ) ) ) ),
+	_saturation( saturation ),
+	_value( value )
+{}
+
+void RainbowWaveEffect::render( Color * colors, size_t count, const FrameTime & time ) noexcept
+{
+	_hues.resize( count );
+
+	// the hue is accumulated with 16 more bits of precision, so that the rainbow doesn't get shorter by rounding,
+	// it's decreasing along the LEDs, so that the colors move towards the higher indexes
+	uint32_t hue = uint32_t( uint64_t( fractionOf( time.seconds() * _cyclesPerSecond ) * 4294967296.0 ) );
+	for (size_t i = 0; i < count; ++i)
+	{
+		_hues[i] = HSV( uint16_t( hue >> 16 ), _saturation, _value );
+		hue -= _huePerLed;
+	}
+
+	colorsFromHSV( colors, _hues.data(), count );
+}
+
+
+//======================================================================================================================
+//  BreathingEffect
+
+BreathingEffect::BreathingEffect( Color color, milliseconds period ) noexcept
+:
+	_color( color ),
+	_period( std::max( nanoseconds( period ), nanoseconds( 1 ) ) )
+{}
+
+void BreathingEffect::render( Color * colors, size_t count, const FrameTime & time ) noexcept
+{
+	double phase = double( time.sinceStart.count() % _period.count() ) / double( _period.count() );
+	double level = (1.0 - std::cos( twoPi * phase )) / 2.0;
+
+	fillColors( colors, count, mix( Color::Black, _color, uint8_t( level * 255.0 + 0.5 ) ) );
+}
+
+
+//======================================================================================================================
+//  GradientEffect
+
+void GradientEffect::render( Color * colors, size_t count, const FrameTime & ) noexcept
+{
+	if (_gradient.size() != count)
+	{
+		_gradient.resize( count );
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint8_t amount = count > 1 ? uint8_t( (i * 255 + (count - 1) / 2) / (count - 1) ) : 0;
+			_gradient[i] = mix( _from, _to, amount );
+		}
+	}
+
+	std::copy( _gradient.begin(), _gradient.end(), colors );
+}
+
+
+//======================================================================================================================
+//  ChaseEffect
+
+ChaseEffect::ChaseEffect( Color color, Color background, unsigned int length, double ledsPerSecond ) noexcept
+:
+	_color( color ),
+	_background( background ),
+	_length( std::max( length, 1u ) ),
+	_ledsPerSecond( ledsPerSecond )
+{}
+
+void ChaseEffect::render( Color * colors, size_t count, const FrameTime & time ) noexcept
+{
+	fillColors( colors, count, _background );
+	if (count == 0)
+	{
+		return;
+	}
+
+	size_t head = size_t( fractionOf( time.seconds() * _ledsPerSecond / double( count ) ) * double( count ) ) % count;
+	// the tail is behind the head, in the opposite direction than it's moving
+	size_t tailStep = _ledsPerSecond >= 0.0 ? count - 1 : 1;
+
+	size_t litCount = std::min( size_t( _length ), count );
+	size_t ledIdx = head;
+	for (size_t i = 0; i < litCount; ++i)
+	{
+		colors[ ledIdx ] = mix( _background, _color, uint8_t( (_length - i) * 255 / _length ) );
+		ledIdx = (ledIdx + tailStep) % count;
+	}
+}
+
+
+//======================================================================================================================
+//  SparkleEffect
+
+SparkleEffect::SparkleEffect( Color color, Color background, double sparklesPerSecond, milliseconds fadeTime, uint64_t seed ) noexcept
+:
+	_color( color ),
+	_background( background ),
+	_sparklesPerSecond( std::max( sparklesPerSecond, 0.0 ) ),
+	_fadeTime( std::max( nanoseconds( fadeTime ), nanoseconds( 1 ) ) ),
+	_randomState( seed ? seed : 0x9E3779B97F4A7C15 ),  // xorshift never leaves 0
+	_pendingSparkles( 0.0 )
+{}
+
+uint32_t SparkleEffect::nextRandom() noexcept
+{
+	// xorshift64*, plenty random for blinking lights and much cheaper than the std engines
+	_randomState ^= _randomState >> 12;
+	_randomState ^= _randomState << 25;
+	_randomState ^= _randomState >> 27;
+	return uint32_t( (_randomState * 0x2545F4914F6CDD1D) >> 32 );
+}
+
+void SparkleEffect::render( Color * colors, size_t count, const FrameTime & time ) noexcept
+{
+	if (_energy.size() != count)
+	{
+		_energy.assign( count, 0 );
+	}
+	if (count == 0)
+	{
+		return;
+	}
+
+	// fade out the existing flashes linearly, by at least 1 step so that they always disappear eventually
+	if (time.sincePrevious.count() > 0)
+	{
+		double fade = 255.0 * double( time.sincePrevious.count() ) / double( _fadeTime.count() );
+		uint32_t decrement = uint32_t( std::min( std::max( fade + 0.5, 1.0 ), 255.0 ) );
+		for (uint8_t & energy : _energy)
+		{
+			energy = energy > decrement ? uint8_t( energy - decrement ) : 0;
+		}
+	}
+
+	// light up as many new ones as fall into this frame on average, instead of rolling a dice for each LED,
+	// but not more than there are LEDs, which could happen after a long pause
+	_pendingSparkles += _sparklesPerSecond * double( count ) * time.deltaSeconds();
+	_pendingSparkles = std::min( _pendingSparkles, double( count ) );
+	while (_pendingSparkles >= 1.0)
+	{
+		_energy[ nextRandom() % count ] = 255;
+		_pendingSparkles -= 1.0;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		colors[i] = mix( _background, _color, _energy[i] );
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,225 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: coalescing of color frames before they are sent to the server
+//======================================================================================================================
+
+#include "OpenRGB/FrameSubmitter.hpp"
+
+#include "Essential.hpp"
+
+#include <vector>
+using std::vector;
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+#include <chrono>
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+FrameSubmitter::FrameSubmitter( Client & client, milliseconds flushPeriod ) noexcept
+:
+	_client( client ),
+	_stopRequested( false ),
+	_flushPeriodMs( flushPeriod.count() ),
+	_lastFlushStatus( RequestStatus::Success ),
+	_sentFrames( 0 ),
+	_droppedFrames( 0 )
+{}
+
+FrameSubmitter::~FrameSubmitter() noexcept
+{
+	stop();
+}
+
+void FrameSubmitter::storeFrame( Slot & slot, const vector< Color > & colors ) noexcept
+{
+	if (slot.pending)
+	{
+		_droppedFrames++;
+	}
+	// assign() reuses the capacity from the previous frames, so in a steady state this doesn't allocate
+	slot.colors.assign( colors.begin(), colors.end() );
+	slot.pending = true;
+}
+
+void FrameSubmitter::submitDeviceFrame( const Device & device, const vector< Color > & colors ) noexcept
+{
+	unique_lock< mutex > lock( _slotsMutex );
+
+	// the whole device frame covers all the zones, so their older frames are no longer needed
+	auto zonesBegin = _slots.upper_bound( deviceKey( device.idx ) );
+	auto zonesEnd = _slots.lower_bound( deviceKey( device.idx ) + ( uint64_t( 1 ) << 32 ) );
+	for (auto iter = zonesBegin; iter != zonesEnd; ++iter)
+	{
+		if (iter->second.pending)
+		{
+			iter->second.pending = false;
+			_droppedFrames++;
+		}
+	}
+
+	Slot & slot = _slots[ deviceKey( device.idx ) ];
+	slot.device = &device;
+	slot.zone = nullptr;
+	storeFrame( slot, colors );
+}
+
+void FrameSubmitter::submitZoneFrame( const Zone & zone, const vector< Color > & colors ) noexcept
+{
+	unique_lock< mutex > lock( _slotsMutex );
+
+	Slot & slot = _slots[ zoneKey( zone.parentIdx, zone.idx ) ];
+	slot.device = nullptr;
+	slot.zone = &zone;
+	storeFrame( slot, colors );
+}
+
+RequestStatus FrameSubmitter::flush() noexcept
+{
+	unique_lock< mutex > flushLock( _flushMutex );
+
+	// take the pending frames out of the slots, so that new frames can be submitted while we are sending these
+	_toSend.clear();
+	{
+		unique_lock< mutex > slotsLock( _slotsMutex );
+		for (auto & keyAndSlot : _slots)
+		{
+			Slot & slot = keyAndSlot.second;
+			if (slot.pending)
+			{
+				slot.sending.swap( slot.colors );
+				slot.pending = false;
+				_toSend.push_back( &slot );
+			}
+		}
+	}
+
+	if (_toSend.empty())
+	{
+		return RequestStatus::Success;
+	}
+
+	// The slots are never removed from the map and only this function touches the sending buffers,
+	// so it's safe to use them without holding the lock.
+	RequestStatus firstError = RequestStatus::Success;
+	for (Slot * slot : _toSend)
+	{
+		RequestStatus status = slot->zone
+			? _client.setZoneColors( *slot->zone, slot->sending )
+			: _client.setDeviceColors( *slot->device, slot->sending );
+		if (status == RequestStatus::Success)
+		{
+			_sentFrames++;
+		}
+		else if (firstError == RequestStatus::Success)
+		{
+			firstError = status;
+		}
+	}
+
+	_lastFlushStatus = firstError;
+	return firstError;
+}
+
+void FrameSubmitter::clear() noexcept
+{
+	unique_lock< mutex > lock( _slotsMutex );
+
+	for (auto & keyAndSlot : _slots)
+	{
+		if (keyAndSlot.second.pending)
+		{
+			keyAndSlot.second.pending = false;
+			_droppedFrames++;
+		}
+	}
+}
+
+void FrameSubmitter::resetCounters() noexcept
+{
+	_sentFrames = 0;
+	_droppedFrames = 0;
+}
+
+void FrameSubmitter::setFlushPeriod( milliseconds flushPeriod ) noexcept
+{
+	_flushPeriodMs = flushPeriod.count();
+}
+
+bool FrameSubmitter::start() noexcept
+{
+	unique_lock< mutex > lock( _threadMutex );
+
+	if (_thread.joinable())
+	{
+		return false;
+	}
+
+	_stopRequested = false;
+	try {
+		_thread = std::thread( &FrameSubmitter::flushLoop, this );
+		return true;
+	} catch (const std::system_error &) {
+		return false;
+	}
+}
+
+void FrameSubmitter::stop() noexcept
+{
+	{
+		unique_lock< mutex > lock( _threadMutex );
+		_stopRequested = true;
+	}
+	_stopCond.notify_all();
+
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+bool FrameSubmitter::isRunning() const noexcept
+{
+	return _thread.joinable();
+}
+
+void FrameSubmitter::flushLoop() noexcept
+{
+	// Deadlines are absolute, so that the time spent by sending doesn't add up into a drift of the cadence.
+	auto nextFlush = steady_clock::now() + milliseconds( _flushPeriodMs );
+
+	unique_lock< mutex > lock( _threadMutex );
+	while (!_stopRequested)
+	{
+		if (_stopCond.wait_until( lock, nextFlush, [ this ]() { return _stopRequested; } ))
+		{
+			break;
+		}
+
+		lock.unlock();
+		flush();
+		lock.lock();
+
+		nextFlush += milliseconds( _flushPeriodMs );
+		auto now = steady_clock::now();
+		if (nextFlush < now)
+		{
+			// Sending took longer than the period, skip the missed ticks instead of flushing in a burst.
+			nextFlush = now + milliseconds( _flushPeriodMs );
+		}
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,135 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: lock-free histogram of durations with logarithmic buckets
+//======================================================================================================================
+
+#include "LatencyHistogram.hpp"
+
+#include <chrono>
+using std::chrono::nanoseconds;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static unsigned highestBit( uint64_t value ) noexcept
+{
+ #if defined(__GNUC__) || defined(__clang__)
+	return 63 - unsigned( __builtin_clzll( value ) );
+ #else
+	unsigned bit = 0;
+	while (value >>= 1)
+		++bit;
+	return bit;
+ #endif
+}
+
+LatencyHistogram::LatencyHistogram() noexcept
+{
+	reset();
+}
+
+size_t LatencyHistogram::bucketIndex( uint64_t value ) noexcept
+{
+	if (value < subBucketCount)
+	{
+		return size_t( value );
+	}
+	if (value >= (uint64_t(1) << maxValueBits))
+	{
+		value = (uint64_t(1) << maxValueBits) - 1;
+	}
+	// the top (subBucketBits + 1) bits of the value select the sub-bucket within its power of two
+	unsigned shift = highestBit( value ) - subBucketBits;
+	return size_t( shift * subBucketCount + (value >> shift) );
+}
+
+uint64_t LatencyHistogram::bucketHighestValue( size_t index ) noexcept
+{
+	if (index < 2 * subBucketCount)
+	{
+		return index;
+	}
+	unsigned shift = unsigned( index / subBucketCount ) - 1;
+	uint64_t top = index - shift * subBucketCount;
+	return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record( nanoseconds duration ) noexcept
+{
+	uint64_t value = duration.count() > 0 ? uint64_t( duration.count() ) : 0;
+
+	_counts[ bucketIndex( value ) ].fetch_add( 1, std::memory_order_relaxed );
+
+	uint64_t currentMax = _max.load( std::memory_order_relaxed );
+	while (value > currentMax && !_max.compare_exchange_weak( currentMax, value, std::memory_order_relaxed ))
+	{
+		// currentMax has been updated by the failed exchange, try again
+	}
+}
+
+LatencyStats LatencyHistogram::summarize() const noexcept
+{
+	LatencyStats stats;
+
+	// copy the counts first, so that all the percentiles are computed from the same data
+	uint64_t counts [ bucketCount ];
+	for (size_t i = 0; i < bucketCount; ++i)
+	{
+		counts[i] = _counts[i].load( std::memory_order_relaxed );
+		stats.count += counts[i];
+	}
+	if (stats.count == 0)
+	{
+		return stats;
+	}
+
+	uint64_t max = _max.load( std::memory_order_relaxed );
+	stats.max = nanoseconds( max );
+
+	struct { double quantile; nanoseconds * output; } percentiles [] =
+	{
+		{ 0.50, &stats.p50 },
+		{ 0.90, &stats.p90 },
+		{ 0.99, &stats.p99 },
+	};
+
+	size_t bucket = 0;
+	uint64_t cumulative = counts[0];
+	for (const auto & percentile : percentiles)
+	{
+		// the rank of the measurement that splits the distribution, rounded up
+		uint64_t rank = uint64_t( percentile.quantile * double( stats.count ) );
+		if (double( rank ) < percentile.quantile * double( stats.count ) || rank == 0)
+			++rank;
+
+		while (cumulative < rank && bucket + 1 < bucketCount)
+		{
+			cumulative += counts[ ++bucket ];
+		}
+		// the highest value of the bucket never underestimates, but it must not exceed the real maximum
+		uint64_t value = bucketHighestValue( bucket );
+		*percentile.output = nanoseconds( value < max ? value : max );
+	}
+
+	return stats;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+	for (auto & count : _counts)
+	{
+		count.store( 0, std::memory_order_relaxed );
+	}
+	_max.store( 0, std::memory_order_relaxed );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,68 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: lock-free histogram of durations with logarithmic buckets
+//======================================================================================================================
+
+#ifndef OPENRGB_LATENCY_HISTOGRAM_INCLUDED
+#define OPENRGB_LATENCY_HISTOGRAM_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ClientStats.hpp"  // LatencyStats
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Histogram of durations in the style of HdrHistogram.
+/** Every power of two is split into 16 linear sub-buckets, so the values are stored with a relative error of at most
+  * 1/16 in a fixed array, without any allocations. Values up to 16 ns are stored exactly, values above 2^36 ns
+  * (about 68 s) are counted in the last bucket. Recording is a single relaxed atomic increment (plus an update of
+  * the maximum), so any number of threads can record into it while another thread reads the summary. */
+
+class LatencyHistogram
+{
+
+ public:
+
+	LatencyHistogram() noexcept;
+
+	void record( std::chrono::nanoseconds duration ) noexcept;
+
+	/// Computes the percentiles from the current content.
+	/** Concurrent recording can make the result slightly inconsistent, but never invalid. */
+	LatencyStats summarize() const noexcept;
+
+	void reset() noexcept;
+
+ private:
+
+	static constexpr unsigned subBucketBits = 4;
+	static constexpr uint64_t subBucketCount = uint64_t(1) << subBucketBits;
+	static constexpr unsigned maxValueBits = 36;
+	static constexpr size_t bucketCount = (maxValueBits - subBucketBits) * subBucketCount + subBucketCount;
+
+	static size_t bucketIndex( uint64_t value ) noexcept;
+	static uint64_t bucketHighestValue( size_t index ) noexcept;
+
+	std::atomic< uint64_t > _counts [ bucketCount ];
+	std::atomic< uint64_t > _max;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_LATENCY_HISTOGRAM_INCLUDED
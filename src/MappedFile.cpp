@@ -0,0 +1,170 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only memory mapping of a file
+//======================================================================================================================
+
+#include "MappedFile.hpp"
+
+#include <cstdio>
+#include <string>
+using std::string;
+
+#ifdef _WIN32
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#define HAVE_MMAP
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+#ifndef _WIN32
+/// Reads the whole file into the buffer, for the systems that can't map it.
+static bool readWholeFile( const string & filePath, std::vector< uint8_t > & buffer ) noexcept
+{
+	FILE * file = fopen( filePath.c_str(), "rb" );
+	if (!file)
+	{
+		return false;
+	}
+
+	bool success = false;
+	try {
+		uint8_t chunk [4096];
+		size_t readSize;
+		while ((readSize = fread( chunk, 1, sizeof(chunk), file )) > 0)
+		{
+			buffer.insert( buffer.end(), chunk, chunk + readSize );
+		}
+		success = !ferror( file ) && !buffer.empty();
+	} catch (...) {}
+
+	fclose( file );
+	return success;
+}
+#endif // _WIN32
+
+bool MappedFile::open( const string & filePath ) noexcept
+{
+	close();
+
+ #ifdef _WIN32
+
+	HANDLE file = CreateFileA( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                           FILE_ATTRIBUTE_NORMAL, nullptr );
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart <= 0)
+	{
+		CloseHandle( file );
+		return false;
+	}
+
+	// the mapping keeps its own reference to the file, so the file handle can be closed right away
+	HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	CloseHandle( file );
+	if (!mapping)
+	{
+		return false;
+	}
+
+	void * view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if (!view)
+	{
+		CloseHandle( mapping );
+		return false;
+	}
+
+	_mappingHandle = mapping;
+	_data = static_cast< const uint8_t * >( view );
+	_size = size_t( fileSize.QuadPart );
+	_isMapped = true;
+	return true;
+
+ #elif defined(HAVE_MMAP)
+
+	int fd = ::open( filePath.c_str(), O_RDONLY );
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat fileInfo;
+	if (fstat( fd, &fileInfo ) != 0 || fileInfo.st_size <= 0)
+	{
+		::close( fd );
+		return false;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void * mapping = mmap( nullptr, size_t( fileInfo.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close( fd );
+	if (mapping == MAP_FAILED)
+	{
+		// some file systems don't support mapping, let's at least read it
+		if (!readWholeFile( filePath, _fallbackBuffer ))
+		{
+			_fallbackBuffer.clear();
+			return false;
+		}
+		_data = _fallbackBuffer.data();
+		_size = _fallbackBuffer.size();
+		return true;
+	}
+
+	_data = static_cast< const uint8_t * >( mapping );
+	_size = size_t( fileInfo.st_size );
+	_isMapped = true;
+	return true;
+
+ #else
+
+	if (!readWholeFile( filePath, _fallbackBuffer ))
+	{
+		_fallbackBuffer.clear();
+		return false;
+	}
+	_data = _fallbackBuffer.data();
+	_size = _fallbackBuffer.size();
+	return true;
+
+ #endif
+}
+
+void MappedFile::close() noexcept
+{
+	if (_isMapped)
+	{
+	 #ifdef _WIN32
+		UnmapViewOfFile( _data );
+		CloseHandle( static_cast< HANDLE >( _mappingHandle ) );
+		_mappingHandle = nullptr;
+	 #elif defined(HAVE_MMAP)
+		munmap( const_cast< uint8_t * >( _data ), _size );
+	 #endif
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_isMapped = false;
+	std::vector< uint8_t >().swap( _fallbackBuffer );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
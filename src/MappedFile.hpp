@@ -0,0 +1,70 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: read-only memory mapping of a file
+//======================================================================================================================
+
+#ifndef OPENRGB_MAPPED_FILE_INCLUDED
+#define OPENRGB_MAPPED_FILE_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Whole file mapped into memory for reading.
+/** The operating system loads the pages only when they are touched and a file that has been read recently is served
+  * straight from the page cache, so there is no copying into a buffer. On systems without memory mapping the file is
+  * read into an internal buffer instead, the interface stays the same. */
+
+class MappedFile
+{
+
+ public:
+
+	MappedFile() noexcept {}
+	~MappedFile() noexcept  { close(); }
+
+	MappedFile( const MappedFile & other ) = delete;
+	MappedFile & operator=( const MappedFile & other ) = delete;
+
+	/// Maps the whole file, closing the previously opened one.
+	/** \returns false when the file doesn't exist, can't be read or is empty. */
+	bool open( const std::string & filePath ) noexcept;
+
+	void close() noexcept;
+
+	bool isOpen() const noexcept  { return _data != nullptr; }
+
+	const uint8_t * data() const noexcept  { return _data; }
+	size_t size() const noexcept  { return _size; }
+
+ private:
+
+	const uint8_t * _data = nullptr;
+	size_t _size = 0;
+	bool _isMapped = false;  ///< false when the content is in the _fallbackBuffer
+#ifdef _WIN32
+	void * _mappingHandle = nullptr;
+#endif
+	std::vector< uint8_t > _fallbackBuffer;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_MAPPED_FILE_INCLUDED
@@ -0,0 +1,158 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: mapping of 2D images onto the LEDs of matrix zones
+//======================================================================================================================
+
+#include "OpenRGB/MatrixMapper.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ColorBuffer.hpp"
+
+#include <vector>
+using std::vector;
+#include <new>  // bad_alloc
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static_assert( sizeof(Color) == 4, "RGBA pixels are mapped as colors" );
+
+/// Marks the LEDs that are not in the grid while building the table.
+static constexpr uint32_t noPixel = 0xFFFFFFFF;
+
+MatrixMapper::MatrixMapper() noexcept
+:
+	_width( 0 ),
+	_height( 0 ),
+	_stride( 0 ),
+	_zoneOffset( 0 ),
+	_zoneSize( 0 )
+{}
+
+void MatrixMapper::clear() noexcept
+{
+	_width = 0;
+	_height = 0;
+	_stride = 0;
+	_zoneOffset = 0;
+	_zoneSize = 0;
+	_runs.clear();
+	_pixels.clear();
+}
+
+bool MatrixMapper::build( const Device & device, const Zone & zone, size_t stride ) noexcept
+{
+	clear();
+
+	if (zone.parentIdx != device.idx || zone.idx >= device.zones.size())
+	{
+		return false;  // not a zone of this device
+	}
+	// the counts come from the server, a bogus one must not make us allocate nonsense or write past the device colors
+	if (size_t( zone.startIdx ) + zone.leds_count > device.leds.size())
+	{
+		return false;
+	}
+
+	const size_t width = zone.matrix_width;
+	const size_t height = zone.matrix_height;
+	if (width == 0 || height == 0 || zone.matrix_values.size() != width * height)
+	{
+		return false;  // not a matrix
+	}
+	if (stride == 0)
+	{
+		stride = width;
+	}
+	// the gather instructions take signed 32-bit indexes
+	if (stride < width || (height - 1) * stride + width > 0x80000000u)
+	{
+		return false;
+	}
+
+	try {
+
+		// invert the grid, when an LED is in more cells, the first one wins
+		vector< uint32_t > pixelOfLED( zone.leds_count, noPixel );
+		for (size_t y = 0; y < height; ++y)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				uint32_t ledIdx = zone.matrix_values[ y * width + x ];
+				if (ledIdx < zone.leds_count && pixelOfLED[ ledIdx ] == noPixel)
+				{
+					pixelOfLED[ ledIdx ] = uint32_t( y * stride + x );
+				}
+			}
+		}
+
+		// keep only the LEDs that are in the grid, usually all of them form a single run
+		for (uint32_t ledIdx = 0; ledIdx < zone.leds_count; ++ledIdx)
+		{
+			if (pixelOfLED[ ledIdx ] == noPixel)
+			{
+				continue;
+			}
+			if (_runs.empty() || _runs.back().firstLED + _runs.back().ledCount != ledIdx)
+			{
+				_runs.push_back({ ledIdx, 0 });
+			}
+			_runs.back().ledCount++;
+			_pixels.push_back( pixelOfLED[ ledIdx ] );
+		}
+
+	} catch (const std::bad_alloc &) {
+		clear();
+		return false;
+	}
+
+	_width = zone.matrix_width;
+	_height = zone.matrix_height;
+	_stride = stride;
+	_zoneOffset = zone.startIdx;
+	_zoneSize = zone.leds_count;
+	return true;
+}
+
+void MatrixMapper::map( const Color * image, Color * zoneColors ) const noexcept
+{
+	const uint32_t * pixels = _pixels.data();
+	for (const Run & run : _runs)
+	{
+		gatherColors( zoneColors + run.firstLED, image, pixels, run.ledCount );
+		pixels += run.ledCount;
+	}
+}
+
+void MatrixMapper::mapRGBA( const uint8_t * image, Color * zoneColors ) const noexcept
+{
+	map( reinterpret_cast< const Color * >( image ), zoneColors );
+}
+
+void MatrixMapper::mapRGB( const uint8_t * image, Color * zoneColors ) const noexcept
+{
+	const uint32_t * pixels = _pixels.data();
+	for (const Run & run : _runs)
+	{
+		Color * colors = zoneColors + run.firstLED;
+		for (uint32_t i = 0; i < run.ledCount; ++i)
+		{
+			const uint8_t * pixel = image + size_t( pixels[i] ) * 3;
+			colors[i] = Color( pixel[0], pixel[1], pixel[2] );
+			colors[i].padding = 0;
+		}
+		pixels += run.ledCount;
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
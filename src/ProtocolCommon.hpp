@@ -16,11 +16,22 @@ MAKE_LITTLE_ENDIAN_DEFAULT
 #include <cstring>
 #include <string>
 #include <vector>
+#include <type_traits>
+
+// The protocol is little-endian, on such hosts the integers in memory already look exactly like on the wire.
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_WIN32)
+	#define OPENRGB_HOST_IS_LITTLE_ENDIAN 1
+#else
+	#define OPENRGB_HOST_IS_LITTLE_ENDIAN 0
+#endif
 
 
 namespace orgb {
 
 
+class Color;
+
+
 //======================================================================================================================
 // Putting these template functions into a struct allows us to collectively mark them as friend and allow them to access
 // methods of Mode, Zone, LED that should be private to the user of the library, but accessible to the library itself.
@@ -51,6 +62,62 @@ struct protocol
 		return !stream.hasFailed() && strlen( str.c_str() ) + 1 == size;
 	}
 
+	/// Moves past a string without copying it, consumes exactly as many bytes as readString().
+	static bool skipString( own::BinaryInputStream & stream ) noexcept
+	{
+		uint16_t size = 0;
+		stream >> size;
+		stream.skip( size > 0 ? size : 1 );
+		return !stream.hasFailed();
+	}
+
+
+	//-- plain sequences of trivial elements ---------------------------------------------------------------------------
+
+	/// Whether an array of this type has in memory exactly the same bytes as on the wire, so it can be copied as a whole.
+	template< typename Type >
+	static constexpr bool isWireIdentical() noexcept
+	{
+		return std::is_same< Type, Color >::value  // 4 single-byte components, endianness doesn't matter
+		    || (std::is_integral< Type >::value && (sizeof( Type ) == 1 || OPENRGB_HOST_IS_LITTLE_ENDIAN));
+	}
+
+	template< typename Type, typename std::enable_if< std::is_trivial<Type>::value, int >::type = 0 >
+	static void writeElements( own::BinaryOutputStream & stream, const Type * elems, size_t count )
+	{
+		if (isWireIdentical< Type >())
+		{
+			if (count > 0)
+				stream.writeBytes( own::const_byte_span( reinterpret_cast< const uint8_t * >( elems ), count * sizeof( Type ) ) );
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+				stream << elems[i];
+		}
+	}
+
+	template< typename Type, typename std::enable_if< std::is_trivial<Type>::value, int >::type = 0 >
+	static bool readElements( own::BinaryInputStream & stream, Type * elems, size_t count ) noexcept
+	{
+		if (isWireIdentical< Type >())
+		{
+			// a single bounds check and a single copy for the whole array
+			if (count > 0)
+				stream.readBytes( own::byte_span( reinterpret_cast< uint8_t * >( elems ), count * sizeof( Type ) ) );
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				stream >> elems[i];
+				if (stream.hasFailed())
+					return false;
+			}
+		}
+		return !stream.hasFailed();
+	}
+
 
 	//-- OpenRGB arrays ------------------------------------------------------------------------------------------------
 
@@ -81,6 +148,12 @@ struct protocol
 		return 2 + own::sizeofVector( vec );
 	}
 
+	template< typename Type, typename std::enable_if< std::is_trivial<Type>::value, int >::type = 0 >
+	static size_t sizeofArray( own::span< const Type > arr ) noexcept
+	{
+		return 2 + arr.size() * sizeof( Type );
+	}
+
 	static size_t sizeofArray( const std::vector< std::string > & vec ) noexcept
 	{
 		return 2 + sizeofVectorOfStrings( vec );
@@ -96,10 +169,14 @@ struct protocol
 	static void writeArray( own::BinaryOutputStream & stream, const std::vector< Type > & vec )
 	{
 		stream << uint16_t(vec.size());
-		for (const auto & elem : vec)
-		{
-			stream << elem;
-		}
+		writeElements( stream, vec.data(), vec.size() );
+	}
+
+	template< typename Type, typename std::enable_if< std::is_trivial<Type>::value, int >::type = 0 >
+	static void writeArray( own::BinaryOutputStream & stream, own::span< const Type > arr )
+	{
+		stream << uint16_t(arr.size());
+		writeElements( stream, arr.data(), arr.size() );
 	}
 
 	static void writeArray( own::BinaryOutputStream & stream, const std::vector< std::string > & vec )
@@ -126,14 +203,10 @@ struct protocol
 	{
 		uint16_t size = 0;
 		stream >> size;
+		if (stream.hasFailed())
+			return false;
 		vec.resize( size );
-		for (uint16_t i = 0; i < size; ++i)
-		{
-			stream >> vec[i];
-			if (stream.hasFailed())
-				return false;
-		}
-		return !stream.hasFailed();
+		return readElements( stream, vec.data(), vec.size() );
 	}
 
 	static bool readArray( own::BinaryInputStream & stream, std::vector< std::string > & vec ) noexcept
@@ -158,10 +231,11 @@ struct protocol
 		vec.reserve( size );
 		for (uint16_t i = 0; i < size; ++i)
 		{
-			Type obj;
-			if (!obj.deserialize( stream, protocolVersion, i, parentIdx ))
+			// The members are const, so a fully deserialized object can't be moved into the vector, only copied.
+			// Insert an empty one and deserialize it in place instead.
+			vec.push_back( Type() );
+			if (!vec.back().deserialize( stream, protocolVersion, i, parentIdx ))
 				return false;
-			vec.emplace_back( move(obj) );
 		}
 		return !stream.hasFailed();
 	}
@@ -140,7 +140,7 @@ uint32_t ReplyControllerData::calcDataSize( uint32_t protocolVersion ) const noe
 	size_t size = 0;
 
 	size += sizeof( data_size );
-	size += device_desc.calcSize( protocolVersion );
+	size += device_desc->calcSize( protocolVersion );
 
 	return uint32_t( size );
 }
@@ -150,17 +150,32 @@ void ReplyControllerData::serialize( BinaryOutputStream & stream, uint32_t proto
 	header.serialize( stream );
 
 	stream << data_size;
-	device_desc.serialize( stream, protocolVersion );
+	device_desc->serialize( stream, protocolVersion );
 }
 
 bool ReplyControllerData::deserializeBody( BinaryInputStream & stream, uint32_t protocolVersion ) noexcept
 {
 	stream >> data_size;
-	device_desc.deserialize( stream, protocolVersion, header.device_idx );
+	device_desc.reset( new Device );
+	device_desc->deserialize( stream, protocolVersion, header.device_idx );
 
 	return !stream.hasFailed();
 }
 
+bool ReplyControllerData::deserializeBodyLazily( own::const_byte_span body, uint32_t protocolVersion ) noexcept
+{
+	BinaryInputStream stream( body );
+	stream >> data_size;
+	if (stream.hasFailed())
+	{
+		return false;
+	}
+
+	device_desc.reset( new Device );
+	return device_desc->deserializeLazily( body.data() + sizeof( data_size ), body.size() - sizeof( data_size ),
+	                                       protocolVersion, header.device_idx );
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 void RequestProtocolVersion::serialize( BinaryOutputStream & stream, uint32_t /*protocolVersion*/ ) const
@@ -259,7 +274,8 @@ void UpdateLEDs::serialize( BinaryOutputStream & stream, uint32_t /*protocolVers
 bool UpdateLEDs::deserializeBody( BinaryInputStream & stream, uint32_t /*protocolVersion*/ ) noexcept
 {
 	stream >> data_size;
-	protocol::readArray( stream, colors );
+	protocol::readArray( stream, receivedColors );
+	colors = own::span< const Color >( receivedColors.data(), receivedColors.size() );
 
 	return !stream.hasFailed();
 }
@@ -290,7 +306,8 @@ bool UpdateZoneLEDs::deserializeBody( BinaryInputStream & stream, uint32_t /*pro
 {
 	stream >> data_size;
 	stream >> zone_idx;
-	protocol::readArray( stream, colors );
+	protocol::readArray( stream, receivedColors );
+	colors = own::span< const Color >( receivedColors.data(), receivedColors.size() );
 
 	return !stream.hasFailed();
 }
@@ -69,9 +69,12 @@ How to extend an existing message:
 #include "OpenRGB/DeviceInfo.hpp"
 #include "OpenRGB/Color.hpp"
 
+#include "ContainerUtils.hpp"  // span
+
 #include <cstdint>
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace own {
 	class BinaryOutputStream;
@@ -232,7 +235,9 @@ struct ReplyControllerData
 {
 	Header header;
 	uint32_t  data_size;  ///< must always be same as header.message_size, no idea why it's there twice
-	Device    device_desc;
+	/// A pointer, so that the device can be handed over to a DeviceList without copying it.
+	/** Device members are const, so moving a Device object actually copies all its strings and vectors. */
+	std::unique_ptr< Device >  device_desc;
 
  // support for templated processing
 
@@ -245,7 +250,7 @@ struct ReplyControllerData
 			/*message_type*/ thisType,
 			/*device_idx*/   deviceIdx
 		),
-		device_desc( device )
+		device_desc( new Device( device ) )
 	{
 		header.message_size = data_size = calcDataSize( protocolVersion );
 	}
@@ -253,6 +258,8 @@ struct ReplyControllerData
 	uint32_t calcDataSize( uint32_t protocolVersion ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t protocolVersion ) const;
 	bool deserializeBody( own::BinaryInputStream & stream, uint32_t protocolVersion ) noexcept;
+	/// Variant of deserializeBody() that leaves the modes and LEDs of the device to be decoded on the first access.
+	bool deserializeBodyLazily( own::const_byte_span body, uint32_t protocolVersion ) noexcept;
 };
 
 /// Tells the server in what version of the protocol the client wants to communite in.
@@ -402,19 +409,33 @@ struct ResizeZone
 	bool deserializeBody( own::BinaryInputStream & stream, uint32_t /*protocolVersion*/ = 0 ) noexcept;
 };
 
+/// Colors of a copy of a message, which must point to the copy's own received colors if the original pointed to its own.
+inline own::span< const Color > copiedColors( own::span< const Color > otherColors, const std::vector< Color > & otherReceived,
+                                             const std::vector< Color > & ownReceived ) noexcept
+{
+	if (otherColors.data() == otherReceived.data())
+		return own::span< const Color >( ownReceived.data(), ownReceived.size() );
+	else
+		return otherColors;
+}
+
 /// Applies individually selected color to every LED.
 struct UpdateLEDs
 {
 	Header  header;
 	uint32_t  data_size;
-	std::vector< Color >  colors;
+	/// The colors are not copied, they must stay alive until the message is serialized.
+	own::span< const Color >  colors;
+
+	/// When the message is deserialized, the colors are stored here and #colors points into it.
+	std::vector< Color >  receivedColors;
 
  // support for templated processing
 
 	static constexpr MessageType thisType = MessageType::RGBCONTROLLER_UPDATELEDS;
 
 	UpdateLEDs() noexcept {}
-	UpdateLEDs( uint32_t deviceIdx, const std::vector< Color > & colors )
+	UpdateLEDs( uint32_t deviceIdx, own::span< const Color > colors )
 	:
 		header(
 			/*message_type*/ thisType,
@@ -425,6 +446,27 @@ struct UpdateLEDs
 		header.message_size = data_size = calcDataSize();
 	}
 
+	// A copy of a received message must not point to the colors of the original, which may be destroyed first.
+	// Moving is fine, the moved vector keeps its buffer.
+	UpdateLEDs( const UpdateLEDs & other )
+	:
+		header( other.header ),
+		data_size( other.data_size ),
+		receivedColors( other.receivedColors )
+	{
+		colors = copiedColors( other.colors, other.receivedColors, receivedColors );
+	}
+	UpdateLEDs & operator=( const UpdateLEDs & other )
+	{
+		header = other.header;
+		data_size = other.data_size;
+		receivedColors = other.receivedColors;
+		colors = copiedColors( other.colors, other.receivedColors, receivedColors );
+		return *this;
+	}
+	UpdateLEDs( UpdateLEDs && other ) = default;
+	UpdateLEDs & operator=( UpdateLEDs && other ) = default;
+
 	uint32_t calcDataSize( uint32_t /*protocolVersion*/ = 0 ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t /*protocolVersion*/ = 0 ) const;
 	bool deserializeBody( own::BinaryInputStream & stream, uint32_t /*protocolVersion*/ = 0 ) noexcept;
@@ -436,14 +478,18 @@ struct UpdateZoneLEDs
 	Header  header;
 	uint32_t  data_size;
 	uint32_t  zone_idx;
-	std::vector< Color >  colors;
+	/// The colors are not copied, they must stay alive until the message is serialized.
+	own::span< const Color >  colors;
+
+	/// When the message is deserialized, the colors are stored here and #colors points into it.
+	std::vector< Color >  receivedColors;
 
  // support for templated processing
 
 	static constexpr MessageType thisType = MessageType::RGBCONTROLLER_UPDATEZONELEDS;
 
 	UpdateZoneLEDs() noexcept {}
-	UpdateZoneLEDs( uint32_t deviceIdx, uint32_t zoneIdx, const std::vector< Color > & colors )
+	UpdateZoneLEDs( uint32_t deviceIdx, uint32_t zoneIdx, own::span< const Color > colors )
 	:
 		header(
 			/*message_type*/ thisType,
@@ -455,6 +501,28 @@ struct UpdateZoneLEDs
 		header.message_size = data_size = calcDataSize();
 	}
 
+	// the same as UpdateLEDs
+	UpdateZoneLEDs( const UpdateZoneLEDs & other )
+	:
+		header( other.header ),
+		data_size( other.data_size ),
+		zone_idx( other.zone_idx ),
+		receivedColors( other.receivedColors )
+	{
+		colors = copiedColors( other.colors, other.receivedColors, receivedColors );
+	}
+	UpdateZoneLEDs & operator=( const UpdateZoneLEDs & other )
+	{
+		header = other.header;
+		data_size = other.data_size;
+		zone_idx = other.zone_idx;
+		receivedColors = other.receivedColors;
+		colors = copiedColors( other.colors, other.receivedColors, receivedColors );
+		return *this;
+	}
+	UpdateZoneLEDs( UpdateZoneLEDs && other ) = default;
+	UpdateZoneLEDs & operator=( UpdateZoneLEDs && other ) = default;
+
 	uint32_t calcDataSize( uint32_t /*protocolVersion*/ = 0 ) const noexcept;
 	void serialize( own::BinaryOutputStream & stream, uint32_t /*protocolVersion*/ = 0 ) const;
 	bool deserializeBody( own::BinaryInputStream & stream, uint32_t /*protocolVersion*/ = 0 ) noexcept;
@@ -0,0 +1,257 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: rendering of a light show into a file of ready-to-send messages
+//======================================================================================================================
+
+#include "OpenRGB/ShowCompiler.hpp"
+
+#include "Essential.hpp"
+
+#include "ShowFormat.hpp"
+#include "ProtocolMessages.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryOutputStream;
+#include "ContainerUtils.hpp"
+using own::span;
+
+#include <cstdio>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <chrono>
+using std::chrono::nanoseconds;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+ShowCompiler::~ShowCompiler() noexcept
+{
+	abandon();
+}
+
+void ShowCompiler::abandon() noexcept
+{
+	if (_file)
+	{
+		fclose( _file );
+		remove( _tempPath.c_str() );
+		_file = nullptr;
+	}
+	_failed = false;
+	_frameBuffer.clear();
+	_inFrame = false;
+	_fileOffset = 0;
+	_devices.clear();
+	_frames.clear();
+}
+
+bool ShowCompiler::open( const string & filePath ) noexcept
+{
+	abandon();
+
+	try {
+		_filePath = filePath;
+		_tempPath = filePath + ".tmp";
+	} catch (...) {
+		return false;
+	}
+
+	_file = fopen( _tempPath.c_str(), "wb" );
+	if (!_file)
+	{
+		return false;
+	}
+
+	// the header is written by finish(), when everything is known
+	const uint8_t placeholder [showHeaderSize] = {};
+	if (fwrite( placeholder, 1, sizeof(placeholder), _file ) != sizeof(placeholder))
+	{
+		abandon();
+		return false;
+	}
+	_fileOffset = showHeaderSize;
+
+	return true;
+}
+
+bool ShowCompiler::flushFrame() noexcept
+{
+	if (!_inFrame)
+	{
+		return true;
+	}
+	_inFrame = false;
+
+	FrameEntry & frame = _frames.back();
+	frame.offset = _fileOffset;
+	frame.size = uint32_t( _frameBuffer.size() );
+
+	if (!_frameBuffer.empty() && fwrite( _frameBuffer.data(), 1, _frameBuffer.size(), _file ) != _frameBuffer.size())
+	{
+		_failed = true;
+		return false;
+	}
+	_fileOffset += _frameBuffer.size();
+	_frameBuffer.clear();
+
+	return true;
+}
+
+bool ShowCompiler::beginFrame( nanoseconds time ) noexcept
+{
+	if (!_file || _failed || time.count() < 0 || (!_frames.empty() && time.count() < _frames.back().time))
+	{
+		return false;
+	}
+
+	if (!flushFrame())
+	{
+		return false;
+	}
+
+	try {
+		_frames.push_back({ time.count(), 0, 0, 0 });
+	} catch (...) {
+		return false;
+	}
+	_inFrame = true;
+
+	return true;
+}
+
+bool ShowCompiler::addDeviceColors( const Device & device, const Color * colors, size_t count ) noexcept
+{
+	// the protocol has only 16 bits for the number of colors
+	if (!_inFrame || count != device.leds.size() || count > UINT16_MAX)
+	{
+		return false;
+	}
+
+	try {
+
+		// the device table lets the player check that the show fits the devices of the server
+		auto pos = std::lower_bound( _devices.begin(), _devices.end(), device.idx,
+			[]( const DeviceEntry & entry, uint32_t deviceIdx ) { return entry.deviceIdx < deviceIdx; }
+		);
+		if (pos == _devices.end() || pos->deviceIdx != device.idx)
+		{
+			_devices.insert( pos, DeviceEntry{ device.idx, uint32_t( count ) } );
+		}
+		else if (pos->ledCount != count)
+		{
+			return false;  // the device list has changed in the middle of the show
+		}
+
+		// serialize the message exactly as the Client would send it
+		const UpdateLEDs message( device.idx, span< const Color >( colors, count ) );
+		size_t offset = _frameBuffer.size();
+		size_t messageSize = message.header.size() + message.header.message_size;
+		if (offset + messageSize > UINT32_MAX)
+		{
+			return false;
+		}
+		_frameBuffer.resize( offset + messageSize );
+		BinaryOutputStream stream( span< uint8_t >( _frameBuffer.data() + offset, messageSize ) );
+		message.serialize( stream );
+
+		_frames.back().messageCount++;
+		return true;
+
+	} catch (...) {
+		return false;
+	}
+}
+
+bool ShowCompiler::finish( nanoseconds duration ) noexcept
+{
+	if (!_file)
+	{
+		return false;
+	}
+	if (!flushFrame() || _failed)
+	{
+		abandon();
+		return false;
+	}
+
+	if (duration.count() <= 0 && !_frames.empty())
+	{
+		int64_t lastTime = _frames.back().time;
+		int64_t lastGap = _frames.size() > 1 ? lastTime - _frames[ _frames.size() - 2 ].time : 0;
+		duration = nanoseconds( lastTime + lastGap );
+	}
+
+	try {
+
+		const uint64_t deviceTableOffset = _fileOffset;
+		const uint64_t frameIndexOffset = deviceTableOffset + _devices.size() * showDeviceEntrySize;
+
+		vector< uint8_t > tables( _devices.size() * showDeviceEntrySize + _frames.size() * showFrameEntrySize );
+		BinaryOutputStream tableStream( span< uint8_t >( tables.data(), tables.size() ) );
+		for (const DeviceEntry & device : _devices)
+		{
+			tableStream << device.deviceIdx;
+			tableStream << device.ledCount;
+		}
+		for (const FrameEntry & frame : _frames)
+		{
+			tableStream << frame.time;
+			tableStream << frame.offset;
+			tableStream << frame.size;
+			tableStream << frame.messageCount;
+		}
+
+		uint8_t header [showHeaderSize];
+		BinaryOutputStream headerStream( span< uint8_t >( header, sizeof(header) ) );
+		headerStream.writeBytes( own::const_byte_span( showMagic, sizeof(showMagic) ) );
+		headerStream << uint32_t( _devices.size() );
+		headerStream << uint32_t( _frames.size() );
+		headerStream << int64_t( duration.count() );
+		headerStream << deviceTableOffset;
+		headerStream << frameIndexOffset;
+
+		bool written = fwrite( tables.data(), 1, tables.size(), _file ) == tables.size();
+		written = written && fseek( _file, 0, SEEK_SET ) == 0;
+		written = written && fwrite( header, 1, sizeof(header), _file ) == sizeof(header);
+		written = (fclose( _file ) == 0) && written;
+		_file = nullptr;
+		if (!written)
+		{
+			remove( _tempPath.c_str() );
+			abandon();
+			return false;
+		}
+
+		if (rename( _tempPath.c_str(), _filePath.c_str() ) != 0)
+		{
+			// Windows doesn't allow renaming over an existing file
+			remove( _filePath.c_str() );
+			if (rename( _tempPath.c_str(), _filePath.c_str() ) != 0)
+			{
+				remove( _tempPath.c_str() );
+				abandon();
+				return false;
+			}
+		}
+
+		abandon();  // only resets the state, the file is already closed
+		return true;
+
+	} catch (...) {
+		abandon();
+		return false;
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,55 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: format of the precompiled light show files
+//======================================================================================================================
+
+#ifndef OPENRGB_SHOW_FORMAT_INCLUDED
+#define OPENRGB_SHOW_FORMAT_INCLUDED
+
+
+#include <cstdint>
+#include <cstddef>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  file format
+//
+//  header:
+//    8 bytes  magic "ORGBSHW" followed by the format version
+//    uint32   number of devices
+//    uint32   number of frames
+//    int64    duration of the show in nanoseconds
+//    uint64   offset of the device table
+//    uint64   offset of the frame index
+//  messages of all frames:
+//    each frame is a sequence of complete messages (header + body) exactly as they go over the network,
+//    so that the player can send it straight from the mapped file in a single call
+//  device table, for every device the show sends colors to:
+//    uint32   device index
+//    uint32   number of LEDs
+//  frame index, for every frame in the order of their times:
+//    int64    time since the start of the show in nanoseconds
+//    uint64   offset of the first message of the frame
+//    uint32   size of all the messages of the frame
+//    uint32   number of the messages
+//
+//  All numbers are little-endian like in the OpenRGB protocol.
+
+static const uint8_t showMagic [8] = { 'O','R','G','B','S','H','W', 1 };
+static constexpr size_t showHeaderSize = sizeof(showMagic) + 2 * sizeof(uint32_t) + sizeof(int64_t) + 2 * sizeof(uint64_t);
+static constexpr size_t showDeviceEntrySize = 2 * sizeof(uint32_t);
+static constexpr size_t showFrameEntrySize = sizeof(int64_t) + sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_SHOW_FORMAT_INCLUDED
@@ -0,0 +1,440 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: playback of a light show precompiled by the ShowCompiler
+//======================================================================================================================
+
+#include "OpenRGB/ShowPlayer.hpp"
+
+#include "Essential.hpp"
+
+#include "ShowFormat.hpp"
+#include "MappedFile.hpp"
+#include "ProtocolMessages.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+
+#include <cstring>
+#include <string>
+using std::string;
+#include <memory>
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+#include <chrono>
+using std::chrono::nanoseconds;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  reading of the file
+
+namespace {
+
+struct ShowHeader
+{
+	uint8_t magic [sizeof(showMagic)];
+	uint32_t deviceCount;
+	uint32_t frameCount;
+	int64_t duration;
+	uint64_t deviceTableOffset;
+	uint64_t frameIndexOffset;
+};
+
+struct DeviceEntry
+{
+	uint32_t deviceIdx;
+	uint32_t ledCount;
+};
+
+struct FrameEntry
+{
+	int64_t time;
+	uint64_t offset;
+	uint32_t size;
+	uint32_t messageCount;
+};
+
+} // namespace
+
+static ShowHeader readShowHeader( const uint8_t * data ) noexcept
+{
+	ShowHeader header;
+	BinaryInputStream stream( own::const_byte_span( data, showHeaderSize ) );
+	stream.readBytes( own::byte_span( header.magic, sizeof(header.magic) ) );
+	stream >> header.deviceCount;
+	stream >> header.frameCount;
+	stream >> header.duration;
+	stream >> header.deviceTableOffset;
+	stream >> header.frameIndexOffset;
+	return header;
+}
+
+static DeviceEntry readDeviceEntry( const uint8_t * deviceTable, size_t entryIdx ) noexcept
+{
+	DeviceEntry entry;
+	BinaryInputStream stream( own::const_byte_span( deviceTable + entryIdx * showDeviceEntrySize, showDeviceEntrySize ) );
+	stream >> entry.deviceIdx;
+	stream >> entry.ledCount;
+	return entry;
+}
+
+static FrameEntry readFrameEntry( const uint8_t * frameIndex, size_t frameIdx ) noexcept
+{
+	FrameEntry entry;
+	BinaryInputStream stream( own::const_byte_span( frameIndex + frameIdx * showFrameEntrySize, showFrameEntrySize ) );
+	stream >> entry.time;
+	stream >> entry.offset;
+	stream >> entry.size;
+	stream >> entry.messageCount;
+	return entry;
+}
+
+/// Checks that the frame consists of exactly the declared number of UpdateLEDs messages for the devices of the show,
+/// each with the colors of all the LEDs of its device.
+static bool isValidFrame( const uint8_t * frame, const FrameEntry & entry, const uint8_t * deviceTable, size_t deviceCount ) noexcept
+{
+	size_t offset = 0;
+	uint32_t messageCount = 0;
+	while (offset < entry.size)
+	{
+		if (entry.size - offset < Header::size())
+		{
+			return false;
+		}
+		Header header;
+		BinaryInputStream stream( own::const_byte_span( frame + offset, Header::size() ) );
+		if (!header.deserialize( stream ) || header.message_type != MessageType::RGBCONTROLLER_UPDATELEDS)
+		{
+			return false;
+		}
+		if (header.message_size > entry.size - offset - Header::size())
+		{
+			return false;
+		}
+
+		// the table is ordered by the device index
+		size_t lo = 0, hi = deviceCount;
+		while (lo < hi)
+		{
+			size_t mid = (lo + hi) / 2;
+			if (readDeviceEntry( deviceTable, mid ).deviceIdx < header.device_idx)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == deviceCount || readDeviceEntry( deviceTable, lo ).deviceIdx != header.device_idx)
+		{
+			return false;
+		}
+		const DeviceEntry device = readDeviceEntry( deviceTable, lo );
+
+		// the body goes to the server as it is, so it must be exactly what the server expects for this device
+		uint32_t dataSize;
+		uint16_t colorCount;
+		const size_t bodyPrefixSize = sizeof(dataSize) + sizeof(colorCount);
+		if (header.message_size < bodyPrefixSize)
+		{
+			return false;
+		}
+		BinaryInputStream bodyStream( own::const_byte_span( frame + offset + Header::size(), bodyPrefixSize ) );
+		bodyStream >> dataSize;
+		bodyStream >> colorCount;
+		if (dataSize != header.message_size || colorCount != device.ledCount
+		 || header.message_size != bodyPrefixSize + size_t( colorCount ) * sizeof(Color))
+		{
+			return false;
+		}
+
+		offset += Header::size() + header.message_size;
+		messageCount++;
+	}
+	return messageCount == entry.messageCount;
+}
+
+
+//======================================================================================================================
+//  ShowPlayer
+
+ShowPlayer::ShowPlayer( Client & client ) noexcept
+:
+	_client( client ),
+	_deviceCount( 0 ),
+	_frameCount( 0 ),
+	_duration( 0 ),
+	_deviceTable( nullptr ),
+	_frameIndex( nullptr ),
+	_stopRequested( false ),
+	_isPlaying( false ),
+	_playedFrames( 0 ),
+	_skippedFrames( 0 ),
+	_lastFrameStatus( RequestStatus::Success )
+{}
+
+ShowPlayer::~ShowPlayer() noexcept
+{
+	stop();
+}
+
+bool ShowPlayer::open( const string & filePath ) noexcept
+{
+	close();
+
+	if (!_file)
+	{
+		_file.reset( new (std::nothrow) MappedFile );
+		if (!_file)
+		{
+			return false;
+		}
+	}
+	if (!_file->open( filePath ))
+	{
+		return false;
+	}
+
+	const uint8_t * data = _file->data();
+	const uint64_t size = _file->size();
+
+	// The file comes from outside, so everything is checked now and the playback can trust it.
+	bool valid = [&]()
+	{
+		if (size < showHeaderSize)
+		{
+			return false;
+		}
+		ShowHeader header = readShowHeader( data );
+		if (memcmp( header.magic, showMagic, sizeof(showMagic) ) != 0 || header.duration < 0)
+		{
+			return false;
+		}
+		// the counts are 32-bit, so the sizes of the tables can't overflow
+		if (header.deviceTableOffset < showHeaderSize || header.deviceTableOffset > size
+		 || header.deviceCount * uint64_t( showDeviceEntrySize ) > size - header.deviceTableOffset)
+		{
+			return false;
+		}
+		if (header.frameIndexOffset < showHeaderSize || header.frameIndexOffset > size
+		 || header.frameCount * uint64_t( showFrameEntrySize ) > size - header.frameIndexOffset)
+		{
+			return false;
+		}
+
+		const uint8_t * deviceTable = data + header.deviceTableOffset;
+		for (size_t i = 1; i < header.deviceCount; ++i)
+		{
+			if (readDeviceEntry( deviceTable, i - 1 ).deviceIdx >= readDeviceEntry( deviceTable, i ).deviceIdx)
+			{
+				return false;
+			}
+		}
+
+		const uint8_t * frameIndex = data + header.frameIndexOffset;
+		int64_t previousTime = 0;
+		for (size_t i = 0; i < header.frameCount; ++i)
+		{
+			FrameEntry frame = readFrameEntry( frameIndex, i );
+			if (frame.time < previousTime)
+			{
+				return false;
+			}
+			previousTime = frame.time;
+			if (frame.offset < showHeaderSize || frame.offset > size || frame.size > size - frame.offset)
+			{
+				return false;
+			}
+			if (!isValidFrame( data + frame.offset, frame, deviceTable, header.deviceCount ))
+			{
+				return false;
+			}
+		}
+
+		_deviceCount = header.deviceCount;
+		_frameCount = header.frameCount;
+		_duration = header.duration;
+		_deviceTable = deviceTable;
+		_frameIndex = frameIndex;
+		return true;
+	}();
+
+	if (!valid)
+	{
+		close();
+	}
+	return valid;
+}
+
+void ShowPlayer::close() noexcept
+{
+	stop();
+
+	if (_file)
+	{
+		_file->close();
+	}
+	_deviceCount = 0;
+	_frameCount = 0;
+	_duration = 0;
+	_deviceTable = nullptr;
+	_frameIndex = nullptr;
+}
+
+bool ShowPlayer::isOpen() const noexcept
+{
+	return _frameIndex != nullptr;
+}
+
+nanoseconds ShowPlayer::frameTime( size_t frameIdx ) const noexcept
+{
+	if (frameIdx >= _frameCount)
+	{
+		return nanoseconds( 0 );
+	}
+	return nanoseconds( readFrameEntry( _frameIndex, frameIdx ).time );
+}
+
+bool ShowPlayer::isCompatibleWith( const DeviceList & devices ) const noexcept
+{
+	if (!isOpen())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < _deviceCount; ++i)
+	{
+		DeviceEntry entry = readDeviceEntry( _deviceTable, i );
+		if (entry.deviceIdx >= devices.size() || devices[ entry.deviceIdx ].leds.size() != entry.ledCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+RequestStatus ShowPlayer::sendFrame( size_t frameIdx ) noexcept
+{
+	if (frameIdx >= _frameCount)
+	{
+		return RequestStatus::UnexpectedError;
+	}
+
+	FrameEntry frame = readFrameEntry( _frameIndex, frameIdx );
+	if (frame.size == 0)
+	{
+		return RequestStatus::Success;
+	}
+	return _client.sendPrecompiledMessages( _file->data() + frame.offset, frame.size );
+}
+
+bool ShowPlayer::start( bool loop ) noexcept
+{
+	unique_lock< mutex > lock( _threadMutex );
+
+	if (!isOpen() || _isPlaying)
+	{
+		return false;
+	}
+	// a show without looping may have finished by itself
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+
+	_stopRequested = false;
+	_playedFrames = 0;
+	_skippedFrames = 0;
+	_lastFrameStatus = RequestStatus::Success;
+	_isPlaying = true;
+	try {
+		_thread = std::thread( &ShowPlayer::playLoop, this, loop );
+		return true;
+	} catch (const std::system_error &) {
+		_isPlaying = false;
+		return false;
+	}
+}
+
+void ShowPlayer::stop() noexcept
+{
+	{
+		unique_lock< mutex > lock( _threadMutex );
+		_stopRequested = true;
+	}
+	_stopCond.notify_all();
+
+	if (_thread.joinable())
+	{
+		_thread.join();
+	}
+}
+
+size_t ShowPlayer::lastFrameDueAt( int64_t time ) const noexcept
+{
+	// the frames are ordered by their times
+	size_t lo = 0, hi = _frameCount;
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (readFrameEntry( _frameIndex, mid ).time <= time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo == 0 ? SIZE_MAX : lo - 1;
+}
+
+void ShowPlayer::playLoop( bool loop ) noexcept
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Deadlines are absolute, so that the time spent by sending doesn't add up into a drift.
+	Clock::time_point cycleStart = Clock::now();
+	size_t nextFrameIdx = 0;
+
+	unique_lock< mutex > lock( _threadMutex );
+	while (!_stopRequested)
+	{
+		if (nextFrameIdx >= _frameCount)
+		{
+			if (!loop || _duration <= 0 || _frameCount == 0)
+			{
+				break;
+			}
+			cycleStart += nanoseconds( _duration );
+			nextFrameIdx = 0;
+		}
+
+		Clock::time_point deadline = cycleStart + nanoseconds( readFrameEntry( _frameIndex, nextFrameIdx ).time );
+		if (_stopCond.wait_until( lock, deadline, [ this ]() { return _stopRequested; } ))
+		{
+			break;
+		}
+		lock.unlock();
+
+		// When we are late, send the newest frame that is due instead of all the missed ones in a burst.
+		int64_t elapsed = nanoseconds( Clock::now() - cycleStart ).count();
+		size_t frameIdx = lastFrameDueAt( elapsed );
+		if (frameIdx == SIZE_MAX || frameIdx < nextFrameIdx)
+		{
+			frameIdx = nextFrameIdx;
+		}
+		_skippedFrames += frameIdx - nextFrameIdx;
+
+		_lastFrameStatus = sendFrame( frameIdx );
+		_playedFrames++;
+		nextFrameIdx = frameIdx + 1;
+
+		lock.lock();
+	}
+
+	_isPlaying = false;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
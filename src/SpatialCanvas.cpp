@@ -0,0 +1,246 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: LEDs of all devices placed in one physical space, rendered by effects of the position
+//======================================================================================================================
+
+#include "OpenRGB/SpatialCanvas.hpp"
+
+#include "Essential.hpp"
+
+#include "OpenRGB/ThreadPool.hpp"
+#include "OpenRGB/DeviceFrame.hpp"
+#include "ColorModels.hpp"
+#include "EffectUtils.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+using std::vector;
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  SpatialCanvas
+
+/// Number of LEDs rendered by one thread at once, big enough to outweigh the synchronization.
+static constexpr size_t renderGrainSize = 4096;
+
+void SpatialCanvas::build( const DeviceList & devices, const SpatialLayout & layout ) noexcept
+{
+	clear();
+
+	size_t totalCount = 0;
+	for (const Device & device : devices)
+	{
+		totalCount += device.leds.size();
+	}
+
+	_devices.reserve( devices.size() );
+	_x.reserve( totalCount );
+	_y.reserve( totalCount );
+	_z.reserve( totalCount );
+
+	vector< Position > positions;
+	Position autoOrigin;
+	for (const Device & device : devices)
+	{
+		const size_t ledCount = device.leds.size();
+		_devices.push_back({ &device, _x.size(), ledCount });
+
+		positions.resize( ledCount );
+		float height = layout.computePositions( device, autoOrigin, positions.data() );
+		if (height > 0.0f)
+		{
+			autoOrigin.y += height + 2.0f;
+		}
+
+		// transpose into the separate arrays
+		for (const Position & position : positions)
+		{
+			_x.push_back( position.x );
+			_y.push_back( position.y );
+			_z.push_back( position.z );
+		}
+	}
+
+	_colors.assign( totalCount, Color::Black );
+
+	if (totalCount > 0)
+	{
+		_minCorner = Position( *std::min_element( _x.begin(), _x.end() ), *std::min_element( _y.begin(), _y.end() ), *std::min_element( _z.begin(), _z.end() ) );
+		_maxCorner = Position( *std::max_element( _x.begin(), _x.end() ), *std::max_element( _y.begin(), _y.end() ), *std::max_element( _z.begin(), _z.end() ) );
+	}
+}
+
+void SpatialCanvas::clear() noexcept
+{
+	_devices.clear();
+	_x.clear();
+	_y.clear();
+	_z.clear();
+	_colors.clear();
+	_minCorner = Position();
+	_maxCorner = Position();
+}
+
+const SpatialCanvas::DeviceRange * SpatialCanvas::rangeOf( const Device & device ) const noexcept
+{
+	if (device.idx >= _devices.size() || _devices[ device.idx ].device != &device)
+	{
+		return nullptr;
+	}
+	return &_devices[ device.idx ];
+}
+
+size_t SpatialCanvas::offsetOf( const Device & device ) const noexcept
+{
+	const DeviceRange * range = rangeOf( device );
+	return range ? range->firstLED : SIZE_MAX;
+}
+
+const Color * SpatialCanvas::colorsOf( const Device & device ) const noexcept
+{
+	const DeviceRange * range = rangeOf( device );
+	return range ? _colors.data() + range->firstLED : nullptr;
+}
+
+void SpatialCanvas::render( const SpatialEffect & effect, const FrameTime & time, ThreadPool * pool ) noexcept
+{
+	auto renderRange = [ this, &effect, &time ]( size_t begin, size_t end )
+	{
+		effect.render( _x.data() + begin, _y.data() + begin, _z.data() + begin, _colors.data() + begin, end - begin, time );
+	};
+
+	if (pool)
+	{
+		pool->parallelFor( _colors.size(), renderGrainSize, renderRange );
+	}
+	else
+	{
+		renderRange( 0, _colors.size() );
+	}
+}
+
+bool SpatialCanvas::copyTo( DeviceFrame & frame ) const noexcept
+{
+	const DeviceRange * range = rangeOf( frame.device() );
+	if (!range || range->ledCount != frame.size())
+	{
+		return false;
+	}
+	memcpy( frame.editColors(), _colors.data() + range->firstLED, range->ledCount * sizeof(Color) );
+	return true;
+}
+
+bool SpatialCanvas::copyTo( const Device & device, vector< Color > & deviceColors ) const noexcept
+{
+	const DeviceRange * range = rangeOf( device );
+	if (!range)
+	{
+		return false;
+	}
+	const Color * colors = _colors.data() + range->firstLED;
+	deviceColors.assign( colors, colors + range->ledCount );
+	return true;
+}
+
+
+//======================================================================================================================
+//  built-in spatial effects
+
+SpatialWaveEffect::SpatialWaveEffect( Position direction, float wavelength, float cyclesPerSecond, uint8_t saturation, uint8_t value ) noexcept
+:
+	_cyclesPerSecond( cyclesPerSecond ),
+	_saturation( saturation ),
+	_value( value )
+{
+	float length = std::sqrt( direction.x * direction.x + direction.y * direction.y + direction.z * direction.z );
+	float scale = (length > 0.0f && wavelength > 0.0f) ? 1.0f / (length * wavelength) : 0.0f;
+	_waveVector = Position( direction.x * scale, direction.y * scale, direction.z * scale );
+}
+
+void SpatialWaveEffect::render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+                                const FrameTime & time ) const noexcept
+{
+	// the time part is reduced to a fraction in double precision, so that the floats don't lose it after hours
+	const float timeCycles = float( fractionOf( time.seconds() * _cyclesPerSecond ) );
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float cycles = x[i] * _waveVector.x + y[i] * _waveVector.y + z[i] * _waveVector.z - timeCycles;
+		cycles -= std::floor( cycles );
+		// 1.0 can come out of the rounding, uint16_t then wraps it to 0 which is the same hue
+		uint16_t hue = uint16_t( uint32_t( cycles * 65536.0f ) );
+		colors[i] = hsvToColor( HSV( hue, _saturation, _value ) );
+	}
+}
+
+RippleEffect::RippleEffect( Position center, Color color, float wavelength, float speed ) noexcept
+:
+	_center( center ),
+	_color( color ),
+	_wavelength( wavelength > 0.0f ? wavelength : 1.0f ),
+	_speed( speed )
+{}
+
+void RippleEffect::render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+                           const FrameTime & time ) const noexcept
+{
+	const float timeCycles = float( fractionOf( time.seconds() * _speed / _wavelength ) );
+	const float cyclesPerUnit = 1.0f / _wavelength;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float dx = x[i] - _center.x;
+		float dy = y[i] - _center.y;
+		float dz = z[i] - _center.z;
+		float distance = std::sqrt( dx * dx + dy * dy + dz * dz );
+		float phase = (distance * cyclesPerUnit - timeCycles) * twoPiFloat;
+		uint32_t level = uint32_t( (0.5f + 0.5f * std::cos( phase )) * 255.0f + 0.5f );
+		colors[i] = makeColor( div255( _color.r * level ), div255( _color.g * level ), div255( _color.b * level ) );
+	}
+}
+
+
+PlasmaEffect::PlasmaEffect( float scale, float speed, uint8_t saturation, uint8_t value ) noexcept
+:
+	_frequency( twoPiFloat / (scale > 0.0f ? scale : 1.0f) ),
+	_speed( speed ),
+	_saturation( saturation ),
+	_value( value )
+{}
+
+void PlasmaEffect::render( const float * x, const float * y, const float * z, Color * colors, size_t count,
+                           const FrameTime & time ) const noexcept
+{
+	// the phases of the waves repeat, so they can be reduced in double precision like the other effects do
+	const double seconds = time.seconds() * _speed;
+	const float phase1 = float( fractionOf( seconds * 0.21 ) ) * twoPiFloat;
+	const float phase2 = float( fractionOf( seconds * 0.13 ) ) * twoPiFloat;
+	const float phase3 = float( fractionOf( seconds * 0.17 ) ) * twoPiFloat;
+	const float phase4 = float( fractionOf( seconds * 0.07 ) ) * twoPiFloat;
+	const float f = _frequency;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		float sum = std::sin( x[i] * f + phase1 )
+		          + std::sin( (y[i] + z[i]) * f * 0.8f - phase2 )
+		          + std::sin( (x[i] + y[i]) * f * 0.6f + phase3 )
+		          + std::sin( std::sqrt( x[i] * x[i] + y[i] * y[i] + z[i] * z[i] ) * f * 0.5f + phase4 );
+		// sum is in [-4, 4], the hue goes around the circle once over that range
+		uint16_t hue = uint16_t( int32_t( sum * 8192.0f ) );
+		colors[i] = hsvToColor( HSV( hue, _saturation, _value ) );
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,380 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: positions of devices, zones and LEDs in physical space
+//======================================================================================================================
+
+#include "OpenRGB/SpatialLayout.hpp"
+
+#include "Essential.hpp"
+
+#include "MappedFile.hpp"
+
+#include <cstdlib>
+#include <cctype>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+//  placements
+
+void SpatialLayout::placeDevice( Key device, Position origin )
+{
+	_devices.push_back({ std::move( device ), origin });
+}
+
+void SpatialLayout::placeZone( Key device, Key zone, Position origin )
+{
+	_zones.push_back({ std::move( device ), std::move( zone ), origin });
+}
+
+void SpatialLayout::placeLED( Key device, uint32_t ledIdx, Position position )
+{
+	_leds.push_back({ std::move( device ), ledIdx, position });
+}
+
+void SpatialLayout::clear() noexcept
+{
+	_devices.clear();
+	_zones.clear();
+	_leds.clear();
+	_errorLine = 0;
+}
+
+
+//======================================================================================================================
+//  file format
+
+/// Splits one line of the layout file into words, a word in quotes may contain spaces.
+class LineTokenizer
+{
+
+ public:
+
+	LineTokenizer( const char * begin, const char * end ) noexcept : _pos( begin ), _end( end ) {}
+
+	/// Reads the next word, \returns false when there is none or when a quote is not closed.
+	bool next( string & word, bool & quoted )
+	{
+		while (_pos < _end && isspace( uint8_t( *_pos ) ))
+			++_pos;
+		if (_pos == _end || (*_pos == '#' && _atLineStart))
+			return false;
+		_atLineStart = false;
+
+		quoted = *_pos == '"';
+		const char * wordBegin = quoted ? _pos + 1 : _pos;
+		const char * wordEnd = wordBegin;
+		if (quoted)
+		{
+			while (wordEnd < _end && *wordEnd != '"')
+				++wordEnd;
+			if (wordEnd == _end)
+				return false;
+			_pos = wordEnd + 1;
+		}
+		else
+		{
+			while (wordEnd < _end && !isspace( uint8_t( *wordEnd ) ))
+				++wordEnd;
+			_pos = wordEnd;
+		}
+		word.assign( wordBegin, wordEnd );
+		return true;
+	}
+
+	bool atEnd() noexcept
+	{
+		while (_pos < _end && isspace( uint8_t( *_pos ) ))
+			++_pos;
+		return _pos == _end;
+	}
+
+ private:
+
+	const char * _pos;
+	const char * _end;
+	bool _atLineStart = true;
+
+};
+
+static bool parseIndex( const string & word, uint32_t & idx ) noexcept
+{
+	if (word.empty() || !isdigit( uint8_t( word[0] ) ))
+		return false;
+	char * end = nullptr;
+	unsigned long value = strtoul( word.c_str(), &end, 10 );
+	if (*end != '\0' || value >= UINT32_MAX)
+		return false;
+	idx = uint32_t( value );
+	return true;
+}
+
+static bool parseKey( LineTokenizer & tokenizer, SpatialLayout::Key & key )
+{
+	string word;
+	bool quoted;
+	if (!tokenizer.next( word, quoted ))
+		return false;
+	if (quoted)
+	{
+		key = SpatialLayout::Key( std::move( word ) );
+		return !key.name.empty();
+	}
+	uint32_t idx;
+	if (word.size() < 2 || word[0] != '#' || !parseIndex( word.substr( 1 ), idx ))
+		return false;
+	key = SpatialLayout::Key( idx );
+	return true;
+}
+
+static bool parsePosition( LineTokenizer & tokenizer, Position & position )
+{
+	float * coords [3] = { &position.x, &position.y, &position.z };
+	for (float * coord : coords)
+	{
+		string word;
+		bool quoted;
+		if (!tokenizer.next( word, quoted ) || quoted || word.empty())
+			return false;
+		char * end = nullptr;
+		*coord = strtof( word.c_str(), &end );
+		if (*end != '\0')
+			return false;
+	}
+	return true;
+}
+
+bool SpatialLayout::parse( const char * text, size_t length ) noexcept
+{
+	try {
+
+		// parse into a copy, so that the layout stays unchanged when there is an error
+		SpatialLayout parsed;
+
+		const char * textEnd = text + length;
+		size_t lineNum = 0;
+		for (const char * lineBegin = text; lineBegin < textEnd; )
+		{
+			const char * lineEnd = std::find( lineBegin, textEnd, '\n' );
+			++lineNum;
+
+			LineTokenizer tokenizer( lineBegin, lineEnd );
+			string statement;
+			bool quoted;
+			if (tokenizer.next( statement, quoted ))  // otherwise an empty line or a comment
+			{
+				bool valid = false;
+				Key device, zone;
+				Position position;
+				if (statement == "device" && !quoted)
+				{
+					valid = parseKey( tokenizer, device ) && parsePosition( tokenizer, position );
+					if (valid)
+						parsed.placeDevice( std::move( device ), position );
+				}
+				else if (statement == "zone" && !quoted)
+				{
+					valid = parseKey( tokenizer, device ) && parseKey( tokenizer, zone ) && parsePosition( tokenizer, position );
+					if (valid)
+						parsed.placeZone( std::move( device ), std::move( zone ), position );
+				}
+				else if (statement == "led" && !quoted)
+				{
+					string word;
+					uint32_t ledIdx = 0;
+					valid = parseKey( tokenizer, device ) && tokenizer.next( word, quoted ) && !quoted
+					     && parseIndex( word, ledIdx ) && parsePosition( tokenizer, position );
+					if (valid)
+						parsed.placeLED( std::move( device ), ledIdx, position );
+				}
+				if (!valid || !tokenizer.atEnd())
+				{
+					_errorLine = lineNum;
+					return false;
+				}
+			}
+
+			lineBegin = lineEnd + 1;
+		}
+
+		_devices.insert( _devices.end(), parsed._devices.begin(), parsed._devices.end() );
+		_zones.insert( _zones.end(), parsed._zones.begin(), parsed._zones.end() );
+		_leds.insert( _leds.end(), parsed._leds.begin(), parsed._leds.end() );
+		_errorLine = 0;
+		return true;
+
+	} catch (const std::bad_alloc &) {
+		_errorLine = 0;
+		return false;
+	}
+}
+
+bool SpatialLayout::loadFromFile( const string & filePath ) noexcept
+{
+	MappedFile file;
+	if (!file.open( filePath ))
+	{
+		_errorLine = 0;
+		return false;
+	}
+	return parse( reinterpret_cast< const char * >( file.data() ), file.size() );
+}
+
+
+//======================================================================================================================
+//  computing the positions
+
+static bool matches( const SpatialLayout::Key & key, const Device & device ) noexcept
+{
+	return key.name.empty() ? key.idx == device.idx : key.name == device.name;
+}
+
+static bool matches( const SpatialLayout::Key & key, const Zone & zone ) noexcept
+{
+	return key.name.empty() ? key.idx == zone.idx : key.name == zone.name;
+}
+
+/// Puts the LEDs in a row starting at the origin.
+static void layoutRow( Position origin, Position * positions, size_t count ) noexcept
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		positions[i] = Position( origin.x + float( i ), origin.y, origin.z );
+	}
+}
+
+/// Lays out the LEDs of one zone, \returns the number of rows it takes.
+static unsigned int layoutZone( const Zone & zone, Position origin, Position * positions ) noexcept
+{
+	const size_t count = zone.leds_count;
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	if (zone.type == ZoneType::Single)
+	{
+		std::fill( positions, positions + count, origin );
+		return 1;
+	}
+
+	const size_t width = zone.matrix_width;
+	const size_t height = zone.matrix_height;
+	if (zone.type != ZoneType::Matrix || width == 0 || height == 0 || zone.matrix_values.size() != width * height)
+	{
+		layoutRow( origin, positions, count );
+		return 1;
+	}
+
+	// when an LED is in more cells, the first one wins, like in the MatrixMapper
+	vector< bool > placed( count, false );
+	for (size_t y = 0; y < height; ++y)
+	{
+		for (size_t x = 0; x < width; ++x)
+		{
+			uint32_t ledIdx = zone.matrix_values[ y * width + x ];
+			if (ledIdx < count && !placed[ ledIdx ])
+			{
+				positions[ ledIdx ] = Position( origin.x + float( x ), origin.y + float( y ), origin.z );
+				placed[ ledIdx ] = true;
+			}
+		}
+	}
+
+	// the LEDs that are not in the grid go in an extra row under it
+	float x = 0.0f;
+	for (size_t ledIdx = 0; ledIdx < count; ++ledIdx)
+	{
+		if (!placed[ ledIdx ])
+		{
+			positions[ ledIdx ] = Position( origin.x + x, origin.y + float( height ), origin.z );
+			x += 1.0f;
+		}
+	}
+	return unsigned( height ) + (x > 0.0f ? 1 : 0);
+}
+
+float SpatialLayout::computePositions( const Device & device, Position autoOrigin, Position * positions ) const noexcept
+{
+	const size_t ledCount = device.leds.size();
+
+	Position origin = autoOrigin;
+	bool isPlaced = false;
+	for (const DevicePlacement & placement : _devices)
+	{
+		if (matches( placement.device, device ))
+		{
+			origin = placement.origin;
+			isPlaced = true;
+		}
+	}
+
+	// the zones that are placed explicitly don't take any room in the automatic layout
+	float rowY = 0.0f;
+	size_t zonesEnd = 0;
+	for (const Zone & zone : device.zones)
+	{
+		if (size_t( zone.startIdx ) + zone.leds_count > ledCount)
+		{
+			break;  // the server reported more LEDs in the zones than in the device
+		}
+
+		const ZonePlacement * zonePlacement = nullptr;
+		for (const ZonePlacement & placement : _zones)
+		{
+			if (matches( placement.device, device ) && matches( placement.zone, zone ))
+			{
+				zonePlacement = &placement;
+			}
+		}
+
+		if (zonePlacement)
+		{
+			layoutZone( zone, zonePlacement->origin, positions + zone.startIdx );
+		}
+		else
+		{
+			Position zoneOrigin( origin.x, origin.y + rowY, origin.z );
+			unsigned int rows = layoutZone( zone, zoneOrigin, positions + zone.startIdx );
+			if (rows > 0)
+			{
+				rowY += float( rows ) + 1.0f;
+			}
+		}
+		zonesEnd = zone.startIdx + zone.leds_count;
+	}
+
+	// the LEDs that don't belong to any zone (if there are any)
+	if (zonesEnd < ledCount)
+	{
+		layoutRow( Position( origin.x, origin.y + rowY, origin.z ), positions + zonesEnd, ledCount - zonesEnd );
+		rowY += 2.0f;
+	}
+
+	for (const LEDPlacement & placement : _leds)
+	{
+		if (placement.ledIdx < ledCount && matches( placement.device, device ))
+		{
+			positions[ placement.ledIdx ] = placement.position;
+		}
+	}
+
+	// a device placed explicitly doesn't take any room in the automatic layout either,
+	// and the last gap between the zones is not part of the device
+	return !isPlaced && rowY > 0.0f ? rowY - 1.0f : 0.0f;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
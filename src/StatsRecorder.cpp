@@ -0,0 +1,251 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: per message type traffic counters and latency histograms of the client
+//======================================================================================================================
+
+#include "StatsRecorder.hpp"
+
+#ifndef NO_CLIENT_STATS
+
+#include <vector>
+using std::vector;
+#include <new>
+#include <chrono>
+using std::chrono::nanoseconds;
+using std::chrono::duration_cast;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+/// All the message types in the order of their IDs, the position is the index into StatsRecorder::_types.
+static const MessageType allMessageTypes [] =
+{
+	MessageType::REQUEST_CONTROLLER_COUNT,
+	MessageType::REQUEST_CONTROLLER_DATA,
+	MessageType::REQUEST_PROTOCOL_VERSION,
+	MessageType::SET_CLIENT_NAME,
+	MessageType::DEVICE_LIST_UPDATED,
+	MessageType::REQUEST_PROFILE_LIST,
+	MessageType::REQUEST_SAVE_PROFILE,
+	MessageType::REQUEST_LOAD_PROFILE,
+	MessageType::REQUEST_DELETE_PROFILE,
+	MessageType::RGBCONTROLLER_RESIZEZONE,
+	MessageType::RGBCONTROLLER_UPDATELEDS,
+	MessageType::RGBCONTROLLER_UPDATEZONELEDS,
+	MessageType::RGBCONTROLLER_UPDATESINGLELED,
+	MessageType::RGBCONTROLLER_SETCUSTOMMODE,
+	MessageType::RGBCONTROLLER_UPDATEMODE,
+	MessageType::RGBCONTROLLER_SAVEMODE,
+};
+
+static size_t typeIndex( MessageType type ) noexcept
+{
+	// the values of message types are wildly different so we can't use them as an index directly
+	for (size_t i = 0; i < sizeof(allMessageTypes) / sizeof(allMessageTypes[0]); ++i)
+		if (allMessageTypes[i] == type)
+			return i;
+	return size_t(-1);
+}
+
+/// Whether the server answers this message with a reply of the same type.
+static bool hasReply( MessageType type ) noexcept
+{
+	return type == MessageType::REQUEST_CONTROLLER_COUNT
+	    || type == MessageType::REQUEST_CONTROLLER_DATA
+	    || type == MessageType::REQUEST_PROTOCOL_VERSION
+	    || type == MessageType::REQUEST_PROFILE_LIST;
+}
+
+
+//======================================================================================================================
+
+StatsRecorder::StatsRecorder() noexcept
+{
+	static_assert( sizeof(allMessageTypes) / sizeof(allMessageTypes[0]) == typeCount, "update typeCount" );
+
+	for (auto & typeStats : _types)
+	{
+		typeStats.store( nullptr );
+	}
+}
+
+StatsRecorder::~StatsRecorder() noexcept
+{
+	for (auto & typeStats : _types)
+	{
+		delete typeStats.load();
+	}
+}
+
+StatsRecorder::TypeStats * StatsRecorder::statsOf( MessageType type ) noexcept
+{
+	size_t idx = typeIndex( type );
+	if (idx >= typeCount)
+	{
+		return nullptr;
+	}
+
+	TypeStats * typeStats = _types[ idx ].load( std::memory_order_acquire );
+	if (typeStats)
+	{
+		return typeStats;
+	}
+
+	// Two threads might meet a new type at the same time, only one of them gets to publish its allocation.
+	TypeStats * newStats = new (std::nothrow) TypeStats;
+	if (!newStats)
+	{
+		return nullptr;
+	}
+	if (!_types[ idx ].compare_exchange_strong( typeStats, newStats, std::memory_order_acq_rel ))
+	{
+		delete newStats;  // typeStats now contains the winner
+		return typeStats;
+	}
+	return newStats;
+}
+
+void StatsRecorder::messageQueued( MessageType type, size_t size )
+{
+	_batch.push_back({ type, uint32_t( size ) });
+}
+
+void StatsRecorder::batchSent( Clock::time_point startTime ) noexcept
+{
+	if (_batch.empty())
+	{
+		return;
+	}
+
+	Clock::time_point endTime = now();
+
+	for (const QueuedMessage & message : _batch)
+	{
+		if (TypeStats * typeStats = statsOf( message.type ))
+		{
+			typeStats->sentCount.fetch_add( 1, std::memory_order_relaxed );
+			typeStats->bytesSent.fetch_add( message.size, std::memory_order_relaxed );
+		}
+		if (hasReply( message.type ))
+		{
+			try {
+				_requestTimes.push_back( startTime );
+			} catch (...) {
+				// losing a single measurement is better than failing the request
+			}
+		}
+	}
+
+	if (TypeStats * typeStats = statsOf( _batch.front().type ))
+	{
+		typeStats->sendTime.record( duration_cast< nanoseconds >( endTime - startTime ) );
+	}
+
+	_batch.clear();
+}
+
+void StatsRecorder::batchCleared() noexcept
+{
+	_batch.clear();
+}
+
+void StatsRecorder::replyReceived( MessageType type, size_t size ) noexcept
+{
+	Clock::time_point arrivalTime = now();
+
+	TypeStats * typeStats = statsOf( type );
+	if (typeStats)
+	{
+		typeStats->receivedCount.fetch_add( 1, std::memory_order_relaxed );
+		typeStats->bytesReceived.fetch_add( size, std::memory_order_relaxed );
+	}
+
+	// the server answers in the order of the requests
+	if (!_requestTimes.empty())
+	{
+		if (typeStats)
+		{
+			typeStats->roundTrip.record( duration_cast< nanoseconds >( arrivalTime - _requestTimes.front() ) );
+		}
+		_requestTimes.pop_front();
+	}
+}
+
+void StatsRecorder::messageReceived( MessageType type, size_t size ) noexcept
+{
+	if (TypeStats * typeStats = statsOf( type ))
+	{
+		typeStats->receivedCount.fetch_add( 1, std::memory_order_relaxed );
+		typeStats->bytesReceived.fetch_add( size, std::memory_order_relaxed );
+	}
+}
+
+void StatsRecorder::repliesAbandoned() noexcept
+{
+	// a late reply would otherwise be paired with the send time of a later request
+	_requestTimes.clear();
+}
+
+ClientStats StatsRecorder::snapshot() const
+{
+	ClientStats stats;
+	stats.enabled = true;
+
+	for (size_t i = 0; i < typeCount; ++i)
+	{
+		const TypeStats * typeStats = _types[i].load( std::memory_order_acquire );
+		if (!typeStats)
+		{
+			continue;
+		}
+
+		MessageTypeStats output;
+		output.messageType = uint32_t( allMessageTypes[i] );
+		output.messageName = enumString( allMessageTypes[i] );
+		output.sentCount = typeStats->sentCount.load( std::memory_order_relaxed );
+		output.bytesSent = typeStats->bytesSent.load( std::memory_order_relaxed );
+		output.receivedCount = typeStats->receivedCount.load( std::memory_order_relaxed );
+		output.bytesReceived = typeStats->bytesReceived.load( std::memory_order_relaxed );
+		output.sendTime = typeStats->sendTime.summarize();
+		output.roundTrip = typeStats->roundTrip.summarize();
+
+		// after a reset the type stays allocated, but there is nothing to show
+		if (output.sentCount != 0 || output.receivedCount != 0)
+		{
+			stats.messageTypes.push_back( output );
+		}
+	}
+
+	return stats;
+}
+
+void StatsRecorder::reset() noexcept
+{
+	for (auto & typeStatsPtr : _types)
+	{
+		TypeStats * typeStats = typeStatsPtr.load( std::memory_order_acquire );
+		if (typeStats)
+		{
+			typeStats->sentCount.store( 0, std::memory_order_relaxed );
+			typeStats->bytesSent.store( 0, std::memory_order_relaxed );
+			typeStats->receivedCount.store( 0, std::memory_order_relaxed );
+			typeStats->bytesReceived.store( 0, std::memory_order_relaxed );
+			typeStats->sendTime.reset();
+			typeStats->roundTrip.reset();
+		}
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // NO_CLIENT_STATS
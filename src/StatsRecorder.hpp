@@ -0,0 +1,123 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: per message type traffic counters and latency histograms of the client
+//======================================================================================================================
+
+#ifndef OPENRGB_STATS_RECORDER_INCLUDED
+#define OPENRGB_STATS_RECORDER_INCLUDED
+
+
+#include "Essential.hpp"
+
+#include "ProtocolMessages.hpp"  // MessageType
+#include "OpenRGB/ClientStats.hpp"
+#ifndef NO_CLIENT_STATS
+	#include "LatencyHistogram.hpp"
+#endif
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+/// Collects the data for Client::stats().
+/** The counters and histograms are lock-free, so any thread can record while another one takes a snapshot.
+  * The send batch must only be used by the thread holding the send lock of the client and the request times only by
+  * the thread holding the request lock, the client already serializes those.
+  *
+  * When the library is built with NO_CLIENT_STATS, all the methods are empty inline functions and no clock is ever
+  * read, so the compiler removes the instrumentation entirely. */
+
+class StatsRecorder
+{
+
+ public:
+
+	using Clock = std::chrono::steady_clock;
+
+#ifndef NO_CLIENT_STATS
+
+	StatsRecorder() noexcept;
+	~StatsRecorder() noexcept;
+
+	static Clock::time_point now() noexcept  { return Clock::now(); }
+
+	/// Notes a message that has been serialized into the send buffer.
+	void messageQueued( MessageType type, size_t size );
+	/// The messages queued since the last call have been successfully sent, in a system call that started at startTime.
+	void batchSent( Clock::time_point startTime ) noexcept;
+	/// The send buffer has been cleared, the messages queued since the last call are not going to be sent.
+	void batchCleared() noexcept;
+
+	/// A reply to the oldest request still waiting for it has been received.
+	void replyReceived( MessageType type, size_t size ) noexcept;
+	/// A message that isn't a reply to any request has been received.
+	void messageReceived( MessageType type, size_t size ) noexcept;
+	/// No replies are going to come for the requests sent so far, for example because waiting for one has failed.
+	void repliesAbandoned() noexcept;
+
+	ClientStats snapshot() const;
+	void reset() noexcept;
+
+ private:
+
+	struct TypeStats
+	{
+		std::atomic< uint64_t > sentCount { 0 };
+		std::atomic< uint64_t > bytesSent { 0 };
+		std::atomic< uint64_t > receivedCount { 0 };
+		std::atomic< uint64_t > bytesReceived { 0 };
+		LatencyHistogram sendTime;
+		LatencyHistogram roundTrip;
+	};
+
+	/// Returns the stats of the message type, allocating them on first use, or nullptr if the type is invalid.
+	TypeStats * statsOf( MessageType type ) noexcept;
+
+	// The histograms take a few kilobytes each and a client typically uses only a few message types,
+	// so they are allocated lazily. Once published, the pointers never change until destruction.
+	static constexpr size_t typeCount = 16;
+	std::atomic< TypeStats * > _types [ typeCount ];
+
+	struct QueuedMessage
+	{
+		MessageType type;
+		uint32_t size;
+	};
+	std::vector< QueuedMessage > _batch;  ///< messages in the send buffer, reused for every batch
+	std::deque< Clock::time_point > _requestTimes;  ///< send times of the requests waiting for their replies, oldest first
+
+#else // NO_CLIENT_STATS
+
+	static Clock::time_point now() noexcept  { return Clock::time_point(); }
+
+	void messageQueued( MessageType, size_t ) noexcept {}
+	void batchSent( Clock::time_point ) noexcept {}
+	void batchCleared() noexcept {}
+	void replyReceived( MessageType, size_t ) noexcept {}
+	void messageReceived( MessageType, size_t ) noexcept {}
+	void repliesAbandoned() noexcept {}
+
+	ClientStats snapshot() const  { return ClientStats(); }
+	void reset() noexcept {}
+
+#endif // NO_CLIENT_STATS
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
+
+
+#endif // OPENRGB_STATS_RECORDER_INCLUDED
@@ -0,0 +1,236 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: pool of threads for splitting the rendering of a frame over the CPU cores
+//======================================================================================================================
+
+#include "OpenRGB/ThreadPool.hpp"
+
+#include "Essential.hpp"
+
+#include <cstdint>
+#include <new>  // placement new
+#include <memory>  // align
+#include <algorithm>
+#include <functional>
+using std::function;
+#include <thread>
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+
+
+namespace orgb {
+
+
+//======================================================================================================================
+
+static uint64_t packRange( uint32_t begin, uint32_t end ) noexcept
+{
+	return (uint64_t( end ) << 32) | begin;
+}
+
+ThreadPool::ThreadPool( unsigned int threadCount ) noexcept
+:
+	_stopRequested( false ),
+	_generation( 0 ),
+	_busyWorkers( 0 ),
+	_func( nullptr ),
+	_count( 0 ),
+	_grainSize( 1 ),
+	_queues( nullptr )
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max( std::thread::hardware_concurrency(), 1u );
+	}
+
+	for (unsigned int i = 1; i < threadCount; ++i)
+	{
+		try {
+			_workers.emplace_back( &ThreadPool::workerLoop, this, i - 1 );
+		} catch (const std::system_error &) {
+			break;  // we can still work with the threads we have
+		}
+	}
+
+	// The workers don't touch the queues until the first parallelFor().
+	// The queues must start at a cache line boundary, otherwise each of them would share a line with its neighbour.
+	const size_t queueCount = _workers.size() + 1;
+	size_t space = queueCount * sizeof(ChunkQueue) + alignof(ChunkQueue);
+	_queueStorage.reset( new uint8_t [ space ] );
+	void * queuesStart = _queueStorage.get();
+	std::align( alignof(ChunkQueue), queueCount * sizeof(ChunkQueue), queuesStart, space );
+	_queues = static_cast< ChunkQueue * >( queuesStart );
+	for (size_t i = 0; i < queueCount; ++i)
+	{
+		new (&_queues[i]) ChunkQueue;  // the atomic is trivially destructible, nothing needs to be destroyed later
+		_queues[i].range = 0;
+	}
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+	{
+		unique_lock< mutex > lock( _mutex );
+		_stopRequested = true;
+	}
+	_workAvailable.notify_all();
+
+	for (std::thread & worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::parallelFor( size_t count, size_t grainSize, const function< void ( size_t, size_t ) > & func ) noexcept
+{
+	if (count == 0)
+	{
+		return;
+	}
+	// the chunk indexes must fit into 32 bits
+	grainSize = std::max( grainSize, (count - 1) / UINT32_MAX + 1 );
+	size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+	// not worth waking anyone up
+	if (_workers.empty() || chunkCount == 1)
+	{
+		func( 0, count );
+		return;
+	}
+
+	unique_lock< mutex > callLock( _callMutex );
+
+	const unsigned int queueCount = threadCount();
+	const unsigned int callerQueueIdx = queueCount - 1;
+	{
+		unique_lock< mutex > lock( _mutex );
+
+		// a worker may still be leaving the previous work
+		_workersIdle.wait( lock, [ this ]() { return _busyWorkers == 0; } );
+
+		_func = &func;
+		_count = count;
+		_grainSize = grainSize;
+		for (unsigned int queueIdx = 0; queueIdx < queueCount; ++queueIdx)
+		{
+			uint32_t begin = uint32_t( chunkCount * queueIdx / queueCount );
+			uint32_t end = uint32_t( chunkCount * (queueIdx + 1) / queueCount );
+			_queues[ queueIdx ].range.store( packRange( begin, end ), std::memory_order_relaxed );
+		}
+		_generation++;
+	}
+	_workAvailable.notify_all();
+
+	processChunks( callerQueueIdx );
+
+	// all chunks are taken, but some may still be in progress
+	unique_lock< mutex > lock( _mutex );
+	_workersIdle.wait( lock, [ this ]() { return _busyWorkers == 0; } );
+	_func = nullptr;
+}
+
+bool ThreadPool::takeOwnChunk( unsigned int queueIdx, size_t & chunkIdx ) noexcept
+{
+	std::atomic< uint64_t > & range = _queues[ queueIdx ].range;
+	uint64_t current = range.load( std::memory_order_relaxed );
+	while (true)
+	{
+		uint32_t begin = uint32_t( current );
+		uint32_t end = uint32_t( current >> 32 );
+		if (begin >= end)
+		{
+			return false;
+		}
+		if (range.compare_exchange_weak( current, packRange( begin + 1, end ), std::memory_order_relaxed ))
+		{
+			chunkIdx = begin;
+			return true;
+		}
+	}
+}
+
+bool ThreadPool::stealChunk( unsigned int queueIdx, size_t & chunkIdx ) noexcept
+{
+	const unsigned int queueCount = threadCount();
+
+	// start with the neighbour, so that the thieves don't all go after the same victim
+	for (unsigned int i = 1; i < queueCount; ++i)
+	{
+		std::atomic< uint64_t > & range = _queues[ (queueIdx + i) % queueCount ].range;
+		uint64_t current = range.load( std::memory_order_relaxed );
+		while (true)
+		{
+			uint32_t begin = uint32_t( current );
+			uint32_t end = uint32_t( current >> 32 );
+			if (begin >= end)
+			{
+				break;
+			}
+			if (range.compare_exchange_weak( current, packRange( begin, end - 1 ), std::memory_order_relaxed ))
+			{
+				chunkIdx = end - 1;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void ThreadPool::processChunk( size_t chunkIdx ) noexcept
+{
+	size_t begin = chunkIdx * _grainSize;
+	size_t end = std::min( begin + _grainSize, _count );
+	(*_func)( begin, end );
+}
+
+void ThreadPool::processChunks( unsigned int queueIdx ) noexcept
+{
+	size_t chunkIdx;
+	while (takeOwnChunk( queueIdx, chunkIdx ))
+	{
+		processChunk( chunkIdx );
+	}
+	// The chunks are never added back, so when no queue has any left, everything is taken.
+	while (stealChunk( queueIdx, chunkIdx ))
+	{
+		processChunk( chunkIdx );
+	}
+}
+
+void ThreadPool::workerLoop( unsigned int queueIdx ) noexcept
+{
+	uint64_t lastGeneration = 0;
+
+	unique_lock< mutex > lock( _mutex );
+	while (true)
+	{
+		_workAvailable.wait( lock, [ this, lastGeneration ]() { return _stopRequested || _generation != lastGeneration; } );
+		if (_stopRequested)
+		{
+			break;
+		}
+		lastGeneration = _generation;
+
+		// While we are busy, the description of the work can't change under our hands.
+		// If the work is already finished, we only find out there are no chunks left.
+		_busyWorkers++;
+		lock.unlock();
+
+		processChunks( queueIdx );
+
+		lock.lock();
+		if (--_busyWorkers == 0)
+		{
+			_workersIdle.notify_all();
+		}
+	}
+}
+
+
+//======================================================================================================================
+
+
+} // namespace orgb
@@ -0,0 +1,116 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: counting of heap allocations made by a piece of code
+//======================================================================================================================
+
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+//======================================================================================================================
+//  replacement of the global allocation functions
+
+// Plain thread-locals without constructors, so that they are usable even before the main() starts.
+static thread_local bool isCounting = false;
+static thread_local uint64_t allocationCount = 0;
+
+static void * allocate( std::size_t size ) noexcept
+{
+	if (isCounting)
+	{
+		allocationCount++;
+	}
+	return std::malloc( size ? size : 1 );
+}
+
+void * operator new( std::size_t size )
+{
+	void * ptr = allocate( size );
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void * operator new[]( std::size_t size )
+{
+	return operator new( size );
+}
+
+void * operator new( std::size_t size, const std::nothrow_t & ) noexcept
+{
+	return allocate( size );
+}
+
+void * operator new[]( std::size_t size, const std::nothrow_t & ) noexcept
+{
+	return allocate( size );
+}
+
+void operator delete( void * ptr ) noexcept
+{
+	std::free( ptr );
+}
+
+void operator delete[]( void * ptr ) noexcept
+{
+	std::free( ptr );
+}
+
+void operator delete( void * ptr, const std::nothrow_t & ) noexcept
+{
+	std::free( ptr );
+}
+
+void operator delete[]( void * ptr, const std::nothrow_t & ) noexcept
+{
+	std::free( ptr );
+}
+
+void operator delete( void * ptr, std::size_t ) noexcept
+{
+	std::free( ptr );
+}
+
+void operator delete[]( void * ptr, std::size_t ) noexcept
+{
+	std::free( ptr );
+}
+
+
+namespace orgb {
+namespace bench {
+
+
+//======================================================================================================================
+//  AllocationCounter
+
+AllocationCounter::AllocationCounter() noexcept
+:
+	_startCount( allocationCount ),
+	_wasCounting( isCounting )
+{
+	isCounting = true;
+}
+
+AllocationCounter::~AllocationCounter() noexcept
+{
+	isCounting = _wasCounting;
+}
+
+uint64_t AllocationCounter::count() const noexcept
+{
+	return allocationCount - _startCount;
+}
+
+
+//======================================================================================================================
+
+
+} // namespace bench
+} // namespace orgb
@@ -0,0 +1,54 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: counting of heap allocations made by a piece of code
+//======================================================================================================================
+
+#ifndef OPENRGB_ALLOCATION_COUNTER_INCLUDED
+#define OPENRGB_ALLOCATION_COUNTER_INCLUDED
+
+
+#include <cstdint>
+
+
+namespace orgb {
+namespace bench {
+
+
+//======================================================================================================================
+/// Counts the calls of the global operator new made by the current thread while it exists.
+/** The benchmark executable replaces the global operator new, so this sees every allocation of the library,
+  * including those of the standard containers. Allocations of the other threads, like the ones of the mock server
+  * running in the same process, are not counted. */
+
+class AllocationCounter
+{
+
+ public:
+
+	AllocationCounter() noexcept;
+	~AllocationCounter() noexcept;
+
+	AllocationCounter( const AllocationCounter & other ) = delete;
+	AllocationCounter & operator=( const AllocationCounter & other ) = delete;
+
+	/// Number of allocations made by this thread since the construction.
+	uint64_t count() const noexcept;
+
+ private:
+
+	uint64_t _startCount;
+	bool _wasCounting;  ///< counters can be nested
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace bench
+} // namespace orgb
+
+
+#endif // OPENRGB_ALLOCATION_COUNTER_INCLUDED
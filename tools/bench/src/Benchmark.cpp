@@ -0,0 +1,190 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: minimal benchmark harness with JSON output
+//======================================================================================================================
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <algorithm>
+#include <ostream>
+using std::ostream;
+
+
+namespace orgb {
+namespace bench {
+
+
+//======================================================================================================================
+//  JSON helpers
+
+static void writeJsonString( ostream & os, const string & str )
+{
+	os << '"';
+	for (char c : str)
+	{
+		switch (c)
+		{
+			case '"':  os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if (uint8_t( c ) < 0x20)
+				{
+					char escaped [8];
+					snprintf( escaped, sizeof( escaped ), "\\u%04x", unsigned( c ) );
+					os << escaped;
+				}
+				else
+				{
+					os << c;
+				}
+		}
+	}
+	os << '"';
+}
+
+static void writeJsonNumber( ostream & os, double number )
+{
+	// JSON doesn't allow nan or inf
+	if (number != number || number > 1e300 || number < -1e300)
+	{
+		os << "null";
+		return;
+	}
+	char formatted [32];
+	snprintf( formatted, sizeof( formatted ), "%.6g", number );
+	os << formatted;
+}
+
+static string currentTimeUTC()
+{
+	time_t now = time( nullptr );
+	struct tm utc;
+ #ifdef _WIN32
+	gmtime_s( &utc, &now );
+ #else
+	gmtime_r( &now, &utc );
+ #endif
+	char formatted [32];
+	strftime( formatted, sizeof( formatted ), "%Y-%m-%dT%H:%M:%SZ", &utc );
+	return formatted;
+}
+
+static string compilerName()
+{
+ #if defined(__clang__)
+	return string("clang ") + __clang_version__;
+ #elif defined(__GNUC__)
+	return string("gcc ") + __VERSION__;
+ #elif defined(_MSC_VER)
+	return "msvc " + std::to_string( _MSC_VER );
+ #else
+	return "unknown";
+ #endif
+}
+
+
+//======================================================================================================================
+//  BenchRunner
+
+bool BenchRunner::isSelected( const string & name ) const
+{
+	return _config.filter.empty() || name.find( _config.filter ) != string::npos;
+}
+
+void BenchRunner::addResult( const BenchResult & result )
+{
+	_results.push_back( result );
+
+	// progress to stderr, so that it doesn't mix with the JSON on stdout
+	fprintf( stderr, "%-48s %12.1f ns/op", result.name.c_str(), result.nsPerOpMedian );
+	if (result.bytesPerSecond > 0.0)
+	{
+		fprintf( stderr, " %10.1f MB/s", result.bytesPerSecond / 1e6 );
+	}
+	for (const auto & counter : result.counters)
+	{
+		fprintf( stderr, " %s=%.1f", counter.first.c_str(), counter.second );
+	}
+	fprintf( stderr, "\n" );
+}
+
+BenchResult BenchRunner::makeResult( const string & name, uint64_t iterations, vector< double > nsPerOp, size_t bytesPerOp )
+{
+	BenchResult result;
+	result.name = name;
+	result.iterations = iterations;
+	if (!nsPerOp.empty())
+	{
+		std::sort( nsPerOp.begin(), nsPerOp.end() );
+		result.nsPerOpMedian = nsPerOp[ nsPerOp.size() / 2 ];
+		result.nsPerOpMin = nsPerOp.front();
+		result.nsPerOpMax = nsPerOp.back();
+	}
+	if (bytesPerOp > 0 && result.nsPerOpMedian > 0.0)
+	{
+		result.bytesPerSecond = double( bytesPerOp ) * 1e9 / result.nsPerOpMedian;
+	}
+	return result;
+}
+
+void BenchRunner::writeJson( ostream & os ) const
+{
+	os << "{\n";
+	os << "  \"context\": {\n";
+	os << "    \"date\": "; writeJsonString( os, currentTimeUTC() ); os << ",\n";
+	os << "    \"compiler\": "; writeJsonString( os, compilerName() ); os << ",\n";
+ #ifdef NDEBUG
+	os << "    \"assertions\": false,\n";
+ #else
+	os << "    \"assertions\": true,\n";
+ #endif
+	os << "    \"min_time_ms\": " << _config.minTime.count() << ",\n";
+	os << "    \"repeats\": " << _config.repeats << "\n";
+	os << "  },\n";
+
+	os << "  \"benchmarks\": [";
+	for (size_t i = 0; i < _results.size(); ++i)
+	{
+		const BenchResult & result = _results[i];
+		os << (i == 0 ? "\n" : ",\n");
+		os << "    {\n";
+		os << "      \"name\": "; writeJsonString( os, result.name ); os << ",\n";
+		os << "      \"iterations\": " << result.iterations << ",\n";
+		os << "      \"ns_per_op\": "; writeJsonNumber( os, result.nsPerOpMedian ); os << ",\n";
+		os << "      \"ns_per_op_min\": "; writeJsonNumber( os, result.nsPerOpMin ); os << ",\n";
+		os << "      \"ns_per_op_max\": "; writeJsonNumber( os, result.nsPerOpMax ); os << ",\n";
+		os << "      \"bytes_per_second\": "; writeJsonNumber( os, result.bytesPerSecond );
+		if (!result.counters.empty())
+		{
+			os << ",\n      \"counters\": {";
+			for (size_t j = 0; j < result.counters.size(); ++j)
+			{
+				os << (j == 0 ? " " : ", ");
+				writeJsonString( os, result.counters[j].first );
+				os << ": ";
+				writeJsonNumber( os, result.counters[j].second );
+			}
+			os << " }";
+		}
+		os << "\n    }";
+	}
+	os << (_results.empty() ? "]\n" : "\n  ]\n");
+	os << "}\n";
+}
+
+
+//======================================================================================================================
+
+
+} // namespace bench
+} // namespace orgb
@@ -0,0 +1,144 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: minimal benchmark harness with JSON output
+//======================================================================================================================
+
+#ifndef OPENRGB_BENCHMARK_INCLUDED
+#define OPENRGB_BENCHMARK_INCLUDED
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+
+namespace orgb {
+namespace bench {
+
+
+//======================================================================================================================
+
+/// Prevents the compiler from optimizing away a computation whose result is otherwise unused.
+template< typename Type >
+inline void doNotOptimize( const Type & value )
+{
+ #if defined(__GNUC__) || defined(__clang__)
+	asm volatile( "" : : "r"( &value ) : "memory" );
+ #else
+	static const void * volatile sink;
+	sink = &value;
+ #endif
+}
+
+struct BenchConfig
+{
+	std::string filter;                                ///< run only the benchmarks whose name contains this
+	std::chrono::milliseconds minTime { 500 };         ///< minimal total measured time of each benchmark
+	unsigned int repeats = 5;                          ///< number of measured batches, the median of them is reported
+};
+
+struct BenchResult
+{
+	std::string name;
+	uint64_t iterations = 0;       ///< total number of measured operations
+	double nsPerOpMedian = 0.0;
+	double nsPerOpMin = 0.0;
+	double nsPerOpMax = 0.0;
+	double bytesPerSecond = 0.0;   ///< 0 if the benchmark doesn't process any bytes
+	/// additional benchmark-specific values, like frames per second
+	std::vector< std::pair< std::string, double > > counters;
+};
+
+
+//======================================================================================================================
+/// Runs the benchmarks and collects their results.
+/** Each benchmark is first calibrated to find a number of iterations that takes roughly minTime / repeats,
+  * then the batch of iterations is measured repeats times and the median time per operation is reported,
+  * because it's not affected by occasional scheduler hiccups as much as the mean. */
+
+class BenchRunner
+{
+
+ public:
+
+	BenchRunner( const BenchConfig & config ) : _config( config ) {}
+
+	/// Whether the benchmark of this name should run according to the filter.
+	bool isSelected( const std::string & name ) const;
+
+	/// Measures the operation and stores the result.
+	/** \param bytesPerOp number of bytes processed by one operation, for computing the throughput, may be 0 */
+	template< typename Operation >
+	void run( const std::string & name, size_t bytesPerOp, Operation operation )
+	{
+		if (!isSelected( name ))
+			return;
+
+		// calibrate: double the batch until it takes long enough to be measured reliably
+		std::chrono::nanoseconds batchTime = _config.minTime / std::max( _config.repeats, 1u );
+		uint64_t batchSize = 1;
+		for (;;)
+		{
+			auto duration = measureBatch( batchSize, operation );
+			if (duration >= batchTime || batchSize >= (uint64_t(1) << 40))
+				break;
+			// jump closer to the target when the batch is still far too short
+			batchSize = duration.count() > 0 && duration * 8 < batchTime
+				? uint64_t( double( batchSize ) * double( batchTime.count() ) / double( duration.count() ) * 1.2 ) + 1
+				: batchSize * 2;
+		}
+
+		std::vector< double > nsPerOp;
+		for (unsigned int i = 0; i < std::max( _config.repeats, 1u ); ++i)
+		{
+			auto duration = measureBatch( batchSize, operation );
+			nsPerOp.push_back( double( duration.count() ) / double( batchSize ) );
+		}
+
+		addResult( makeResult( name, batchSize * nsPerOp.size(), nsPerOp, bytesPerOp ) );
+	}
+
+	/// Stores a result measured by the caller, for benchmarks that don't fit the per-operation model.
+	void addResult( const BenchResult & result );
+
+	const std::vector< BenchResult > & results() const noexcept  { return _results; }
+
+	/// Writes the collected results as a JSON document.
+	void writeJson( std::ostream & os ) const;
+
+	/// Builds a result from the times per operation of the individual batches.
+	static BenchResult makeResult( const std::string & name, uint64_t iterations, std::vector< double > nsPerOp, size_t bytesPerOp );
+
+ private:
+
+	template< typename Operation >
+	static std::chrono::nanoseconds measureBatch( uint64_t batchSize, Operation & operation )
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (uint64_t i = 0; i < batchSize; ++i)
+		{
+			operation();
+		}
+		return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start );
+	}
+
+	BenchConfig _config;
+	std::vector< BenchResult > _results;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace bench
+} // namespace orgb
+
+
+#endif // OPENRGB_BENCHMARK_INCLUDED
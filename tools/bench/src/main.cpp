@@ -0,0 +1,976 @@
+#include "Benchmark.hpp"
+#include "AllocationCounter.hpp"
+using namespace orgb::bench;
+
+#include "MockServer.hpp"
+#include "SyntheticDevice.hpp"
+using namespace orgb::mock;
+
+#include "OpenRGB/Client.hpp"
+#include "OpenRGB/ColorBuffer.hpp"
+#include "OpenRGB/MatrixMapper.hpp"
+#include "OpenRGB/SpatialCanvas.hpp"
+#include "OpenRGB/ThreadPool.hpp"
+#include "ProtocolMessages.hpp"
+#include "ProtocolCommon.hpp"
+using namespace orgb;
+
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+using own::BinaryOutputStream;
+#include "ContainerUtils.hpp"
+using own::make_span;
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <initializer_list>
+#include <thread>
+#include <functional>
+using namespace std;
+
+// the benchmarks of the old update checking talk to the mock server directly, the same as the Unix-only mock server
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_FULL_NAME "OpenRGB C++ SDK benchmarks"
+
+#define EXECUTABLE_NAME "orgb_bench"
+#define USAGE EXECUTABLE_NAME " [--filter <substring>] [--min-time-ms <n>] [--repeats <n>] [--output <file>]"
+#define EXAMPLE EXECUTABLE_NAME " --filter deserialize --output before.json"
+
+
+static void printHelp()
+{
+	static const char help [] =
+		APP_FULL_NAME "\n"
+		"\n"
+		"Measures the protocol serialization and the client hot paths and prints the results as JSON.\n"
+		"The end-to-end benchmarks run against a mock server on the loopback interface.\n"
+		"Progress is printed to the standard error output.\n"
+		"The exit code is 3 when sending colors made a heap allocation after the warm-up.\n"
+		"\n"
+		"  Usage is as follows: " USAGE "\n"
+		"          For example: " EXAMPLE "\n"
+		"\n"
+		"Options:\n"
+		"  --filter <substring>  run only the benchmarks whose name contains the substring\n"
+		"  --min-time-ms <n>     minimal measured time of each benchmark (default: 500)\n"
+		"  --repeats <n>         number of measured batches, the median is reported (default: 5)\n"
+		"  --output <file>       write the JSON into a file instead of the standard output\n"
+	;
+	cout << help << flush;
+}
+
+
+//======================================================================================================================
+//  test data
+
+static const unsigned int ledCounts [] = { 10, 100, 1000, 10000 };
+
+static DeviceShape shapeWithLEDs( unsigned int ledCount )
+{
+	DeviceShape shape;
+	shape.zoneCount = ledCount >= 100 ? 4 : 1;
+	shape.ledsPerZone = ledCount / shape.zoneCount;
+	return shape;
+}
+
+static vector< Color > makeColors( size_t count, uint8_t seed )
+{
+	vector< Color > colors;
+	colors.reserve( count );
+	for (size_t i = 0; i < count; ++i)
+	{
+		colors.push_back( Color( uint8_t( i + seed ), uint8_t( i * 3 + seed ), uint8_t( i * 7 + seed ) ) );
+	}
+	return colors;
+}
+
+
+//======================================================================================================================
+//  protocol serialization
+
+static void benchDeserializeDevice( BenchRunner & runner )
+{
+	for (unsigned int ledCount : ledCounts)
+	{
+		const vector< uint8_t > body = serializeSyntheticDevice( shapeWithLEDs( ledCount ), 0, implementedProtocolVersion );
+
+		// the same message is reused, like the client does with its receive buffers
+		ReplyControllerData reply;
+		{
+			BinaryInputStream stream( make_span( body ) );
+			if (!reply.deserializeBody( stream, implementedProtocolVersion ))
+			{
+				fprintf( stderr, "synthetic device with %u LEDs failed to parse, skipping\n", ledCount );
+				continue;
+			}
+		}
+
+		runner.run( "deserialize_device/" + to_string( ledCount ), body.size(), [&]()
+		{
+			BinaryInputStream stream( make_span( body ) );
+			bool parsed = reply.deserializeBody( stream, implementedProtocolVersion );
+			doNotOptimize( parsed );
+			doNotOptimize( reply );
+		});
+
+		// what Client::setLazyDeviceParsing() does, the modes and LEDs stay undecoded
+		runner.run( "deserialize_device_lazy/" + to_string( ledCount ), body.size(), [&]()
+		{
+			bool parsed = reply.deserializeBodyLazily( make_span( body ), implementedProtocolVersion );
+			doNotOptimize( parsed );
+			doNotOptimize( reply );
+		});
+	}
+}
+
+static void benchSerializeUpdateLEDs( BenchRunner & runner )
+{
+	for (unsigned int ledCount : ledCounts)
+	{
+		const vector< Color > colors = makeColors( ledCount, 0 );
+		vector< uint8_t > buffer( Header::size() + UpdateLEDs( 0, make_span( colors ) ).header.message_size );
+
+		runner.run( "serialize_update_leds/" + to_string( ledCount ), buffer.size(), [&]()
+		{
+			UpdateLEDs message( 0, make_span( colors ) );
+			BinaryOutputStream stream( make_span( buffer ) );
+			message.serialize( stream );
+			doNotOptimize( buffer );
+		});
+	}
+}
+
+static void benchColorFromString( BenchRunner & runner )
+{
+	struct { const char * form; vector< string > strings; } inputs [] =
+	{
+		{ "hex",      { "FF8000", "00ff80", "12AB9C", "c0ffee" } },
+		{ "hash_hex", { "#FF8000", "#00ff80", "#12AB9C", "#c0ffee" } },
+		{ "name",     { "red", "Magenta", "CYAN", "black" } },
+	};
+
+	for (const auto & input : inputs)
+	{
+		size_t next = 0;
+		Color color;
+		runner.run( string("color_from_string/") + input.form, 0, [&]()
+		{
+			bool parsed = color.fromString( input.strings[ next ] );
+			next = (next + 1) % input.strings.size();
+			doNotOptimize( parsed );
+			doNotOptimize( color );
+		});
+	}
+}
+
+template< typename Type >
+static vector< uint8_t > serializeArray( const vector< Type > & array )
+{
+	vector< uint8_t > bytes( protocol::sizeofArray( array ) );
+	BinaryOutputStream stream( make_span( bytes ) );
+	protocol::writeArray( stream, array );
+	return bytes;
+}
+
+static void benchReadArray( BenchRunner & runner )
+{
+	for (unsigned int count : ledCounts)
+	{
+		const vector< uint8_t > bytes = serializeArray( makeColors( count, 0 ) );
+
+		vector< Color > parsed;
+		runner.run( "read_array_colors/" + to_string( count ), bytes.size(), [&]()
+		{
+			BinaryInputStream stream( make_span( bytes ) );
+			bool ok = protocol::readArray( stream, parsed );
+			doNotOptimize( ok );
+			doNotOptimize( parsed );
+		});
+	}
+
+	{
+		vector< string > names;
+		for (unsigned int i = 0; i < 100; ++i)
+		{
+			names.push_back( "Synthetic LED " + to_string( i ) );
+		}
+		const vector< uint8_t > bytes = serializeArray( names );
+
+		vector< string > parsed;
+		runner.run( "read_array_strings/100", bytes.size(), [&]()
+		{
+			BinaryInputStream stream( make_span( bytes ) );
+			bool ok = protocol::readArray( stream, parsed );
+			doNotOptimize( ok );
+			doNotOptimize( parsed );
+		});
+	}
+}
+
+
+//======================================================================================================================
+//  color buffer operations
+
+static void benchColorBuffer( BenchRunner & runner )
+{
+	const size_t count = 10000;
+	const vector< Color > a = makeColors( count, 0 );
+	const vector< Color > b = makeColors( count, 100 );
+	vector< Color > dst( count );
+	const GammaTable gamma( 2.2 );
+	const size_t bytes = count * sizeof( Color );
+
+	SimdLevel originalLevel = activeSimdLevel();
+
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON })
+	{
+		if (!setSimdLevel( level ))
+			continue;  // not supported by this CPU
+
+		const string suffix = string("/") + enumString( level ) + "/" + to_string( count );
+		uint8_t amount = 0;
+
+		runner.run( "color_fill" + suffix, bytes, [&]()
+		{
+			fillColors( dst.data(), count, Color::Magenta );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_blend" + suffix, bytes, [&]()
+		{
+			blendColors( dst.data(), a.data(), b.data(), count, amount++ );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_scale" + suffix, bytes, [&]()
+		{
+			scaleColors( dst.data(), a.data(), count, amount++ );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_gain" + suffix, bytes, [&]()
+		{
+			gainColors( dst.data(), a.data(), count, 1.0f, 0.8f, 1.2f );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_add" + suffix, bytes, [&]()
+		{
+			addColors( dst.data(), a.data(), count );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_max" + suffix, bytes, [&]()
+		{
+			maxColors( dst.data(), a.data(), count );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_clamp" + suffix, bytes, [&]()
+		{
+			clampColors( dst.data(), a.data(), count, Color( 10, 20, 30 ), Color( 200, 210, 220 ) );
+			doNotOptimize( dst );
+		});
+	}
+
+	setSimdLevel( originalLevel );
+
+	// the same for all instruction sets
+	runner.run( "color_gamma/" + to_string( count ), bytes, [&]()
+	{
+		applyGamma( dst.data(), a.data(), count, gamma );
+		doNotOptimize( dst );
+	});
+}
+
+static void benchColorModels( BenchRunner & runner )
+{
+	// a frame of a large LED installation, the conversions should take well under a millisecond,
+	// except the conversions to HSV and HSL with NEON, which fall back to the scalar code
+	const size_t count = 100000;
+	const vector< Color > colors = makeColors( count, 0 );
+	vector< HSV > hsv( count );
+	vector< HSL > hsl( count );
+	colorsToHSV( hsv.data(), colors.data(), count );
+	colorsToHSL( hsl.data(), colors.data(), count );
+	vector< Color > dst( count );
+	const size_t bytes = count * sizeof( Color );
+
+	SimdLevel originalLevel = activeSimdLevel();
+
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON })
+	{
+		if (!setSimdLevel( level ))
+			continue;  // not supported by this CPU
+
+		const string suffix = string("/") + enumString( level ) + "/" + to_string( count );
+
+		runner.run( "color_from_hsv" + suffix, bytes, [&]()
+		{
+			colorsFromHSV( dst.data(), hsv.data(), count );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_from_hsl" + suffix, bytes, [&]()
+		{
+			colorsFromHSL( dst.data(), hsl.data(), count );
+			doNotOptimize( dst );
+		});
+		runner.run( "color_to_hsv" + suffix, bytes, [&]()
+		{
+			colorsToHSV( hsv.data(), colors.data(), count );
+			doNotOptimize( hsv );
+		});
+		runner.run( "color_to_hsl" + suffix, bytes, [&]()
+		{
+			colorsToHSL( hsl.data(), colors.data(), count );
+			doNotOptimize( hsl );
+		});
+	}
+
+	setSimdLevel( originalLevel );
+}
+
+static void benchMatrixMapper( BenchRunner & runner )
+{
+	// an LED panel of 128 x 125 pixels, the last row is only partially filled
+	DeviceShape shape;
+	shape.zoneCount = 1;
+	shape.ledsPerZone = 16000;
+	shape.matrixWidth = 128;
+	unique_ptr< Device > device = makeSyntheticDevice( shape, 0, implementedProtocolVersion );
+	MatrixMapper mapper;
+	if (!device || !mapper.build( *device, device->zones[0] ))
+	{
+		fprintf( stderr, "synthetic matrix device failed to parse, skipping the matrix mapping\n" );
+		return;
+	}
+
+	const vector< Color > image = makeColors( mapper.stride() * mapper.height(), 0 );
+	vector< Color > colors( device->leds.size() );
+	const size_t bytes = colors.size() * sizeof( Color );
+
+	SimdLevel originalLevel = activeSimdLevel();
+
+	for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::NEON })
+	{
+		if (!setSimdLevel( level ))
+			continue;  // not supported by this CPU
+
+		runner.run( string("matrix_map/") + enumString( level ) + "/" + to_string( colors.size() ), bytes, [&]()
+		{
+			mapper.map( image.data(), colors.data() + mapper.zoneOffset() );
+			doNotOptimize( colors );
+		});
+	}
+
+	setSimdLevel( originalLevel );
+}
+
+
+static void benchSpatialRender( BenchRunner & runner )
+{
+	// a wall of 10 LED panels with 2000 LEDs each
+	DeviceList devices;
+	DeviceShape shape;
+	shape.zoneCount = 1;
+	shape.ledsPerZone = 2000;
+	shape.matrixWidth = 50;
+	for (uint32_t deviceIdx = 0; deviceIdx < 10; ++deviceIdx)
+	{
+		unique_ptr< Device > device = makeSyntheticDevice( shape, deviceIdx, implementedProtocolVersion );
+		if (!device)
+		{
+			fprintf( stderr, "synthetic matrix device failed to parse, skipping the spatial rendering\n" );
+			return;
+		}
+		devices.append( move( device ) );
+	}
+	SpatialCanvas canvas;
+	canvas.build( devices );
+	const size_t bytes = canvas.size() * sizeof( Color );
+
+	PlasmaEffect plasma;
+	FrameTime time;
+
+	// how the rendering scales with the number of threads, up to the number of CPU cores
+	unsigned int maxThreads = max( thread::hardware_concurrency(), 1u );
+	for (unsigned int threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		ThreadPool pool( threadCount );
+		runner.run( "spatial_plasma/" + to_string( threadCount ) + "/" + to_string( canvas.size() ), bytes, [&]()
+		{
+			time.sinceStart += chrono::milliseconds( 16 );
+			canvas.render( plasma, time, &pool );
+			doNotOptimize( canvas.colors()[0] );
+		});
+		if (threadCount < maxThreads && threadCount * 2 > maxThreads)
+		{
+			threadCount = maxThreads / 2;  // measure the full core count even when it's not a power of 2
+		}
+	}
+}
+
+
+//======================================================================================================================
+//  device list lookups
+
+static const unsigned int deviceCounts [] = { 500, 2000 };
+
+static void benchDeviceListLookups( BenchRunner & runner )
+{
+	for (unsigned int deviceCount : deviceCounts)
+	{
+		// lookups, not parsing, are measured here, so the devices can be small
+		DeviceShape shape;
+		shape.zoneCount = 1;
+		shape.ledsPerZone = 1;
+
+		DeviceList devices;
+		vector< string > names;
+		for (unsigned int deviceIdx = 0; deviceIdx < deviceCount; ++deviceIdx)
+		{
+			unique_ptr< Device > device = makeSyntheticDevice( shape, deviceIdx, implementedProtocolVersion );
+			if (!device)
+			{
+				fprintf( stderr, "synthetic device failed to parse, skipping the device list lookups\n" );
+				return;
+			}
+			names.push_back( device->name );
+			devices.append( move( device ) );
+		}
+
+		// the names are visited in a scrambled order, so that the linear scan stops on average in the middle
+		vector< const char * > keys;
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			keys.push_back( names[ (i * 7919) % names.size() ].c_str() );
+		}
+
+		const string suffix = "/" + to_string( deviceCount );
+		size_t next = 0;
+
+		// what DeviceList::find( const std::string & ) used to do
+		runner.run( "device_list_find_name_linear" + suffix, 0, [&]()
+		{
+			const char * key = keys[ next ];
+			next = (next + 1) % keys.size();
+			const Device * found = nullptr;
+			for (const Device & device : devices)
+			{
+				if (device.name == key)
+				{
+					found = &device;
+					break;
+				}
+			}
+			doNotOptimize( found );
+		});
+
+		runner.run( "device_list_find_name" + suffix, 0, [&]()
+		{
+			const Device * found = devices.find( keys[ next ] );
+			next = (next + 1) % keys.size();
+			doNotOptimize( found );
+		});
+
+		// the synthetic devices are all LED strips, so looking for a keyboard has to go through all of them
+		runner.run( "device_list_find_type_linear" + suffix, 0, [&]()
+		{
+			const Device * found = nullptr;
+			for (const Device & device : devices)
+			{
+				if (device.type == DeviceType::Keyboard)
+				{
+					found = &device;
+					break;
+				}
+			}
+			doNotOptimize( found );
+		});
+
+		runner.run( "device_list_find_type" + suffix, 0, [&]()
+		{
+			const Device * found = devices.find( DeviceType::Keyboard );
+			doNotOptimize( found );
+		});
+	}
+}
+
+static void benchDeviceLookups( BenchRunner & runner )
+{
+	// a keyboard-sized device
+	DeviceShape shape;
+	shape.zoneCount = 1;
+	shape.ledsPerZone = 150;
+	unique_ptr< Device > device = makeSyntheticDevice( shape, 0, implementedProtocolVersion );
+	if (!device)
+	{
+		fprintf( stderr, "synthetic device failed to parse, skipping the device lookups\n" );
+		return;
+	}
+
+	// the LEDs are visited in a scrambled order, like key presses would come
+	vector< string > keys;
+	for (size_t i = 0; i < device->leds.size(); ++i)
+	{
+		keys.push_back( device->leds[ (i * 37) % device->leds.size() ].name );
+	}
+
+	const string suffix = "/" + to_string( device->leds.size() );
+	size_t next = 0;
+
+	// what Device::findLED() used to do
+	runner.run( "device_find_led_linear" + suffix, 0, [&]()
+	{
+		const string & key = keys[ next ];
+		next = (next + 1) % keys.size();
+		const LED * found = nullptr;
+		for (const LED & led : device->leds)
+		{
+			if (led.name == key)
+			{
+				found = &led;
+				break;
+			}
+		}
+		doNotOptimize( found );
+	});
+
+	runner.run( "device_find_led" + suffix, 0, [&]()
+	{
+		const LED * found = device->findLED( keys[ next ] );
+		next = (next + 1) % keys.size();
+		doNotOptimize( found );
+	});
+}
+
+
+//======================================================================================================================
+//  client against the mock server
+
+/// A mock server and a client connected to it, with the device list already downloaded.
+class LoopbackSession
+{
+ public:
+
+	MockServer server;
+	Client client;
+	DeviceList devices;
+
+	LoopbackSession( const ServerConfig & config ) : server( config ), client( EXECUTABLE_NAME ) {}
+
+	bool open()
+	{
+		if (!server.start())
+		{
+			fprintf( stderr, "failed to start the mock server\n" );
+			return false;
+		}
+		ConnectStatus connectStatus = client.connect( "127.0.0.1", server.port() );
+		if (connectStatus != ConnectStatus::Success)
+		{
+			fprintf( stderr, "failed to connect to the mock server: %s\n", enumString( connectStatus ) );
+			return false;
+		}
+		DeviceListResult listResult = client.requestDeviceList();
+		if (listResult.status != RequestStatus::Success || listResult.devices.size() == 0)
+		{
+			fprintf( stderr, "failed to get the device list from the mock server: %s\n", enumString( listResult.status ) );
+			return false;
+		}
+		devices = move( listResult.devices );
+		return true;
+	}
+};
+
+/// Sends frames for the configured time and reports them as frames per second.
+/** The time is split into the configured number of windows, each ending with a request that the server answers only
+  * after it has processed all the frames before it, so the numbers show what the server received, not just what the
+  * client managed to push into the socket buffer. */
+template< typename SendFrame >
+static void runFrameLoop( BenchRunner & runner, const BenchConfig & config, const string & name,
+                          LoopbackSession & session, size_t bytesPerFrame, SendFrame sendFrame )
+{
+	unsigned int windows = std::max( config.repeats, 1u );
+	auto windowTime = config.minTime / windows;
+
+	uint64_t totalFrames = 0;
+	vector< double > nsPerFrame;
+	for (unsigned int window = 0; window < windows; ++window)
+	{
+		uint64_t frames = 0;
+		auto start = chrono::steady_clock::now();
+		auto end = start + windowTime;
+		while (chrono::steady_clock::now() < end)
+		{
+			if (sendFrame( frames ) != RequestStatus::Success)
+			{
+				fprintf( stderr, "%s: sending a frame failed, skipping\n", name.c_str() );
+				return;
+			}
+			frames++;
+		}
+		if (session.client.requestDeviceCount().status != RequestStatus::Success)
+		{
+			fprintf( stderr, "%s: the server stopped responding, skipping\n", name.c_str() );
+			return;
+		}
+		auto elapsed = chrono::duration_cast< chrono::nanoseconds >( chrono::steady_clock::now() - start );
+		nsPerFrame.push_back( double( elapsed.count() ) / double( std::max< uint64_t >( frames, 1 ) ) );
+		totalFrames += frames;
+	}
+
+	BenchResult result = BenchRunner::makeResult( name, totalFrames, nsPerFrame, bytesPerFrame );
+	result.counters.emplace_back( "frames_per_second", result.nsPerOpMedian > 0.0 ? 1e9 / result.nsPerOpMedian : 0.0 );
+	result.counters.emplace_back( "server_updated_leds", double( session.server.stats().updatedLEDs ) );
+	runner.addResult( result );
+}
+
+static void benchEndToEnd( BenchRunner & runner, const BenchConfig & config )
+{
+	for (unsigned int ledCount : ledCounts)
+	{
+		// full frames, every LED changes every time
+		string fullName = "e2e_set_device_colors/" + to_string( ledCount );
+		if (runner.isSelected( fullName ))
+		{
+			ServerConfig serverConfig;
+			serverConfig.deviceCount = 1;
+			serverConfig.deviceShape = shapeWithLEDs( ledCount );
+			LoopbackSession session( serverConfig );
+			if (!session.open())
+				continue;
+
+			const Device & device = session.devices[0];
+			const vector< Color > frames [2] = { makeColors( device.leds.size(), 0 ), makeColors( device.leds.size(), 128 ) };
+			size_t bytesPerFrame = Header::size() + UpdateLEDs( device.idx, make_span( frames[0] ) ).header.message_size;
+
+			runFrameLoop( runner, config, fullName, session, bytesPerFrame, [&]( uint64_t frameIdx )
+			{
+				return session.client.setDeviceColors( device, frames[ frameIdx % 2 ] );
+			});
+		}
+
+		// sparse frames, about 1% of the LEDs change every time, which the delta encoding should exploit
+		string sparseName = "e2e_update_device_colors_sparse/" + to_string( ledCount );
+		if (runner.isSelected( sparseName ))
+		{
+			ServerConfig serverConfig;
+			serverConfig.deviceCount = 1;
+			serverConfig.deviceShape = shapeWithLEDs( ledCount );
+			LoopbackSession session( serverConfig );
+			if (!session.open())
+				continue;
+
+			const Device & device = session.devices[0];
+			vector< Color > frame = makeColors( device.leds.size(), 0 );
+			size_t changesPerFrame = std::max< size_t >( frame.size() / 100, 1 );
+
+			runFrameLoop( runner, config, sparseName, session, 0, [&]( uint64_t frameIdx )
+			{
+				for (size_t i = 0; i < changesPerFrame; ++i)
+				{
+					Color & color = frame[ (frameIdx * changesPerFrame + i) * 7919 % frame.size() ];
+					color.r = uint8_t( color.r + 1 );
+				}
+				return session.client.updateDeviceColors( device, frame );
+			});
+		}
+	}
+}
+
+/// Raw connection to the mock server that checks for updates the way the client did before it could peek into
+/// its socket without waiting: switch to non-blocking, receive, switch back. Serves as the baseline of the polling
+/// benchmarks.
+class LegacyPollingSocket
+{
+ public:
+
+	~LegacyPollingSocket()
+	{
+		if (_fd >= 0)
+			::close( _fd );
+	}
+
+	bool connect( uint16_t port )
+	{
+		_fd = ::socket( AF_INET, SOCK_STREAM, 0 );
+		if (_fd < 0)
+			return false;
+		sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons( port );
+		addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+		return ::connect( _fd, (const sockaddr *)&addr, sizeof(addr) ) == 0;
+	}
+
+	bool checkForUpdates()
+	{
+		uint8_t header [16];
+		int flags = ::fcntl( _fd, F_GETFL );
+		::fcntl( _fd, F_SETFL, flags | O_NONBLOCK );
+		ssize_t received = ::recv( _fd, header, sizeof(header), 0 );
+		::fcntl( _fd, F_SETFL, flags & ~O_NONBLOCK );
+		return received > 0;
+	}
+
+	bool send( const vector< uint8_t > & message )
+	{
+		return ::send( _fd, message.data(), message.size(), MSG_NOSIGNAL ) == ssize_t( message.size() );
+	}
+
+ private:
+
+	int _fd = -1;
+};
+
+/// Checks that sending colors doesn't allocate anything once the buffers of the client have grown big enough.
+/** \returns false when some allocation was made */
+static bool checkSteadyStateAllocations( BenchRunner & runner )
+{
+	const string fullName = "client_steady_state_allocations/set_device_colors";
+	const string deltaName = "client_steady_state_allocations/update_device_colors";
+	if (!runner.isSelected( fullName ) && !runner.isSelected( deltaName ))
+		return true;
+
+	ServerConfig serverConfig;
+	serverConfig.deviceCount = 1;
+	serverConfig.deviceShape = shapeWithLEDs( 1000 );
+	LoopbackSession session( serverConfig );
+	if (!session.open())
+		return false;
+
+	const Device & device = session.devices[0];
+	const vector< Color > fullFrames [2] = { makeColors( device.leds.size(), 0 ), makeColors( device.leds.size(), 128 ) };
+	vector< Color > sparseFrame = fullFrames[0];
+
+	const unsigned int warmUpCalls = 100;
+	const unsigned int checkedCalls = 10000;
+
+	bool passed = true;
+	auto check = [&]( const string & name, std::function< RequestStatus ( unsigned int ) > sendFrame )
+	{
+		if (!runner.isSelected( name ))
+			return;
+
+		for (unsigned int i = 0; i < warmUpCalls; ++i)
+			sendFrame( i );
+
+		uint64_t allocations;
+		bool sent = true;
+		auto start = chrono::steady_clock::now();
+		{
+			AllocationCounter counter;
+			for (unsigned int i = warmUpCalls; i < warmUpCalls + checkedCalls; ++i)
+				sent = sendFrame( i ) == RequestStatus::Success && sent;
+			allocations = counter.count();
+		}
+		auto elapsed = chrono::duration_cast< chrono::nanoseconds >( chrono::steady_clock::now() - start );
+
+		if (!sent)
+		{
+			fprintf( stderr, "%s: sending a frame failed\n", name.c_str() );
+			passed = false;
+		}
+		if (allocations != 0)
+		{
+			fprintf( stderr, "%s: FAILED, %llu heap allocations in %u calls after the warm-up\n",
+			         name.c_str(), (unsigned long long)allocations, checkedCalls );
+			passed = false;
+		}
+
+		BenchResult result = BenchRunner::makeResult( name, checkedCalls, { double( elapsed.count() ) / checkedCalls }, 0 );
+		result.counters.emplace_back( "allocations", double( allocations ) );
+		runner.addResult( result );
+	};
+
+	check( fullName, [&]( unsigned int frameIdx )
+	{
+		return session.client.setDeviceColors( device, fullFrames[ frameIdx % 2 ] );
+	});
+
+	// a few LEDs change every time, so that the delta encoding is used instead of the full update
+	check( deltaName, [&]( unsigned int frameIdx )
+	{
+		for (size_t i = 0; i < 5; ++i)
+		{
+			Color & color = sparseFrame[ (frameIdx * 5 + i) * 7919 % sparseFrame.size() ];
+			color.r = uint8_t( color.r + 1 );
+		}
+		return session.client.updateDeviceColors( device, sparseFrame );
+	});
+
+	// wait until the server has processed everything, so that the session closes cleanly
+	session.client.requestDeviceCount();
+
+	return passed;
+}
+
+static void benchClientRequests( BenchRunner & runner )
+{
+	const string pollName = "client_check_for_updates/idle";
+	const string pollWithSendName = "client_check_for_updates/with_send";
+	const string sendOnlyName = "client_set_device_colors/without_check";
+	const string legacyPollName = "legacy_check_for_updates/idle";
+	const string legacyPollWithSendName = "legacy_check_for_updates/with_send";
+	const string legacySendOnlyName = "legacy_send/without_check";
+	const string roundTripName = "client_round_trip/request_device_count";
+	bool anySelected = false;
+	for (const string * name : { &pollName, &pollWithSendName, &sendOnlyName, &legacyPollName, &legacyPollWithSendName, &legacySendOnlyName, &roundTripName })
+		anySelected = anySelected || runner.isSelected( *name );
+	if (!anySelected)
+		return;
+
+	ServerConfig serverConfig;
+	serverConfig.deviceCount = 1;
+	LoopbackSession session( serverConfig );
+	if (!session.open())
+		return;
+
+	// the cost of polling when nothing has arrived, which applications typically do every frame
+	runner.run( pollName, 0, [&]()
+	{
+		UpdateStatus status = session.client.checkForDeviceUpdates();
+		doNotOptimize( status );
+	});
+
+	// The usual application loop checks for updates and sends a frame every iteration, the difference between these
+	// two is the cost of the check when it's interleaved with sends.
+	const Device & device = session.devices[0];
+	const vector< Color > colors = makeColors( device.leds.size(), 0 );
+	runner.run( pollWithSendName, 0, [&]()
+	{
+		UpdateStatus status = session.client.checkForDeviceUpdates();
+		doNotOptimize( status );
+		RequestStatus sendStatus = session.client.setDeviceColors( device, colors );
+		doNotOptimize( sendStatus );
+	});
+	runner.run( sendOnlyName, 0, [&]()
+	{
+		RequestStatus sendStatus = session.client.setDeviceColors( device, colors );
+		doNotOptimize( sendStatus );
+	});
+
+	// the same with the old way of checking, on a separate connection to the same server
+	LegacyPollingSocket legacySocket;
+	if (!legacySocket.connect( session.server.port() ))
+	{
+		fprintf( stderr, "failed to connect to the mock server, skipping the legacy polling\n" );
+	}
+	else
+	{
+		vector< uint8_t > message( Header::size() + UpdateLEDs( device.idx, make_span( colors ) ).header.message_size );
+		BinaryOutputStream stream( make_span( message ) );
+		UpdateLEDs( device.idx, make_span( colors ) ).serialize( stream );
+
+		runner.run( legacyPollName, 0, [&]()
+		{
+			bool arrived = legacySocket.checkForUpdates();
+			doNotOptimize( arrived );
+		});
+		runner.run( legacyPollWithSendName, 0, [&]()
+		{
+			bool arrived = legacySocket.checkForUpdates();
+			doNotOptimize( arrived );
+			bool sent = legacySocket.send( message );
+			doNotOptimize( sent );
+		});
+		runner.run( legacySendOnlyName, 0, [&]()
+		{
+			bool sent = legacySocket.send( message );
+			doNotOptimize( sent );
+		});
+	}
+
+	// the full round trip of the smallest request
+	runner.run( roundTripName, 0, [&]()
+	{
+		DeviceCountResult result = session.client.requestDeviceCount();
+		doNotOptimize( result );
+	});
+}
+
+
+//======================================================================================================================
+
+static bool parseArgs( int argc, char * argv [], BenchConfig & config, string & outputFile )
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		string option = argv[i];
+		if (option == "--help" || option == "-h")
+		{
+			printHelp();
+			exit( 0 );
+		}
+		if (i + 1 >= argc)
+		{
+			cerr << "missing value for " << option << endl;
+			return false;
+		}
+		string value = argv[ ++i ];
+
+		if      (option == "--filter")       config.filter = value;
+		else if (option == "--min-time-ms")  config.minTime = chrono::milliseconds( strtoul( value.c_str(), nullptr, 10 ) );
+		else if (option == "--repeats")      config.repeats = unsigned( strtoul( value.c_str(), nullptr, 10 ) );
+		else if (option == "--output")       outputFile = value;
+		else
+		{
+			cerr << "unknown option " << option << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, char * argv [] )
+{
+	BenchConfig config;
+	string outputFile;
+	if (!parseArgs( argc, argv, config, outputFile ))
+	{
+		cerr << "usage: " USAGE << endl;
+		return 1;
+	}
+
+	BenchRunner runner( config );
+
+	benchDeserializeDevice( runner );
+	benchSerializeUpdateLEDs( runner );
+	benchColorFromString( runner );
+	benchReadArray( runner );
+	benchColorBuffer( runner );
+	benchColorModels( runner );
+	benchMatrixMapper( runner );
+	benchSpatialRender( runner );
+	benchDeviceListLookups( runner );
+	benchDeviceLookups( runner );
+	benchClientRequests( runner );
+	benchEndToEnd( runner, config );
+	bool noAllocations = checkSteadyStateAllocations( runner );
+
+	if (outputFile.empty())
+	{
+		runner.writeJson( cout );
+	}
+	else
+	{
+		ofstream file( outputFile );
+		if (!file)
+		{
+			cerr << "can't open " << outputFile << endl;
+			return 2;
+		}
+		runner.writeJson( file );
+	}
+
+	return noAllocations ? 0 : 3;
+}
@@ -0,0 +1,411 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: loopback server speaking the OpenRGB protocol, for benchmarks and integration tests
+//======================================================================================================================
+
+#include "MockServer.hpp"
+
+#include "ProtocolMessages.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryOutputStream;
+using own::BinaryInputStream;
+#include "ContainerUtils.hpp"
+using own::make_span;
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+#include <mutex>
+using std::mutex;
+using std::unique_lock;
+#include <thread>
+#include <chrono>
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+#include <algorithm>
+#include <array>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+
+namespace orgb {
+namespace mock {
+
+
+//======================================================================================================================
+//  socket helpers
+
+static bool sendAll( int socket, const uint8_t * data, size_t size )
+{
+	while (size > 0)
+	{
+		ssize_t sent = ::send( socket, data, size, MSG_NOSIGNAL );
+		if (sent <= 0)
+			return false;
+		data += sent;
+		size -= size_t( sent );
+	}
+	return true;
+}
+
+static bool receiveAll( int socket, uint8_t * data, size_t size )
+{
+	while (size > 0)
+	{
+		ssize_t received = ::recv( socket, data, size, 0 );
+		if (received <= 0)
+			return false;
+		data += received;
+		size -= size_t( received );
+	}
+	return true;
+}
+
+
+//======================================================================================================================
+//  MockServer
+
+MockServer::MockServer( const ServerConfig & config )
+:
+	_config( config ),
+	_listeningSocket( -1 ),
+	_port( 0 ),
+	_stopRequested( false ),
+	_connectionCount( 0 ),
+	_messageCount( 0 ),
+	_byteCount( 0 ),
+	_colorUpdateCount( 0 ),
+	_updatedLEDCount( 0 ),
+	_invalidMessageCount( 0 )
+{}
+
+MockServer::~MockServer() noexcept
+{
+	stop();
+}
+
+bool MockServer::start()
+{
+	_devices.clear();
+	for (uint32_t deviceIdx = 0; deviceIdx < _config.deviceCount; ++deviceIdx)
+	{
+		unique_ptr< Device > device = makeSyntheticDevice( _config.deviceShape, deviceIdx, implementedProtocolVersion );
+		if (!device)
+		{
+			fprintf( stderr, "failed to generate a synthetic device\n" );
+			return false;
+		}
+		_devices.push_back( move( device ) );
+	}
+
+	_listeningSocket = ::socket( AF_INET, SOCK_STREAM, 0 );
+	if (_listeningSocket < 0)
+	{
+		return false;
+	}
+
+	int reuse = 1;
+	setsockopt( _listeningSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof( reuse ) );
+
+	sockaddr_in addr;
+	memset( &addr, 0, sizeof( addr ) );
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	addr.sin_port = htons( _config.port );
+	if (::bind( _listeningSocket, reinterpret_cast< sockaddr * >( &addr ), sizeof( addr ) ) != 0
+	 || ::listen( _listeningSocket, 64 ) != 0)
+	{
+		::close( _listeningSocket );
+		_listeningSocket = -1;
+		return false;
+	}
+
+	socklen_t addrLen = sizeof( addr );
+	getsockname( _listeningSocket, reinterpret_cast< sockaddr * >( &addr ), &addrLen );
+	_port = ntohs( addr.sin_port );
+
+	_stopRequested = false;
+	_acceptThread = std::thread( &MockServer::acceptLoop, this );
+	return true;
+}
+
+void MockServer::stop() noexcept
+{
+	_stopRequested = true;
+
+	if (_acceptThread.joinable())
+	{
+		_acceptThread.join();
+	}
+
+	unique_lock< mutex > lock( _connectionsMutex );
+	for (auto & connection : _connections)
+	{
+		// wakes up the thread if it's blocked in a receive
+		::shutdown( connection->socket, SHUT_RDWR );
+	}
+	for (auto & connection : _connections)
+	{
+		connection->thread.join();
+		::close( connection->socket );
+	}
+	_connections.clear();
+
+	if (_listeningSocket >= 0)
+	{
+		::close( _listeningSocket );
+		_listeningSocket = -1;
+	}
+}
+
+void MockServer::announceDeviceListUpdate() noexcept
+{
+	unique_lock< mutex > lock( _connectionsMutex );
+	for (auto & connection : _connections)
+	{
+		if (!connection->finished)
+		{
+			sendMessage( *connection, DeviceListUpdated(), 0 );
+		}
+	}
+}
+
+ServerStats MockServer::stats() const noexcept
+{
+	ServerStats stats;
+	stats.connections = _connectionCount;
+	stats.messages = _messageCount;
+	stats.bytes = _byteCount;
+	stats.colorUpdates = _colorUpdateCount;
+	stats.updatedLEDs = _updatedLEDCount;
+	stats.invalidMessages = _invalidMessageCount;
+	return stats;
+}
+
+void MockServer::acceptLoop() noexcept
+{
+	while (!_stopRequested)
+	{
+		pollfd pfd = { _listeningSocket, POLLIN, 0 };
+		if (::poll( &pfd, 1, 100 ) <= 0)
+		{
+			continue;  // timeout, check if we should stop
+		}
+
+		int clientSocket = ::accept( _listeningSocket, nullptr, nullptr );
+		if (clientSocket < 0)
+		{
+			continue;
+		}
+
+		int noDelay = 1;
+		setsockopt( clientSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof( noDelay ) );
+		if (_config.receiveBufferSize > 0)
+		{
+			setsockopt( clientSocket, SOL_SOCKET, SO_RCVBUF, &_config.receiveBufferSize, sizeof( _config.receiveBufferSize ) );
+		}
+
+		_connectionCount++;
+
+		unique_lock< mutex > lock( _connectionsMutex );
+
+		// clean up after the clients that have already left
+		for (auto iter = _connections.begin(); iter != _connections.end(); )
+		{
+			if ((*iter)->finished)
+			{
+				(*iter)->thread.join();
+				::close( (*iter)->socket );
+				iter = _connections.erase( iter );
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		unique_ptr< Connection > connection( new Connection );
+		connection->socket = clientSocket;
+		connection->thread = std::thread( &MockServer::serveClient, this, std::ref( *connection ) );
+		_connections.push_back( move( connection ) );
+	}
+}
+
+void MockServer::serveClient( Connection & connection ) noexcept
+{
+	uint32_t protocolVersion = 0;
+	auto updatePeriod = _config.deviceListUpdatePeriod;
+	auto nextUpdate = steady_clock::now() + updatePeriod;
+
+	vector< uint8_t > body;
+
+	while (!_stopRequested)
+	{
+		int pollTimeout = 100;
+		if (updatePeriod.count() > 0)
+		{
+			auto untilUpdate = duration_cast< milliseconds >( nextUpdate - steady_clock::now() ).count();
+			pollTimeout = int( std::max< decltype( untilUpdate ) >( 0, std::min< decltype( untilUpdate ) >( untilUpdate, pollTimeout ) ) );
+		}
+
+		pollfd pfd = { connection.socket, POLLIN, 0 };
+		int pollResult = ::poll( &pfd, 1, pollTimeout );
+
+		if (updatePeriod.count() > 0 && steady_clock::now() >= nextUpdate)
+		{
+			if (!sendMessage( connection, DeviceListUpdated(), protocolVersion ))
+				break;
+			nextUpdate += updatePeriod;
+		}
+
+		if (pollResult <= 0)
+		{
+			continue;
+		}
+
+		std::array< uint8_t, Header::size() > headerBuffer;
+		if (!receiveAll( connection.socket, headerBuffer.data(), headerBuffer.size() ))
+		{
+			break;  // the client has disconnected
+		}
+		Header header;
+		BinaryInputStream headerStream( make_span( headerBuffer ) );
+		if (!header.deserialize( headerStream ))
+		{
+			_invalidMessageCount++;
+			break;
+		}
+
+		body.resize( header.message_size );
+		if (!receiveAll( connection.socket, body.data(), body.size() ))
+		{
+			break;
+		}
+
+		_messageCount++;
+		_byteCount += headerBuffer.size() + body.size();
+
+		if (!handleMessage( connection, header.device_idx, uint32_t( header.message_type ), body, protocolVersion ))
+		{
+			_invalidMessageCount++;
+			break;
+		}
+
+		if (_config.processingDelay.count() > 0)
+		{
+			std::this_thread::sleep_for( _config.processingDelay );
+		}
+	}
+
+	connection.finished = true;
+}
+
+bool MockServer::handleMessage( Connection & connection, uint32_t deviceIdx, uint32_t messageType,
+                                const vector< uint8_t > & body, uint32_t & protocolVersion )
+{
+	BinaryInputStream stream( make_span( body ) );
+
+	auto delayReply = [ this ]()
+	{
+		if (_config.replyLatency.count() > 0)
+		{
+			std::this_thread::sleep_for( _config.replyLatency );
+		}
+	};
+
+	switch (MessageType( messageType ))
+	{
+		case MessageType::REQUEST_PROTOCOL_VERSION:
+		{
+			uint32_t clientVersion = 0;
+			stream >> clientVersion;
+			if (stream.hasFailed())
+				return false;
+			protocolVersion = std::min( clientVersion, _config.protocolVersion );
+			delayReply();
+			return sendMessage( connection, ReplyProtocolVersion( _config.protocolVersion ), protocolVersion );
+		}
+		case MessageType::REQUEST_CONTROLLER_COUNT:
+		{
+			delayReply();
+			return sendMessage( connection, ReplyControllerCount( uint32_t( _devices.size() ) ), protocolVersion );
+		}
+		case MessageType::REQUEST_CONTROLLER_DATA:
+		{
+			RequestControllerData request;
+			if (!request.deserializeBody( stream ))
+				return false;
+			if (deviceIdx >= _devices.size())
+				return true;  // the real server doesn't answer either
+			delayReply();
+			uint32_t replyVersion = std::min( request.protocolVersion, _config.protocolVersion );
+			return sendMessage( connection, ReplyControllerData( deviceIdx, *_devices[ deviceIdx ], replyVersion ), replyVersion );
+		}
+		case MessageType::REQUEST_PROFILE_LIST:
+		{
+			delayReply();
+			return sendMessage( connection, ReplyProfileList( _config.profiles ), protocolVersion );
+		}
+		case MessageType::RGBCONTROLLER_UPDATELEDS:
+		{
+			UpdateLEDs update;
+			if (!update.deserializeBody( stream ))
+				return false;
+			_colorUpdateCount++;
+			_updatedLEDCount += update.colors.size();
+			return true;
+		}
+		case MessageType::RGBCONTROLLER_UPDATEZONELEDS:
+		{
+			UpdateZoneLEDs update;
+			if (!update.deserializeBody( stream ))
+				return false;
+			_colorUpdateCount++;
+			_updatedLEDCount += update.colors.size();
+			return true;
+		}
+		case MessageType::RGBCONTROLLER_UPDATESINGLELED:
+		{
+			UpdateSingleLED update;
+			if (!update.deserializeBody( stream ))
+				return false;
+			_colorUpdateCount++;
+			_updatedLEDCount++;
+			return true;
+		}
+		default:
+			// mode changes, profiles and so on are accepted and ignored
+			return true;
+	}
+}
+
+template< typename Message >
+bool MockServer::sendMessage( Connection & connection, const Message & message, uint32_t protocolVersion )
+{
+	vector< uint8_t > buffer( message.header.size() + message.header.message_size );
+	BinaryOutputStream stream( make_span( buffer ) );
+	message.serialize( stream, protocolVersion );
+
+	unique_lock< mutex > lock( connection.sendMutex );
+	return sendAll( connection.socket, buffer.data(), buffer.size() );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace mock
+} // namespace orgb
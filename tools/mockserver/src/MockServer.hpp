@@ -0,0 +1,142 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: loopback server speaking the OpenRGB protocol, for benchmarks and integration tests
+//======================================================================================================================
+
+#ifndef OPENRGB_MOCK_SERVER_INCLUDED
+#define OPENRGB_MOCK_SERVER_INCLUDED
+
+
+#include "SyntheticDevice.hpp"
+#include "OpenRGB/DeviceInfo.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+
+namespace orgb {
+namespace mock {
+
+
+//======================================================================================================================
+
+struct ServerConfig
+{
+	uint16_t port = 0;                 ///< 0 means any free port, see MockServer::port()
+	uint32_t protocolVersion = 3;      ///< the highest version the server claims to support
+	unsigned int deviceCount = 4;
+	DeviceShape deviceShape;
+	std::vector< std::string > profiles = { "Default", "Party" };
+
+	/// delay before every reply, simulates a distant or busy server
+	std::chrono::microseconds replyLatency { 0 };
+	/// delay after processing every received message, simulates a server that can't keep up with the client
+	std::chrono::microseconds processingDelay { 0 };
+	/// size of the system receive buffer of the connections, 0 leaves the system default,
+	/// small values make a slow server push back on the client sooner
+	int receiveBufferSize = 0;
+	/// period of spontaneous DeviceListUpdated messages sent to every client, 0 means never
+	std::chrono::milliseconds deviceListUpdatePeriod { 0 };
+};
+
+/// What the server has received from all the clients since start.
+struct ServerStats
+{
+	uint64_t connections = 0;
+	uint64_t messages = 0;
+	uint64_t bytes = 0;
+	uint64_t colorUpdates = 0;     ///< UpdateLEDs, UpdateZoneLEDs and UpdateSingleLED messages
+	uint64_t updatedLEDs = 0;      ///< total number of LED colors in the color updates
+	uint64_t invalidMessages = 0;  ///< messages that failed to parse, the connection is closed after them
+};
+
+
+//======================================================================================================================
+/// Server that answers the requests of the client with synthetic devices, without any RGB hardware.
+/** It listens on the loopback interface only. Each client is served by its own thread,
+  * so the server can run in the same process as the clients that are being measured. */
+
+class MockServer
+{
+
+ public:
+
+	MockServer( const ServerConfig & config );
+	~MockServer() noexcept;
+
+	MockServer( const MockServer & other ) = delete;
+	MockServer & operator=( const MockServer & other ) = delete;
+
+	/// Generates the devices and starts listening.
+	/** \returns false if the devices couldn't be generated or the port couldn't be opened. */
+	bool start();
+
+	/// Closes all the connections and stops all the threads.
+	void stop() noexcept;
+
+	/// The port the server actually listens on.
+	uint16_t port() const noexcept  { return _port; }
+
+	/// The devices the server pretends to have.
+	const std::vector< std::unique_ptr< Device > > & devices() const noexcept  { return _devices; }
+
+	/// Sends DeviceListUpdated to all the connected clients right now.
+	void announceDeviceListUpdate() noexcept;
+
+	/// Snapshot of the counters.
+	ServerStats stats() const noexcept;
+
+ private:
+
+	struct Connection
+	{
+		int socket;
+		std::thread thread;
+		std::mutex sendMutex;  ///< replies and spontaneous announcements can be sent from different threads
+		std::atomic< bool > finished { false };
+	};
+
+	void acceptLoop() noexcept;
+	void serveClient( Connection & connection ) noexcept;
+	bool handleMessage( Connection & connection, uint32_t deviceIdx, uint32_t messageType,
+	                    const std::vector< uint8_t > & body, uint32_t & protocolVersion );
+	template< typename Message >
+	bool sendMessage( Connection & connection, const Message & message, uint32_t protocolVersion );
+
+	ServerConfig _config;
+	std::vector< std::unique_ptr< Device > > _devices;
+
+	int _listeningSocket;
+	uint16_t _port;
+	std::thread _acceptThread;
+	std::atomic< bool > _stopRequested;
+
+	std::mutex _connectionsMutex;
+	std::vector< std::unique_ptr< Connection > > _connections;
+
+	std::atomic< uint64_t > _connectionCount;
+	std::atomic< uint64_t > _messageCount;
+	std::atomic< uint64_t > _byteCount;
+	std::atomic< uint64_t > _colorUpdateCount;
+	std::atomic< uint64_t > _updatedLEDCount;
+	std::atomic< uint64_t > _invalidMessageCount;
+
+};
+
+
+//======================================================================================================================
+
+
+} // namespace mock
+} // namespace orgb
+
+
+#endif // OPENRGB_MOCK_SERVER_INCLUDED
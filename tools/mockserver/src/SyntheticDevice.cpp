@@ -0,0 +1,177 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: generator of artificial devices for testing without RGB hardware
+//======================================================================================================================
+
+#include "SyntheticDevice.hpp"
+
+#include "ProtocolMessages.hpp"
+#include "BinaryStream.hpp"
+using own::BinaryInputStream;
+#include "ContainerUtils.hpp"
+using own::make_span;
+
+#include <string>
+using std::string;
+#include <vector>
+using std::vector;
+#include <memory>
+using std::unique_ptr;
+
+
+namespace orgb {
+namespace mock {
+
+
+//======================================================================================================================
+//  The device is written field by field in the wire format instead of using Device::serialize(),
+//  because the Device objects can only be created by parsing, which is exactly what we need them for.
+
+class WireWriter
+{
+ public:
+
+	vector< uint8_t > bytes;
+
+	void u16( uint16_t val )  { for (int i = 0; i < 2; ++i) bytes.push_back( uint8_t( val >> (8 * i) ) ); }
+	void u32( uint32_t val )  { for (int i = 0; i < 4; ++i) bytes.push_back( uint8_t( val >> (8 * i) ) ); }
+
+	void str( const string & s )
+	{
+		u16( uint16_t( s.size() + 1 ) );
+		bytes.insert( bytes.end(), s.begin(), s.end() );
+		bytes.push_back( '\0' );
+	}
+
+	void color( uint8_t r, uint8_t g, uint8_t b )
+	{
+		bytes.push_back( r );
+		bytes.push_back( g );
+		bytes.push_back( b );
+		bytes.push_back( 0 );
+	}
+
+	void patchU32( size_t pos, uint32_t val )
+	{
+		for (int i = 0; i < 4; ++i) bytes[ pos + i ] = uint8_t( val >> (8 * i) );
+	}
+};
+
+vector< uint8_t > serializeSyntheticDevice( const DeviceShape & shape, uint32_t deviceIdx, uint32_t protocolVersion )
+{
+	WireWriter w;
+	string idxStr = std::to_string( deviceIdx );
+
+	w.u32( 0 );  // data_size, filled in at the end
+
+	w.u32( uint32_t( DeviceType::LedStrip ) );
+	w.str( "Synthetic Device " + idxStr );
+	w.str( "OpenRGB-cppSDK" );
+	w.str( "artificial device generated for testing" );
+	w.str( "1.0" );
+	w.str( "SN-" + idxStr );
+	w.str( "mock:" + idxStr );
+
+	// modes
+	w.u16( uint16_t( shape.modeCount ) );
+	w.u32( 0 );  // active_mode
+	for (unsigned int modeIdx = 0; modeIdx < shape.modeCount; ++modeIdx)
+	{
+		bool isDirect = modeIdx == 0;
+		w.str( isDirect ? string( "Direct" ) : "Effect " + std::to_string( modeIdx ) );
+		w.u32( modeIdx );  // value
+		w.u32( isDirect ? HasPerLedColor : HasSpeed | HasBrightness | HasDirectionLR | HasModeSpecificColor );
+		w.u32( 0 );    // speed_min
+		w.u32( 100 );  // speed_max
+		if (protocolVersion >= 3)
+		{
+			w.u32( 0 );    // brightness_min
+			w.u32( 100 );  // brightness_max
+		}
+		w.u32( isDirect ? 0 : shape.modeColorCount );  // colors_min
+		w.u32( isDirect ? 0 : shape.modeColorCount );  // colors_max
+		w.u32( 50 );  // speed
+		if (protocolVersion >= 3)
+		{
+			w.u32( 100 );  // brightness
+		}
+		w.u32( uint32_t( Direction::Left ) );
+		w.u32( uint32_t( isDirect ? ColorMode::PerLed : ColorMode::ModeSpecific ) );
+		unsigned int colorCount = isDirect ? 0 : shape.modeColorCount;
+		w.u16( uint16_t( colorCount ) );
+		for (unsigned int colorIdx = 0; colorIdx < colorCount; ++colorIdx)
+		{
+			w.color( uint8_t( 40 * colorIdx ), 0, 255 );
+		}
+	}
+
+	// zones
+	w.u16( uint16_t( shape.zoneCount ) );
+	for (unsigned int zoneIdx = 0; zoneIdx < shape.zoneCount; ++zoneIdx)
+	{
+		w.str( "Zone " + std::to_string( zoneIdx ) );
+		w.u32( uint32_t( shape.matrixWidth > 0 ? ZoneType::Matrix : ZoneType::Linear ) );
+		w.u32( shape.ledsPerZone );  // leds_min
+		w.u32( shape.ledsPerZone );  // leds_max
+		w.u32( shape.ledsPerZone );  // leds_count
+		if (shape.matrixWidth > 0)
+		{
+			uint32_t width = shape.matrixWidth;
+			uint32_t height = (shape.ledsPerZone + width - 1) / width;
+			w.u16( uint16_t( 2 * sizeof( uint32_t ) + width * height * sizeof( uint32_t ) ) );
+			w.u32( height );
+			w.u32( width );
+			for (uint32_t cell = 0; cell < width * height; ++cell)
+			{
+				// the LED indexes are relative to the zone, cells behind the last LED are empty
+				w.u32( cell < shape.ledsPerZone ? cell : 0xFFFFFFFF );
+			}
+		}
+		else
+		{
+			w.u16( 0 );  // no matrix
+		}
+	}
+
+	// LEDs
+	w.u16( uint16_t( shape.ledCount() ) );
+	for (unsigned int ledIdx = 0; ledIdx < shape.ledCount(); ++ledIdx)
+	{
+		w.str( "LED " + std::to_string( ledIdx ) );
+		w.u32( ledIdx );  // value
+	}
+
+	// colors
+	w.u16( uint16_t( shape.ledCount() ) );
+	for (unsigned int ledIdx = 0; ledIdx < shape.ledCount(); ++ledIdx)
+	{
+		w.color( uint8_t( ledIdx ), uint8_t( ledIdx * 3 ), uint8_t( ledIdx * 7 ) );
+	}
+
+	w.patchU32( 0, uint32_t( w.bytes.size() ) );
+	return move( w.bytes );
+}
+
+unique_ptr< Device > makeSyntheticDevice( const DeviceShape & shape, uint32_t deviceIdx, uint32_t protocolVersion )
+{
+	vector< uint8_t > body = serializeSyntheticDevice( shape, deviceIdx, protocolVersion );
+
+	ReplyControllerData reply;
+	reply.header = Header( MessageType::REQUEST_CONTROLLER_DATA, deviceIdx, uint32_t( body.size() ) );
+	BinaryInputStream stream( make_span( body ) );
+	if (!reply.deserializeBody( stream, protocolVersion ))
+	{
+		return nullptr;
+	}
+
+	return move( reply.device_desc );
+}
+
+
+//======================================================================================================================
+
+
+} // namespace mock
+} // namespace orgb
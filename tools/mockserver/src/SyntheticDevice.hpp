@@ -0,0 +1,53 @@
+//======================================================================================================================
+// Project: OpenRGB - C++ SDK
+//----------------------------------------------------------------------------------------------------------------------
+// Author:      Jan Broz (Youda008)
+// Description: generator of artificial devices for testing without RGB hardware
+//======================================================================================================================
+
+#ifndef OPENRGB_MOCK_SYNTHETIC_DEVICE_INCLUDED
+#define OPENRGB_MOCK_SYNTHETIC_DEVICE_INCLUDED
+
+
+#include "OpenRGB/DeviceInfo.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+
+namespace orgb {
+namespace mock {
+
+
+//======================================================================================================================
+
+/// Describes how big a generated device should be.
+struct DeviceShape
+{
+	unsigned int modeCount = 4;        ///< the first mode is always "Direct"
+	unsigned int modeColorCount = 1;   ///< number of colors of each mode
+	unsigned int zoneCount = 2;
+	unsigned int ledsPerZone = 16;     ///< the device has zoneCount * ledsPerZone LEDs
+	unsigned int matrixWidth = 0;      ///< when non-zero, the zones are matrices of this width with the LEDs in rows
+
+	unsigned int ledCount() const noexcept  { return zoneCount * ledsPerZone; }
+};
+
+/// Serializes a device of the given shape exactly as a server would send it in the body of ReplyControllerData.
+/** The device gets deterministic names and values derived from its index, so repeated runs produce the same bytes. */
+std::vector< uint8_t > serializeSyntheticDevice( const DeviceShape & shape, uint32_t deviceIdx, uint32_t protocolVersion );
+
+/// Creates a device of the given shape by parsing its serialized form, just like the client would receive it.
+/** \returns nullptr if the parsing fails, which would mean the generator doesn't match the protocol implementation. */
+std::unique_ptr< Device > makeSyntheticDevice( const DeviceShape & shape, uint32_t deviceIdx, uint32_t protocolVersion );
+
+
+//======================================================================================================================
+
+
+} // namespace mock
+} // namespace orgb
+
+
+#endif // OPENRGB_MOCK_SYNTHETIC_DEVICE_INCLUDED
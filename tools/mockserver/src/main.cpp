@@ -0,0 +1,123 @@
+#include "MockServer.hpp"
+using namespace orgb::mock;
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <chrono>
+using namespace std;
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define APP_FULL_NAME "OpenRGB C++ SDK mock server"
+
+#define EXECUTABLE_NAME "orgbmockserver"
+#define USAGE EXECUTABLE_NAME " [--<option> <value>]..."
+#define EXAMPLE EXECUTABLE_NAME " --port 6743 --devices 30 --leds 150 --latency-us 2000"
+
+
+static void printHelp()
+{
+	static const char help [] =
+		APP_FULL_NAME "\n"
+		"\n"
+		"Serves synthetic RGB devices over the OpenRGB protocol on the loopback interface,\n"
+		"so that the client can be measured and tested without any RGB hardware.\n"
+		"It runs until the standard input is closed or a line is entered.\n"
+		"\n"
+		"  Usage is as follows: " USAGE "\n"
+		"          For example: " EXAMPLE "\n"
+		"\n"
+		"Options:\n"
+		"  --port <n>                 port to listen on (default: 6742, 0 means any free port)\n"
+		"  --protocol <n>             highest protocol version to claim (default: 3)\n"
+		"  --devices <n>              number of devices (default: 4)\n"
+		"  --modes <n>                modes per device (default: 4)\n"
+		"  --zones <n>                zones per device (default: 2)\n"
+		"  --leds <n>                 LEDs per zone (default: 16)\n"
+		"  --matrix-width <n>         make the zones matrices of this width (default: 0 = linear)\n"
+		"  --latency-us <n>           delay before every reply in microseconds\n"
+		"  --processing-delay-us <n>  delay after every received message, simulates a slow consumer\n"
+		"  --recv-buffer <n>          size of the system receive buffer of each connection in bytes\n"
+		"  --update-period-ms <n>     send DeviceListUpdated to every client this often\n"
+	;
+	cout << help << flush;
+}
+
+static bool parseArgs( int argc, char * argv [], ServerConfig & config )
+{
+	config.port = 6742;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		string option = argv[i];
+		if (option == "--help" || option == "-h")
+		{
+			printHelp();
+			exit( 0 );
+		}
+		if (i + 1 >= argc)
+		{
+			cerr << "missing value for " << option << endl;
+			return false;
+		}
+		unsigned long value = strtoul( argv[ ++i ], nullptr, 10 );
+
+		if      (option == "--port")                 config.port = uint16_t( value );
+		else if (option == "--protocol")             config.protocolVersion = uint32_t( value );
+		else if (option == "--devices")              config.deviceCount = unsigned( value );
+		else if (option == "--modes")                config.deviceShape.modeCount = unsigned( value );
+		else if (option == "--zones")                config.deviceShape.zoneCount = unsigned( value );
+		else if (option == "--leds")                 config.deviceShape.ledsPerZone = unsigned( value );
+		else if (option == "--matrix-width")         config.deviceShape.matrixWidth = unsigned( value );
+		else if (option == "--latency-us")           config.replyLatency = chrono::microseconds( value );
+		else if (option == "--processing-delay-us")  config.processingDelay = chrono::microseconds( value );
+		else if (option == "--recv-buffer")          config.receiveBufferSize = int( value );
+		else if (option == "--update-period-ms")     config.deviceListUpdatePeriod = chrono::milliseconds( value );
+		else
+		{
+			cerr << "unknown option " << option << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main( int argc, char * argv [] )
+{
+	ServerConfig config;
+	if (!parseArgs( argc, argv, config ))
+	{
+		cerr << "usage: " USAGE << endl;
+		return 1;
+	}
+
+	MockServer server( config );
+	if (!server.start())
+	{
+		cerr << "failed to start the server: " << strerror( errno ) << endl;
+		return 2;
+	}
+
+	cout << "listening on 127.0.0.1:" << server.port() << " with " << config.deviceCount << " devices" << endl;
+
+	string line;
+	getline( cin, line );
+
+	server.stop();
+
+	ServerStats stats = server.stats();
+	cout << "connections: " << stats.connections << '\n'
+	     << "messages:    " << stats.messages << " (" << stats.bytes << " bytes)\n"
+	     << "updates:     " << stats.colorUpdates << " (" << stats.updatedLEDs << " LEDs)\n"
+	     << "invalid:     " << stats.invalidMessages << endl;
+
+	return 0;
+}